@@ -0,0 +1,72 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#ifndef _SWIFT_AUDIO_CODEC_H_
+#define _SWIFT_AUDIO_CODEC_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/** WAV format tags understood by the decoders */
+#define SWIFT_AUDIO_WAV_FORMAT_PCM		0x0001
+#define SWIFT_AUDIO_WAV_FORMAT_ALAW		0x0006
+#define SWIFT_AUDIO_WAV_FORMAT_MULAW		0x0007
+#define SWIFT_AUDIO_WAV_FORMAT_IMA_ADPCM	0x0011
+
+/**
+ * @brief Decode G.711 u-law bytes to 16-bit samples
+ *
+ * Decoding in place is allowed when src is the second half of the dst
+ * buffer, i.e. src == (uint8_t *)dst + count.
+ *
+ * @param dst Destination buffer, count samples
+ * @param src Source buffer, count bytes
+ * @param count Number of samples
+ */
+void swift_audio_ulaw_decode(int16_t *dst, const uint8_t *src, ssize_t count);
+
+/**
+ * @brief Decode G.711 A-law bytes to 16-bit samples
+ *
+ * Decoding in place is allowed when src is the second half of the dst
+ * buffer, i.e. src == (uint8_t *)dst + count.
+ *
+ * @param dst Destination buffer, count samples
+ * @param src Source buffer, count bytes
+ * @param count Number of samples
+ */
+void swift_audio_alaw_decode(int16_t *dst, const uint8_t *src, ssize_t count);
+
+/**
+ * @brief Get the number of frames stored in an IMA-ADPCM block
+ *
+ * @param block_size Size of the block in bytes, the WAV block align
+ * @param channels Number of channels
+ *
+ * @return Number of frames, 0 if the block is too small
+ */
+ssize_t swift_audio_ima_block_frames(ssize_t block_size, int channels);
+
+/**
+ * @brief Decode one WAV IMA-ADPCM (format 0x11) block
+ *
+ * Each block starts with a 4-byte header per channel followed by 4-byte
+ * groups of 8 samples per channel. A short block, like the last one of a
+ * file, is decoded up to its last complete group.
+ *
+ * @param dst Destination buffer, interleaved 16-bit samples.
+ * It must hold swift_audio_ima_block_frames(block_size, channels) frames.
+ * @param block Block data
+ * @param block_size Size of the block in bytes
+ * @param channels Number of channels, 1 or 2
+ *
+ * @retval Positive indicates the number of frames decoded.
+ * @retval -EINVAL If a parameter is not supported.
+ */
+ssize_t swift_audio_ima_decode_block(int16_t *dst, const uint8_t *block,
+				     ssize_t block_size, int channels);
+
+#endif /* _SWIFT_AUDIO_CODEC_H_ */
@@ -0,0 +1,151 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#ifndef _SWIFT_AUDIO_FORMAT_H_
+#define _SWIFT_AUDIO_FORMAT_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Sample format conversion and gain kernels for I2S buffers.
+ *
+ * These routines are implemented in this library (not in the HAL). They use
+ * the Cortex-M DSP extension on the board and NEON/SSE2 on the host when
+ * available, and fall back to plain C otherwise.
+ *
+ * Sample containers follow the I2S driver layout:
+ *   8-bit  samples are stored in int8_t
+ *   16-bit samples are stored in int16_t
+ *   24-bit samples are stored right aligned and sign extended in int32_t
+ *   32-bit samples are stored in int32_t
+ *
+ * All counts are in samples unless the parameter is named frames, in which
+ * case one frame holds one sample per channel.
+ */
+
+/** Q15 gain that leaves the samples untouched */
+#define SWIFT_AUDIO_GAIN_Q15_UNITY	(1 << 15)
+
+/**
+ * @brief Duplicate a mono 16-bit stream into interleaved stereo
+ *
+ * @param dst Destination buffer, 2 * frames samples
+ * @param src Source buffer, frames samples
+ * @param frames Number of frames
+ */
+void swift_audio_mono_to_stereo_s16(int16_t *dst, const int16_t *src, ssize_t frames);
+
+/**
+ * @brief Duplicate a mono 32-bit container stream into interleaved stereo
+ *
+ * @param dst Destination buffer, 2 * frames samples
+ * @param src Source buffer, frames samples
+ * @param frames Number of frames
+ */
+void swift_audio_mono_to_stereo_s32(int32_t *dst, const int32_t *src, ssize_t frames);
+
+/**
+ * @brief Interleave two 16-bit channel buffers
+ *
+ * @param dst Destination buffer, 2 * frames samples
+ * @param left Left channel, frames samples
+ * @param right Right channel, frames samples
+ * @param frames Number of frames
+ */
+void swift_audio_interleave_s16(int16_t *dst, const int16_t *left, const int16_t *right, ssize_t frames);
+
+/**
+ * @brief Interleave two 32-bit container channel buffers
+ *
+ * @param dst Destination buffer, 2 * frames samples
+ * @param left Left channel, frames samples
+ * @param right Right channel, frames samples
+ * @param frames Number of frames
+ */
+void swift_audio_interleave_s32(int32_t *dst, const int32_t *left, const int32_t *right, ssize_t frames);
+
+/**
+ * @brief Split an interleaved 16-bit stereo buffer into two channel buffers
+ *
+ * @param left Left channel, frames samples
+ * @param right Right channel, frames samples
+ * @param src Source buffer, 2 * frames samples
+ * @param frames Number of frames
+ */
+void swift_audio_deinterleave_s16(int16_t *left, int16_t *right, const int16_t *src, ssize_t frames);
+
+/**
+ * @brief Split an interleaved 32-bit container stereo buffer into two channel buffers
+ *
+ * @param left Left channel, frames samples
+ * @param right Right channel, frames samples
+ * @param src Source buffer, 2 * frames samples
+ * @param frames Number of frames
+ */
+void swift_audio_deinterleave_s32(int32_t *left, int32_t *right, const int32_t *src, ssize_t frames);
+
+/**
+ * @brief Widen or narrow samples between 8, 16, 24 and 32 bits
+ *
+ * Widening shifts the sample left, narrowing shifts it right (truncation).
+ * Conversion in place is allowed when the destination container is not
+ * larger than the source container.
+ *
+ * @param dst Destination buffer in the container of dst_bits
+ * @param dst_bits 8, 16, 24 or 32
+ * @param src Source buffer in the container of src_bits
+ * @param src_bits 8, 16, 24 or 32
+ * @param count Number of samples
+ *
+ * @retval 0 If successful.
+ * @retval -EINVAL If the bit width is not supported.
+ */
+int swift_audio_convert(void *dst, int dst_bits, const void *src, int src_bits, ssize_t count);
+
+/**
+ * @brief Scale 16-bit samples by a Q15 gain with saturation
+ *
+ * y = sat16((x * gain + 0x4000) >> 15). The buffer is modified in place.
+ *
+ * @param buf Sample buffer
+ * @param count Number of samples
+ * @param gain_q15 Gain in [-32768, 32768], SWIFT_AUDIO_GAIN_Q15_UNITY is 1.0
+ */
+void swift_audio_gain_q15(int16_t *buf, ssize_t count, int32_t gain_q15);
+
+/**
+ * @brief Scale 32-bit container samples by a Q31 gain with saturation
+ *
+ * y = sat32((x * gain + 2^30) >> 31). The buffer is modified in place.
+ *
+ * @param buf Sample buffer
+ * @param count Number of samples
+ * @param gain_q31 Gain in Q31 format
+ */
+void swift_audio_gain_q31(int32_t *buf, ssize_t count, int32_t gain_q31);
+
+/**
+ * @brief Convert 16-bit mono or stereo samples into an interleaved stereo I2S block
+ *
+ * Applies gain, duplicates mono samples and widens or narrows to dst_bits in
+ * a single pass over the source without any intermediate frame buffer.
+ *
+ * @param dst Destination buffer, 2 * frames samples in the container of dst_bits
+ * @param dst_bits 8, 16, 24 or 32
+ * @param src Source buffer, src_channels * frames samples
+ * @param src_channels 1 or 2
+ * @param frames Number of frames
+ * @param gain_q15 Gain in [-32768, 32768], SWIFT_AUDIO_GAIN_Q15_UNITY is 1.0
+ *
+ * @retval Positive indicates the number of bytes written to dst.
+ * @retval -EINVAL If a parameter is not supported.
+ */
+int swift_audio_s16_to_i2s(void *dst, int dst_bits,
+			   const int16_t *src, int src_channels,
+			   ssize_t frames, int32_t gain_q15);
+
+#endif /* _SWIFT_AUDIO_FORMAT_H_ */
@@ -0,0 +1,54 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#ifndef _SWIFT_AUDIO_MIXER_H_
+#define _SWIFT_AUDIO_MIXER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Fixed-point mixing kernels used by the Swift AudioMixer.
+ *
+ * The mix bus is interleaved stereo int16_t. Every source is scaled by a
+ * per-channel Q15 gain and added to the bus with saturation, so the result
+ * never wraps around no matter how many sources are mixed.
+ */
+
+/**
+ * @brief Scale a 16-bit source and add it to a stereo mix bus with saturation
+ *
+ * dst[L] = sat16(dst[L] + ((src[L] * gain_left + 0x4000) >> 15))
+ * dst[R] = sat16(dst[R] + ((src[R] * gain_right + 0x4000) >> 15))
+ *
+ * A mono source feeds both channels.
+ *
+ * @param dst Stereo mix bus, 2 * frames samples
+ * @param src Source samples, src_channels * frames samples
+ * @param src_channels 1 or 2
+ * @param frames Number of frames
+ * @param gain_left Left gain in Q15, 0x7FFF is the maximum
+ * @param gain_right Right gain in Q15, 0x7FFF is the maximum
+ */
+void swift_audio_mix_s16(int16_t *dst, const int16_t *src, int src_channels,
+			 ssize_t frames, int16_t gain_left, int16_t gain_right);
+
+/**
+ * @brief Generate a mono sine tone
+ *
+ * Uses a phase accumulator and a 256 entry interpolated sine table. The
+ * phase is kept by the caller so a tone continues seamlessly across blocks.
+ *
+ * @param dst Destination buffer, frames samples
+ * @param frames Number of frames
+ * @param phase Pointer to the 32-bit phase accumulator
+ * @param phase_step Phase increment per sample, frequency * 2^32 / sample_rate
+ * @param amplitude Peak amplitude
+ */
+void swift_audio_tone_s16(int16_t *dst, ssize_t frames,
+			  uint32_t *phase, uint32_t phase_step, int16_t amplitude);
+
+#endif /* _SWIFT_AUDIO_MIXER_H_ */
@@ -0,0 +1,81 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#ifndef _SWIFT_AUDIO_RESAMPLE_H_
+#define _SWIFT_AUDIO_RESAMPLE_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/** @brief Resampler quality, a higher quality costs more CPU per sample */
+enum swift_audio_resample_quality {
+	/** Linear interpolation, 2 taps */
+	SWIFT_AUDIO_RESAMPLE_FAST,
+	/** Windowed sinc, 8 taps and 64 phases */
+	SWIFT_AUDIO_RESAMPLE_MEDIUM,
+	/** Windowed sinc, 16 taps and 128 phases */
+	SWIFT_AUDIO_RESAMPLE_HIGH,
+};
+
+typedef enum swift_audio_resample_quality swift_audio_resample_quality_t;
+
+/**
+ * @brief Get the memory needed by a resampler
+ *
+ * @param quality Resampler quality, use @ref swift_audio_resample_quality
+ * @param channels Number of interleaved channels, 1 or 2
+ *
+ * @return Size in bytes, negative errno code if failure.
+ */
+ssize_t swift_audio_resampler_size(swift_audio_resample_quality_t quality, int channels);
+
+/**
+ * @brief Initialize a resampler in caller provided memory
+ *
+ * The filter is designed for the given ratio, with the cutoff lowered below
+ * the output Nyquist frequency when downsampling.
+ *
+ * @param mem Memory of at least swift_audio_resampler_size() bytes, 4-byte aligned
+ * @param size Size of mem in bytes
+ * @param in_rate Input sample rate
+ * @param out_rate Output sample rate
+ * @param quality Resampler quality, use @ref swift_audio_resample_quality
+ * @param channels Number of interleaved channels, 1 or 2
+ *
+ * @return Resampler handle, NULL if a parameter is invalid.
+ */
+void *swift_audio_resampler_init(void *mem, ssize_t size,
+				 int in_rate, int out_rate,
+				 swift_audio_resample_quality_t quality, int channels);
+
+/**
+ * @brief Clear the history so a new stream can start
+ *
+ * @param rs Resampler handle
+ */
+void swift_audio_resampler_reset(void *rs);
+
+/**
+ * @brief Resample a block of interleaved 16-bit samples
+ *
+ * The resampler keeps its filter history between calls, so a stream can be
+ * fed in blocks of any size. Processing stops when either the input is used
+ * up or the output is full.
+ *
+ * @param rs Resampler handle
+ * @param in Input samples
+ * @param in_frames Number of input frames, updated to the frames consumed
+ * @param out Output samples
+ * @param out_frames Capacity of out in frames, updated to the frames produced
+ *
+ * @retval 0 If successful.
+ * @retval -EINVAL If a parameter is invalid.
+ */
+int swift_audio_resampler_process(void *rs,
+				  const int16_t *in, ssize_t *in_frames,
+				  int16_t *out, ssize_t *out_frames);
+
+#endif /* _SWIFT_AUDIO_RESAMPLE_H_ */
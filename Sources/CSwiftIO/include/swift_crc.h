@@ -0,0 +1,32 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#ifndef _SWIFT_CRC_H_
+#define _SWIFT_CRC_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Checksums for data stored on files.
+ *
+ * These routines are implemented in this library.
+ */
+
+/**
+ * @brief Compute or continue a CRC-32
+ *
+ * The IEEE 802.3 polynomial, the same as zlib and PNG. Start with crc 0,
+ * pass the result back in to checksum data split across several buffers.
+ *
+ * @param crc CRC of the preceding data, 0 for the first buffer
+ * @param buf Data buffer
+ * @param len Number of bytes
+ * @return CRC of all the data so far
+ */
+uint32_t swift_crc32(uint32_t crc, const void *buf, ssize_t len);
+
+#endif /* _SWIFT_CRC_H_ */
@@ -65,6 +65,19 @@ struct swift_fs_statvfs {
 
 typedef struct swift_fs_statvfs swift_fs_statvfs_t;
 
+/**
+ * @brief Structure to describe one buffer of a vectored read or write
+ *
+ * @param base Start of the buffer
+ * @param len Size of the buffer in bytes
+ */
+struct swift_fs_iovec {
+	void *base;
+	ssize_t len;
+};
+
+typedef struct swift_fs_iovec swift_fs_iovec_t;
+
 
 /**
  * @brief File open
@@ -87,6 +100,24 @@ typedef struct swift_fs_statvfs swift_fs_statvfs_t;
  */
 int swifthal_fs_open(void **fp, const char *path, uint8_t flags);
 
+/**
+ * @brief File open with entry information
+ *
+ * Same as swifthal_fs_open, and fills the entry of the file found by the
+ * same path lookup, so no separate swifthal_fs_stat is needed. If the file
+ * is created, entry->size is 0.
+ *
+ * @param fp   Pointer to save the file descriptor
+ * @param path The path with name of file to open
+ * @param flags The mode flags, see swifthal_fs_open
+ * @param entry Pointer to @ref swift_fs_dirent structure to fill
+ *
+ * @retval 0 Success
+ * @retval -EISDIR If the path is a directory
+ * @retval -ERRNO errno code if error
+ */
+int swifthal_fs_open_ex(void **fp, const char *path, uint8_t flags, swift_fs_dirent_t *entry);
+
 /**
  * @brief Close file
  *
@@ -148,6 +179,68 @@ int swifthal_fs_write(void *fp, const void *buf, ssize_t size);
  */
 int swifthal_fs_read(void *fp, void *buf, ssize_t size);
 
+/**
+ * @brief File read at an offset
+ *
+ * Reads from the given offset in one call. The file position is not used
+ * and not changed, so several threads may read the same file at once.
+ *
+ * @param fp File handle
+ * @param buf Pointer to the data buffer
+ * @param size Number of bytes to be read
+ * @param offset Offset from the beginning of the file
+ *
+ * @return Number of bytes read, less than requested at the end of the
+ * file. Will return -ERRNO code on error.
+ */
+int swifthal_fs_pread(void *fp, void *buf, ssize_t size, ssize_t offset);
+
+/**
+ * @brief File write at an offset
+ *
+ * Writes at the given offset in one call. The file position is not used
+ * and not changed. The file grows if the write ends past its end.
+ *
+ * @param fp File handle
+ * @param buf Pointer to the data buffer
+ * @param size Number of bytes to be write
+ * @param offset Offset from the beginning of the file
+ *
+ * @return Number of bytes written. Any value other than size indicates an
+ * error. Will return -ERRNO code on error.
+ */
+int swifthal_fs_pwrite(void *fp, const void *buf, ssize_t size, ssize_t offset);
+
+/**
+ * @brief File vectored read
+ *
+ * Reads at the current position into several buffers in order, filling
+ * each one before moving to the next.
+ *
+ * @param fp File handle
+ * @param iov Array of @ref swift_fs_iovec buffers
+ * @param iovcnt Number of buffers
+ *
+ * @return Total number of bytes read, less than the total size of the
+ * buffers at the end of the file. Will return -ERRNO code on error.
+ */
+int swifthal_fs_readv(void *fp, const swift_fs_iovec_t *iov, int iovcnt);
+
+/**
+ * @brief File vectored write
+ *
+ * Writes several buffers at the current position in one call, for example
+ * a record header, its payload and its checksum.
+ *
+ * @param fp File handle
+ * @param iov Array of @ref swift_fs_iovec buffers
+ * @param iovcnt Number of buffers
+ *
+ * @return Total number of bytes written. Any value other than the total
+ * size of the buffers indicates an error. Will return -ERRNO code on error.
+ */
+int swifthal_fs_writev(void *fp, const swift_fs_iovec_t *iov, int iovcnt);
+
 /**
  * @brief File seek
  *
@@ -239,6 +332,21 @@ int swifthal_fs_opendir(void **dp, const char *path);
  */
 int swifthal_fs_readdir(void *dp, swift_fs_dirent_t *entry);
 
+/**
+ * @brief Directory read several entries
+ *
+ * Same as swifthal_fs_readdir, but fills up to n entries in one call so
+ * large directories are listed with far fewer calls.
+ *
+ * @param dp Pointer to the directory object
+ * @param entries Array of @ref swift_fs_dirent structures to read into
+ * @param n Number of entries in the array
+ *
+ * @return Number of entries read, 0 at the end of the directory. Will
+ * return -ERRNO code on error.
+ */
+int swifthal_fs_readdir_batch(void *dp, swift_fs_dirent_t *entries, int n);
+
 /**
  * @brief Directory close
  *
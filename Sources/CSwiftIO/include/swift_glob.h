@@ -0,0 +1,53 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#ifndef _SWIFT_GLOB_H_
+#define _SWIFT_GLOB_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "swift_fs.h"
+
+/*
+ * Shell style name matching for directory listings.
+ *
+ * These routines are implemented in this library. A pattern may contain:
+ *   *        any run of characters, including none
+ *   ?        any single character
+ *   [abc]    one of the listed characters
+ *   [a-z]    one character in the range
+ *   [!abc]   one character not listed
+ * Any other character matches itself, case sensitively.
+ */
+
+/** Keep directories whatever their name, so a walk can descend into them */
+#define SWIFT_GLOB_KEEP_DIRS	0x01
+
+/**
+ * @brief Match a name against a pattern
+ *
+ * @param pattern Null-terminated pattern
+ * @param name Null-terminated name
+ * @return 1 if the name matches, 0 if not
+ */
+int swift_glob_match(const char *pattern, const char *name);
+
+/**
+ * @brief Drop the entries whose names don't match a pattern
+ *
+ * The matching entries are moved to the front of the array, keeping their
+ * order.
+ *
+ * @param entries Array of entries, as filled by swifthal_fs_readdir_batch
+ * @param n Number of entries
+ * @param pattern Null-terminated pattern
+ * @param flags 0 or SWIFT_GLOB_KEEP_DIRS
+ * @return Number of entries kept
+ */
+int swift_glob_filter(swift_fs_dirent_t *entries, int n, const char *pattern, int flags);
+
+#endif /* _SWIFT_GLOB_H_ */
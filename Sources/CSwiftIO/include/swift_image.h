@@ -0,0 +1,122 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#ifndef _SWIFT_IMAGE_H_
+#define _SWIFT_IMAGE_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "swift_lcd.h"
+
+/*
+ * Streaming QOI ("Quite OK Image") decoder.
+ *
+ * The compressed data can be fed in chunks of any size, for example as it
+ * is read from a file. Pixels are written straight into a framebuffer at
+ * an origin that may be partly or fully off screen; pixels outside the
+ * framebuffer are decoded but not stored, and decoding stops early once
+ * the rest of the image is below the framebuffer.
+ *
+ * Pixels with alpha 0 are skipped so transparent areas keep the
+ * framebuffer content, all other pixels are stored opaque.
+ */
+
+/** Size of the QOI file header */
+#define SWIFT_QOI_HEADER_SIZE	14
+
+struct swift_qoi_pixel {
+	uint8_t r;
+	uint8_t g;
+	uint8_t b;
+	uint8_t a;
+};
+
+/**
+ * @brief QOI decoder state, treat the fields as private
+ */
+struct swift_qoi_decoder {
+	struct swift_qoi_pixel index[64];
+	struct swift_qoi_pixel px;
+	uint32_t run;
+	uint32_t width;
+	uint32_t height;
+	uint32_t x;
+	uint32_t y;
+
+	uint8_t *dst;
+	int dst_pitch;
+	int dst_width;
+	int dst_height;
+	swift_lcd_pixel_format_t dst_format;
+	int bpp;
+	int origin_x;
+	int origin_y;
+
+	/* Visible image columns of the current row */
+	uint32_t visible_start;
+	uint32_t visible_count;
+};
+
+typedef struct swift_qoi_decoder swift_qoi_decoder_t;
+
+/**
+ * @brief Parse a QOI header
+ *
+ * @param header The first SWIFT_QOI_HEADER_SIZE bytes of the file
+ * @param width Image width in pixel
+ * @param height Image height in pixel
+ * @param channels 3 for RGB, 4 for RGBA
+ *
+ * @retval 0 If successful.
+ * @retval -EINVAL If the header is not a valid QOI header.
+ */
+int swift_qoi_parse_header(const uint8_t *header, uint32_t *width, uint32_t *height, int *channels);
+
+/**
+ * @brief Prepare a decoder for an image
+ *
+ * @param dec Decoder state
+ * @param width Image width from the header
+ * @param height Image height from the header
+ * @param dst Pointer to pixel (0, 0) of the framebuffer
+ * @param dst_pitch Bytes between two rows of the framebuffer
+ * @param dst_width Framebuffer width in pixel
+ * @param dst_height Framebuffer height in pixel
+ * @param dst_format Framebuffer pixel format, RGB565, RGB888 or ARGB8888
+ * @param x Framebuffer column of the image left, may be negative
+ * @param y Framebuffer row of the image top, may be negative
+ *
+ * @retval 0 If successful.
+ * @retval -EINVAL If a parameter is not supported.
+ */
+int swift_qoi_decoder_init(swift_qoi_decoder_t *dec, uint32_t width, uint32_t height,
+			   void *dst, int dst_pitch, int dst_width, int dst_height,
+			   swift_lcd_pixel_format_t dst_format, int x, int y);
+
+/**
+ * @brief Decode a chunk of QOI data that follows the header
+ *
+ * Only whole chunks (ops) are consumed. Keep the unconsumed tail, at most
+ * 4 bytes, and pass it again in front of the next chunk.
+ *
+ * @param dec Decoder state
+ * @param src Compressed data
+ * @param size Bytes in src
+ *
+ * @retval Positive or 0 indicates the bytes consumed.
+ */
+ssize_t swift_qoi_decode(swift_qoi_decoder_t *dec, const uint8_t *src, ssize_t size);
+
+/**
+ * @brief Check whether all visible pixels have been decoded
+ *
+ * @param dec Decoder state
+ * @return 1 if finished, 0 otherwise
+ */
+int swift_qoi_decode_done(const swift_qoi_decoder_t *dec);
+
+#endif /* _SWIFT_IMAGE_H_ */
@@ -121,6 +121,27 @@ int swifthal_lcd_stop(void *lcd);
  */
 int swifthal_lcd_fb_update(void *lcd, void *buf, unsigned int size);
 
+/**
+ * @brief Update a region of frame buffer
+ *
+ * Only the rows and columns inside the region are written back from the
+ * data cache. If buf is not the frame buffer being refreshed, the panel is
+ * switched to buf like swifthal_lcd_fb_update, the content outside the
+ * region must already be valid in buf.
+ *
+ * @param lcd LCD Handle
+ * @param buf Pointer to frame buffer
+ * @param x Left of region in pixel
+ * @param y Top of region in pixel
+ * @param w Width of region in pixel
+ * @param h Height of region in pixel
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If region update is not supported, use swifthal_lcd_fb_update.
+ * @retval Negative errno code if failure.
+ */
+int swifthal_lcd_fb_update_region(void *lcd, void *buf, int x, int y, int w, int h);
+
 /**
  * @brief Get screen information
  *
@@ -148,5 +169,90 @@ int swifthal_lcd_screen_param_get(void *lcd,
  */
 int swifthal_lcd_refresh_rate_get(void *lcd);
 
+/*
+ * 2D accelerator (DMA2D/PXP class) hooks used by swift_raster.h.
+ *
+ * The color is always given in ARGB8888. Pitches are in bytes. The calls
+ * block until the accelerator finishes and do the cache maintenance of the
+ * source and destination themselves. A board without an accelerator may
+ * leave them unimplemented or return -ENOTSUP, the software kernels are
+ * used instead.
+ */
+
+/**
+ * @brief Fill a rectangle with a color
+ *
+ * @param dst Pointer to the first pixel of the rectangle
+ * @param pitch Bytes between two rows of dst
+ * @param w Width of rectangle in pixel
+ * @param h Height of rectangle in pixel
+ * @param format Color format of dst
+ * @param color Color in ARGB8888
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the operation is not supported.
+ * @retval Negative errno code if failure.
+ */
+int swifthal_lcd_accel_fill(void *dst, int pitch, int w, int h,
+			    swift_lcd_pixel_format_t format, uint32_t color);
+
+/**
+ * @brief Copy or convert a rectangle
+ *
+ * @param dst Pointer to the first pixel of the destination
+ * @param dst_pitch Bytes between two rows of dst
+ * @param dst_format Color format of dst
+ * @param src Pointer to the first pixel of the source
+ * @param src_pitch Bytes between two rows of src
+ * @param src_format Color format of src
+ * @param w Width of rectangle in pixel
+ * @param h Height of rectangle in pixel
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the operation is not supported.
+ * @retval Negative errno code if failure.
+ */
+int swifthal_lcd_accel_copy(void *dst, int dst_pitch, swift_lcd_pixel_format_t dst_format,
+			    const void *src, int src_pitch, swift_lcd_pixel_format_t src_format,
+			    int w, int h);
+
+/**
+ * @brief Blend an ARGB8888 rectangle over a rectangle
+ *
+ * @param dst Pointer to the first pixel of the destination
+ * @param dst_pitch Bytes between two rows of dst
+ * @param dst_format Color format of dst
+ * @param src Pointer to the first ARGB8888 pixel of the source
+ * @param src_pitch Bytes between two rows of src
+ * @param w Width of rectangle in pixel
+ * @param h Height of rectangle in pixel
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the operation is not supported.
+ * @retval Negative errno code if failure.
+ */
+int swifthal_lcd_accel_blend(void *dst, int dst_pitch, swift_lcd_pixel_format_t dst_format,
+			     const uint32_t *src, int src_pitch, int w, int h);
+
+/**
+ * @brief Blend a color through an 8-bit alpha mask over a rectangle
+ *
+ * @param dst Pointer to the first pixel of the destination
+ * @param dst_pitch Bytes between two rows of dst
+ * @param dst_format Color format of dst
+ * @param mask Pointer to the first alpha value of the mask
+ * @param mask_pitch Bytes between two rows of mask
+ * @param w Width of rectangle in pixel
+ * @param h Height of rectangle in pixel
+ * @param color Color in ARGB8888
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the operation is not supported.
+ * @retval Negative errno code if failure.
+ */
+int swifthal_lcd_accel_blend_mask(void *dst, int dst_pitch, swift_lcd_pixel_format_t dst_format,
+				  const uint8_t *mask, int mask_pitch, int w, int h,
+				  uint32_t color);
+
 #endif /* _SWIFT_LCD_H_ */
 
@@ -0,0 +1,73 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#ifndef _SWIFT_LZ4_H_
+#define _SWIFT_LZ4_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * LZ4 block compression for data written to files.
+ *
+ * These routines are implemented in this library. The output is a plain
+ * LZ4 block as described in lz4_Block_format.md, so it can be decoded on
+ * a computer with LZ4_decompress_safe(). Each call compresses one block
+ * on its own, nothing is kept between blocks, so a damaged block never
+ * affects the others.
+ *
+ * The compressor uses only the state passed in, 2 KB with the default
+ * hash size. Blocks are limited to 64 KB.
+ */
+
+/** log2 of the number of entries of the match finder hash table */
+#define SWIFT_LZ4_HASH_BITS	10
+
+/** Largest block that can be compressed */
+#define SWIFT_LZ4_MAX_BLOCK	65535
+
+/** Size of the output buffer that always holds a compressed block */
+#define SWIFT_LZ4_COMPRESS_BOUND(n)	((n) + (n) / 255 + 16)
+
+/**
+ * @brief Compressor state, a table of recent positions of 4-byte sequences
+ */
+typedef struct swift_lz4_state {
+	uint16_t table[1 << SWIFT_LZ4_HASH_BITS];
+} swift_lz4_state_t;
+
+/**
+ * @brief Compress a block
+ *
+ * @param state Scratch state, its content doesn't need to be initialized
+ * @param src Data to compress
+ * @param src_len Size of the data, up to SWIFT_LZ4_MAX_BLOCK
+ * @param dst Output buffer
+ * @param dst_cap Size of the output buffer
+ *
+ * @return Size of the compressed block, 0 if it doesn't fit in dst_cap.
+ * @retval -EINVAL If src_len is out of range.
+ */
+int swift_lz4_compress(swift_lz4_state_t *state, const uint8_t *src, int src_len,
+		       uint8_t *dst, int dst_cap);
+
+/**
+ * @brief Decompress a block
+ *
+ * Every length and offset is checked, malformed input never reads or
+ * writes out of the buffers.
+ *
+ * @param src Compressed block
+ * @param src_len Size of the compressed block
+ * @param dst Output buffer
+ * @param dst_cap Size of the output buffer
+ *
+ * @return Size of the decompressed data.
+ * @retval -EINVAL If the block is malformed or doesn't fit in dst_cap.
+ */
+int swift_lz4_decompress(const uint8_t *src, int src_len, uint8_t *dst, int dst_cap);
+
+#endif /* _SWIFT_LZ4_H_ */
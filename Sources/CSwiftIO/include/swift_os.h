@@ -260,4 +260,87 @@ int swifthal_os_sem_give(const void *sem);
  */
 int swifthal_os_sem_reset(const void *sem);
 
+/** Wait until all the flags are set, instead of any of them */
+#define SWIFT_EVENT_WAIT_ALL	0x01
+/** Clear the flags that satisfied the wait before returning */
+#define SWIFT_EVENT_CLEAR	0x02
+
+/**
+ * @brief Create an event group.
+ *
+ * An event group holds 32 flags. Threads wait for any or all of a set of
+ * flags, which are set by other threads or ISRs. Supports up to 16 event
+ * groups.
+ *
+ * @return event group handle
+ */
+const void *swifthal_os_event_create(void);
+
+/**
+ * @brief Destroy an event group.
+ *
+ * @param event event group handle.
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+int swifthal_os_event_destroy(const void *event);
+
+/**
+ * @brief Set flags of an event group.
+ *
+ * The flags are ORed into the group and every thread whose wait is
+ * satisfied is woken up. Allowed for use in ISR.
+ *
+ * @param event event group handle.
+ * @param flags Flags to set.
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+int swifthal_os_event_set(const void *event, uint32_t flags);
+
+/**
+ * @brief Clear flags of an event group.
+ *
+ * Allowed for use in ISR.
+ *
+ * @param event event group handle.
+ * @param flags Flags to clear.
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+int swifthal_os_event_clear(const void *event, uint32_t flags);
+
+/**
+ * @brief Get the flags of an event group.
+ *
+ * @param event event group handle.
+ *
+ * @return the flags currently set
+ */
+uint32_t swifthal_os_event_get(const void *event);
+
+/**
+ * @brief Wait for flags of an event group.
+ *
+ * @note timeout must be set to 0 if called from ISR.
+ *
+ * @param event event group handle.
+ * @param flags Flags to wait for.
+ * @param options SWIFT_EVENT_WAIT_ALL, SWIFT_EVENT_CLEAR or both, 0 to
+ *                wait for any flag and leave it set.
+ * @param received Set to the flags of the group that satisfied the wait,
+ *                 before they are cleared. May be NULL.
+ * @param timeout Waiting period for the flags,
+ *                or 0 means no wait and -1 means wait forever.
+ *
+ * @retval 0 The wait is satisfied.
+ * @retval -EBUSY Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+int swifthal_os_event_wait(const void *event, uint32_t flags, int options,
+			   uint32_t *received, int timeout);
+
 #endif /* _SWIFT_OS_H_ */
\ No newline at end of file
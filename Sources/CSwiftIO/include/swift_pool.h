@@ -0,0 +1,124 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#ifndef _SWIFT_POOL_H_
+#define _SWIFT_POOL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Fixed-block memory pools.
+ *
+ * These routines are implemented in this library. Allocating and freeing a
+ * block take constant time, never block and never call the kernel, so they
+ * can be used in ISR. The free blocks form a list threaded through their
+ * first 4 bytes, its head is swapped with an atomic compare and swap and
+ * carries a tag against the ABA problem.
+ *
+ * A pool holds up to 65535 blocks. Blocks are aligned to SWIFT_POOL_ALIGN
+ * when the storage is and the block size is a multiple of it, so they can
+ * be handed to DMA without sharing a cache line with other data.
+ *
+ * Several pools of increasing block sizes make size classes: a request is
+ * served by the smallest class large enough that has a free block.
+ */
+
+/** Alignment of blocks for DMA, a cache line */
+#define SWIFT_POOL_ALIGN	32
+
+/** Round a block size up to SWIFT_POOL_ALIGN */
+#define SWIFT_POOL_BLOCK_SIZE(size) \
+	(((size) + SWIFT_POOL_ALIGN - 1) & ~(SWIFT_POOL_ALIGN - 1))
+
+/** Most blocks in a pool */
+#define SWIFT_POOL_MAX_BLOCKS	0xFFFF
+
+/**
+ * @brief Fixed-block memory pool
+ */
+typedef struct {
+	/** Storage of block_count blocks */
+	uint8_t *buf;
+	/** Size of a block in bytes */
+	uint32_t block_size;
+	/** Count of blocks */
+	uint32_t block_count;
+	/** Tag in the high 16 bits, index + 1 of the first free block or 0 */
+	uint32_t head;
+	/** Count of blocks allocated */
+	uint32_t used;
+	/** Most blocks allocated at once */
+	uint32_t high_water;
+	/** Count of allocations refused because the pool was empty */
+	uint32_t failures;
+} swift_pool_t;
+
+/**
+ * @brief Initialize a pool
+ *
+ * @param pool Pool to initialize
+ * @param buf Storage of block_size * block_count bytes, aligned to 4 bytes
+ * at least and to SWIFT_POOL_ALIGN for DMA
+ * @param block_size Size of a block in bytes, a multiple of 4
+ * @param block_count Count of blocks, 1 to SWIFT_POOL_MAX_BLOCKS
+ * @return 0 on success, -EINVAL for a bad size, count or alignment
+ */
+int swift_pool_init(swift_pool_t *pool, void *buf, uint32_t block_size,
+		    uint32_t block_count);
+
+/**
+ * @brief Allocate a block
+ *
+ * @param pool Pool
+ * @return Block of block_size bytes, NULL if the pool is empty
+ */
+void *swift_pool_alloc(swift_pool_t *pool);
+
+/**
+ * @brief Free a block
+ *
+ * @param pool Pool the block was allocated from
+ * @param block Block to free
+ * @return 0 on success, -EINVAL if the block isn't a block of the pool
+ */
+int swift_pool_free(swift_pool_t *pool, void *block);
+
+/**
+ * @brief Check if a pointer is within a pool
+ *
+ * @param pool Pool
+ * @param ptr Pointer
+ * @return true if ptr points into the storage of the pool
+ */
+bool swift_pool_owns(const swift_pool_t *pool, const void *ptr);
+
+/**
+ * @brief Allocate from size classes
+ *
+ * Tries the smallest class whose blocks hold size bytes, then the larger
+ * ones. A class that is empty counts a failure even if a larger one serves
+ * the request.
+ *
+ * @param pools Pools sorted by increasing block size
+ * @param count Count of pools
+ * @param size Bytes needed
+ * @return Block of at least size bytes, NULL if no class can serve it
+ */
+void *swift_pools_alloc(swift_pool_t *pools, int count, size_t size);
+
+/**
+ * @brief Free a block allocated from size classes
+ *
+ * @param pools Pools the block was allocated from
+ * @param count Count of pools
+ * @param block Block to free
+ * @return 0 on success, -EINVAL if the block isn't a block of any pool
+ */
+int swift_pools_free(swift_pool_t *pools, int count, void *block);
+
+#endif /* _SWIFT_POOL_H_ */
@@ -0,0 +1,159 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#ifndef _SWIFT_RASTER_H_
+#define _SWIFT_RASTER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "swift_lcd.h"
+
+/*
+ * 2D raster kernels for LCD framebuffers.
+ *
+ * These routines are implemented in this library. Large rectangles are sent
+ * to the 2D accelerator through swifthal_lcd_accel_*() when the HAL provides
+ * it, everything else runs word at a time on the CPU.
+ *
+ * Pixel layout in memory (little endian):
+ *   RGB565    one uint16_t, red in the high bits
+ *   ARGB8888  one uint32_t, alpha in the high byte
+ *   RGB888    three bytes in the order blue, green, red
+ *   8RAW      one byte
+ *
+ * Pitches are in bytes, sizes are in pixels. Colors are always passed in
+ * ARGB8888 and converted to the destination format.
+ */
+
+/** Rectangles smaller than this number of pixels never use the accelerator */
+#define SWIFT_RASTER_ACCEL_MIN_PIXELS	4096
+
+/**
+ * @brief Get the number of bytes of a pixel
+ *
+ * @param format Pixel format
+ * @return 2, 3, 4 or 1
+ */
+int swift_raster_bpp(swift_lcd_pixel_format_t format);
+
+/**
+ * @brief Fill a rectangle with a color
+ *
+ * @param dst Pointer to the first pixel of the rectangle
+ * @param pitch Bytes between two rows of dst
+ * @param format Color format of dst
+ * @param w Width of rectangle
+ * @param h Height of rectangle
+ * @param color Color in ARGB8888, alpha is ignored except for ARGB8888
+ */
+void swift_raster_fill(void *dst, int pitch, swift_lcd_pixel_format_t format,
+		       int w, int h, uint32_t color);
+
+/**
+ * @brief Copy a rectangle between buffers of the same format
+ *
+ * The rectangles must not overlap.
+ *
+ * @param dst Pointer to the first pixel of the destination
+ * @param dst_pitch Bytes between two rows of dst
+ * @param src Pointer to the first pixel of the source
+ * @param src_pitch Bytes between two rows of src
+ * @param format Color format of both buffers
+ * @param w Width of rectangle
+ * @param h Height of rectangle
+ */
+void swift_raster_copy(void *dst, int dst_pitch,
+		       const void *src, int src_pitch,
+		       swift_lcd_pixel_format_t format, int w, int h);
+
+/**
+ * @brief Copy a rectangle and convert between RGB565, RGB888 and ARGB8888
+ *
+ * Narrowing truncates the low bits, widening replicates the high bits so
+ * white stays white. Alpha of ARGB8888 results is 0xFF.
+ *
+ * @param dst Pointer to the first pixel of the destination
+ * @param dst_pitch Bytes between two rows of dst
+ * @param dst_format Color format of dst
+ * @param src Pointer to the first pixel of the source
+ * @param src_pitch Bytes between two rows of src
+ * @param src_format Color format of src
+ * @param w Width of rectangle
+ * @param h Height of rectangle
+ *
+ * @retval 0 If successful.
+ * @retval -EINVAL If a format is 8RAW and the formats differ.
+ */
+int swift_raster_convert(void *dst, int dst_pitch, swift_lcd_pixel_format_t dst_format,
+			 const void *src, int src_pitch, swift_lcd_pixel_format_t src_format,
+			 int w, int h);
+
+/**
+ * @brief Blend an ARGB8888 rectangle over an RGB565 rectangle
+ *
+ * dst = src * a + dst * (1 - a), with a taken from each source pixel.
+ * Opaque and fully transparent pixels skip the arithmetic.
+ *
+ * @param dst Pointer to the first RGB565 pixel of the destination
+ * @param dst_pitch Bytes between two rows of dst
+ * @param src Pointer to the first ARGB8888 pixel of the source
+ * @param src_pitch Bytes between two rows of src
+ * @param w Width of rectangle
+ * @param h Height of rectangle
+ */
+void swift_raster_blend_argb8888_rgb565(uint16_t *dst, int dst_pitch,
+					const uint32_t *src, int src_pitch,
+					int w, int h);
+
+/**
+ * @brief Blend an ARGB8888 rectangle over an ARGB8888 rectangle
+ *
+ * The destination is treated as opaque, its alpha is kept.
+ *
+ * @param dst Pointer to the first pixel of the destination
+ * @param dst_pitch Bytes between two rows of dst
+ * @param src Pointer to the first pixel of the source
+ * @param src_pitch Bytes between two rows of src
+ * @param w Width of rectangle
+ * @param h Height of rectangle
+ */
+void swift_raster_blend_argb8888(uint32_t *dst, int dst_pitch,
+				 const uint32_t *src, int src_pitch,
+				 int w, int h);
+
+/**
+ * @brief Blend a color through an 8-bit alpha mask, used to draw glyphs
+ *
+ * dst = color * mask * color_alpha + dst * (1 - mask * color_alpha)
+ *
+ * @param dst Pointer to the first pixel of the destination
+ * @param dst_pitch Bytes between two rows of dst
+ * @param dst_format RGB565 or ARGB8888
+ * @param mask Pointer to the first alpha value
+ * @param mask_pitch Bytes between two rows of mask
+ * @param w Width of rectangle
+ * @param h Height of rectangle
+ * @param color Color in ARGB8888
+ *
+ * @retval 0 If successful.
+ * @retval -EINVAL If the destination format is not supported.
+ */
+int swift_raster_blend_mask(void *dst, int dst_pitch, swift_lcd_pixel_format_t dst_format,
+			    const uint8_t *mask, int mask_pitch, int w, int h,
+			    uint32_t color);
+
+/**
+ * @brief Swap the bytes of 16-bit pixels in place
+ *
+ * SPI panels expect RGB565 pixels with the high byte first.
+ *
+ * @param buf Pixel buffer
+ * @param count Number of pixels
+ */
+void swift_raster_swap16(uint16_t *buf, ssize_t count);
+
+#endif /* _SWIFT_RASTER_H_ */
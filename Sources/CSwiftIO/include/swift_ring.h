@@ -0,0 +1,383 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#ifndef _SWIFT_RING_H_
+#define _SWIFT_RING_H_
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+/*
+ * Lock-free ring buffers to hand data from interrupts to threads.
+ *
+ * These routines are implemented in this header, they never block and never
+ * call the kernel, so they can be used in ISR. The single producer single
+ * consumer ring (spsc) has one writer and one reader. The multiple producer
+ * single consumer ring (mpsc) accepts writers from several threads and ISRs
+ * at once and has one reader.
+ *
+ * Indexes are free running 32-bit counters, capacity must be a power of two.
+ * The atomics follow the C11 memory model through the compiler __atomic
+ * builtins, so the ring structs stay plain and importable by Swift.
+ *
+ * A reader may sleep when the ring is empty: it checks the ring with
+ * swift_spsc_is_empty or swift_mpsc_is_ready right before, and the push
+ * routines report in wake whether that check may have missed the push, in
+ * which case the writer should wake the reader, for example by giving a
+ * semaphore. Spurious wake-ups are possible, the reader checks again.
+ */
+
+/**
+ * @brief Single producer single consumer ring
+ */
+typedef struct {
+	/** Storage of capacity elements */
+	uint8_t *buf;
+	/** Size of an element in bytes */
+	uint32_t elem_size;
+	/** Capacity minus one */
+	uint32_t mask;
+	/** Count of elements popped, written by the consumer */
+	uint32_t head;
+	/** Count of elements pushed, written by the producer */
+	uint32_t tail;
+} swift_spsc_ring_t;
+
+/**
+ * @brief Multiple producer single consumer ring
+ */
+typedef struct {
+	/** Storage of capacity elements */
+	uint8_t *buf;
+	/** Sequence of each slot, the position + 1 once the slot is filled */
+	uint32_t *seq;
+	/** Size of an element in bytes */
+	uint32_t elem_size;
+	/** Capacity minus one */
+	uint32_t mask;
+	/** Count of elements popped, written by the consumer */
+	uint32_t head;
+	/** Count of slots claimed by producers */
+	uint32_t tail;
+} swift_mpsc_ring_t;
+
+static inline bool swift_ring_is_pow2(uint32_t n)
+{
+	return n != 0 && (n & (n - 1)) == 0;
+}
+
+/* Copies n elements from position pos on, wrapping at the end of the buffer */
+static inline void swift_ring_copy_in(uint8_t *buf, uint32_t mask,
+				      uint32_t elem_size, uint32_t pos,
+				      const uint8_t *src, uint32_t n)
+{
+	uint32_t index = pos & mask;
+	uint32_t first = mask + 1 - index;
+
+	if (first > n) {
+		first = n;
+	}
+	memcpy(buf + index * elem_size, src, first * elem_size);
+	memcpy(buf, src + first * elem_size, (n - first) * elem_size);
+}
+
+static inline void swift_ring_copy_out(const uint8_t *buf, uint32_t mask,
+				       uint32_t elem_size, uint32_t pos,
+				       uint8_t *dst, uint32_t n)
+{
+	uint32_t index = pos & mask;
+	uint32_t first = mask + 1 - index;
+
+	if (first > n) {
+		first = n;
+	}
+	memcpy(dst, buf + index * elem_size, first * elem_size);
+	memcpy(dst + first * elem_size, buf, (n - first) * elem_size);
+}
+
+/**
+ * @brief Initialize a single producer single consumer ring
+ *
+ * @param ring Ring to initialize
+ * @param buf Storage of capacity * elem_size bytes
+ * @param elem_size Size of an element in bytes
+ * @param capacity Count of elements, a power of two
+ * @return 0 on success, -EINVAL if capacity isn't a power of two
+ */
+static inline int swift_spsc_init(swift_spsc_ring_t *ring, void *buf,
+				  uint32_t elem_size, uint32_t capacity)
+{
+	if (!swift_ring_is_pow2(capacity) || elem_size == 0) {
+		return -EINVAL;
+	}
+	ring->buf = (uint8_t *)buf;
+	ring->elem_size = elem_size;
+	ring->mask = capacity - 1;
+	ring->head = 0;
+	ring->tail = 0;
+	return 0;
+}
+
+/**
+ * @brief Count the elements in a single producer single consumer ring
+ *
+ * @param ring Ring
+ * @return Count of elements, exact when called by the producer or consumer
+ */
+static inline uint32_t swift_spsc_count(const swift_spsc_ring_t *ring)
+{
+	uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+	uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+	return tail - head;
+}
+
+/**
+ * @brief Check if a single producer single consumer ring is empty
+ *
+ * Called by the consumer before it sleeps. A push that this check missed
+ * reports that the consumer should be woken up.
+ *
+ * @param ring Ring
+ * @return true if the ring has no element
+ */
+static inline bool swift_spsc_is_empty(const swift_spsc_ring_t *ring)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	return __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) ==
+	       __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Push elements to a single producer single consumer ring
+ *
+ * Only one thread or ISR may push to a ring.
+ *
+ * @param ring Ring
+ * @param elems Elements to push
+ * @param n Count of elements
+ * @param wake Set to whether the consumer should be woken up, may be NULL
+ * @return Count of elements pushed, less than n if the ring is full
+ */
+static inline uint32_t swift_spsc_push(swift_spsc_ring_t *ring,
+				       const void *elems, uint32_t n,
+				       bool *wake)
+{
+	uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+	uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	uint32_t space = ring->mask + 1 - (tail - head);
+
+	if (n > space) {
+		n = space;
+	}
+	if (wake) {
+		*wake = false;
+	}
+	if (n == 0) {
+		return 0;
+	}
+
+	swift_ring_copy_in(ring->buf, ring->mask, ring->elem_size, tail,
+			   (const uint8_t *)elems, n);
+	__atomic_store_n(&ring->tail, tail + n, __ATOMIC_RELEASE);
+
+	if (wake) {
+		/* Pairs with the fence in swift_spsc_is_empty */
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		*wake = __atomic_load_n(&ring->head, __ATOMIC_RELAXED) == tail;
+	}
+	return n;
+}
+
+/**
+ * @brief Pop elements from a single producer single consumer ring
+ *
+ * Only one thread may pop from a ring.
+ *
+ * @param ring Ring
+ * @param elems Buffer for the elements
+ * @param n Most elements to pop
+ * @return Count of elements popped, 0 if the ring is empty
+ */
+static inline uint32_t swift_spsc_pop(swift_spsc_ring_t *ring, void *elems,
+				      uint32_t n)
+{
+	uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+	uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	if (n > tail - head) {
+		n = tail - head;
+	}
+	if (n > 0) {
+		swift_ring_copy_out(ring->buf, ring->mask, ring->elem_size,
+				    head, (uint8_t *)elems, n);
+		__atomic_store_n(&ring->head, head + n, __ATOMIC_RELEASE);
+	}
+
+	return n;
+}
+
+/**
+ * @brief Initialize a multiple producer single consumer ring
+ *
+ * @param ring Ring to initialize
+ * @param buf Storage of capacity * elem_size bytes
+ * @param seq Storage of capacity sequence numbers
+ * @param elem_size Size of an element in bytes
+ * @param capacity Count of elements, a power of two
+ * @return 0 on success, -EINVAL if capacity isn't a power of two
+ */
+static inline int swift_mpsc_init(swift_mpsc_ring_t *ring, void *buf,
+				  uint32_t *seq, uint32_t elem_size,
+				  uint32_t capacity)
+{
+	if (!swift_ring_is_pow2(capacity) || elem_size == 0) {
+		return -EINVAL;
+	}
+	ring->buf = (uint8_t *)buf;
+	ring->seq = seq;
+	ring->elem_size = elem_size;
+	ring->mask = capacity - 1;
+	ring->head = 0;
+	ring->tail = 0;
+	for (uint32_t i = 0; i < capacity; i++) {
+		seq[i] = i;
+	}
+	return 0;
+}
+
+/**
+ * @brief Count the elements in a multiple producer single consumer ring
+ *
+ * @param ring Ring
+ * @return Count of elements claimed by producers and not yet popped
+ */
+static inline uint32_t swift_mpsc_count(const swift_mpsc_ring_t *ring)
+{
+	uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+	uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+	return tail - head;
+}
+
+/**
+ * @brief Check if the next element of a multiple producer single consumer
+ * ring can be popped
+ *
+ * Called by the consumer before it sleeps. A push that this check missed
+ * reports that the consumer should be woken up.
+ *
+ * @param ring Ring
+ * @return true if the oldest slot has been filled by its producer
+ */
+static inline bool swift_mpsc_is_ready(const swift_mpsc_ring_t *ring)
+{
+	uint32_t head;
+
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+	return __atomic_load_n(&ring->seq[head & ring->mask],
+			       __ATOMIC_ACQUIRE) == head + 1;
+}
+
+/**
+ * @brief Push elements to a multiple producer single consumer ring
+ *
+ * Any count of threads and ISRs may push at once. The elements of one push
+ * stay together in the ring.
+ *
+ * @param ring Ring
+ * @param elems Elements to push
+ * @param n Count of elements
+ * @param wake Set to whether the consumer should be woken up, may be NULL
+ * @return Count of elements pushed, less than n if the ring is full
+ */
+static inline uint32_t swift_mpsc_push(swift_mpsc_ring_t *ring,
+				       const void *elems, uint32_t n,
+				       bool *wake)
+{
+	uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+	uint32_t count;
+
+	if (wake) {
+		*wake = false;
+	}
+
+	/* Claim the slots */
+	do {
+		uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		uint32_t space = ring->mask + 1 - (tail - head);
+
+		count = n < space ? n : space;
+		if (count == 0) {
+			return 0;
+		}
+	} while (!__atomic_compare_exchange_n(&ring->tail, &tail, tail + count,
+					      true, __ATOMIC_ACQ_REL,
+					      __ATOMIC_RELAXED));
+
+	swift_ring_copy_in(ring->buf, ring->mask, ring->elem_size, tail,
+			   (const uint8_t *)elems, count);
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t pos = tail + i;
+
+		__atomic_store_n(&ring->seq[pos & ring->mask], pos + 1,
+				 __ATOMIC_RELEASE);
+	}
+
+	if (wake) {
+		/* Pairs with the fence in swift_mpsc_is_ready */
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		*wake = (int32_t)(__atomic_load_n(&ring->head, __ATOMIC_RELAXED)
+				  - tail) >= 0;
+	}
+	return count;
+}
+
+/**
+ * @brief Pop elements from a multiple producer single consumer ring
+ *
+ * Only one thread may pop from a ring. Elements are popped in the order
+ * their slots were claimed, a producer still copying its elements holds
+ * back the ones claimed after it.
+ *
+ * @param ring Ring
+ * @param elems Buffer for the elements
+ * @param n Most elements to pop
+ * @return Count of elements popped, 0 if the ring is empty
+ */
+static inline uint32_t swift_mpsc_pop(swift_mpsc_ring_t *ring, void *elems,
+				      uint32_t n)
+{
+	uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+	uint32_t capacity = ring->mask + 1;
+	uint8_t *dst = (uint8_t *)elems;
+	uint32_t count = 0;
+
+	while (count < n) {
+		uint32_t *seq = &ring->seq[head & ring->mask];
+
+		if (__atomic_load_n(seq, __ATOMIC_ACQUIRE) != head + 1) {
+			break;
+		}
+		memcpy(dst, ring->buf + (head & ring->mask) * ring->elem_size,
+		       ring->elem_size);
+		__atomic_store_n(seq, head + capacity, __ATOMIC_RELAXED);
+		dst += ring->elem_size;
+		head++;
+		count++;
+	}
+	if (count > 0) {
+		__atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+	}
+
+	return count;
+}
+
+#endif /* _SWIFT_RING_H_ */
@@ -121,6 +121,22 @@ int swifthal_spi_async_write(void *spi, const uint8_t *buf, ssize_t length);
  */
 int swifthal_spi_async_read(void *spi, uint8_t *buf, ssize_t length);
 
+/**
+ * @brief Install a callback for the completion of asynchronous transfers
+ *
+ * The callback is called in interrupt context each time a transfer started
+ * by swifthal_spi_async_write or swifthal_spi_async_read completes. Only
+ * one transfer can be in flight on a SPI at a time.
+ *
+ * @param spi SPI Handle
+ * @param param Callback paramater
+ * @param callback Transfer complete callback, NULL to uninstall
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+int swifthal_spi_async_callback_install(void *spi, const void *param, void (*callback)(const void *));
+
 /**
  * @brief Get SPI support device number
  *
@@ -195,6 +195,22 @@ int swifthal_uart_remainder_get(void *uart);
  */
 int swifthal_uart_buffer_clear(void *uart);
 
+/**
+ * @brief Set event group flags when data is received
+ *
+ * The flags are set from the receive ISR each time bytes arrive in the
+ * read buffer, so a thread can wait for UART data together with other
+ * events.
+ *
+ * @param uart Uart handle
+ * @param event Event group handle from swifthal_os_event_create, NULL to stop
+ * @param flags Flags to set
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+int swifthal_uart_rx_event_set(void *uart, const void *event, uint32_t flags);
+
 /**
  * @brief Get UART support device number
  *
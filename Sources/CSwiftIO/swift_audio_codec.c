@@ -0,0 +1,218 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+
+#include "swift_audio_codec.h"
+
+/*
+ * G.711 expansion tables. A lookup is a single load per sample, which is
+ * faster than the segment arithmetic on both the board and the host.
+ */
+static const int16_t ulaw_table[256] = {
+	-32124, -31100, -30076, -29052, -28028, -27004, -25980, -24956,
+	-23932, -22908, -21884, -20860, -19836, -18812, -17788, -16764,
+	-15996, -15484, -14972, -14460, -13948, -13436, -12924, -12412,
+	-11900, -11388, -10876, -10364, -9852, -9340, -8828, -8316,
+	-7932, -7676, -7420, -7164, -6908, -6652, -6396, -6140,
+	-5884, -5628, -5372, -5116, -4860, -4604, -4348, -4092,
+	-3900, -3772, -3644, -3516, -3388, -3260, -3132, -3004,
+	-2876, -2748, -2620, -2492, -2364, -2236, -2108, -1980,
+	-1884, -1820, -1756, -1692, -1628, -1564, -1500, -1436,
+	-1372, -1308, -1244, -1180, -1116, -1052, -988, -924,
+	-876, -844, -812, -780, -748, -716, -684, -652,
+	-620, -588, -556, -524, -492, -460, -428, -396,
+	-372, -356, -340, -324, -308, -292, -276, -260,
+	-244, -228, -212, -196, -180, -164, -148, -132,
+	-120, -112, -104, -96, -88, -80, -72, -64,
+	-56, -48, -40, -32, -24, -16, -8, 0,
+	32124, 31100, 30076, 29052, 28028, 27004, 25980, 24956,
+	23932, 22908, 21884, 20860, 19836, 18812, 17788, 16764,
+	15996, 15484, 14972, 14460, 13948, 13436, 12924, 12412,
+	11900, 11388, 10876, 10364, 9852, 9340, 8828, 8316,
+	7932, 7676, 7420, 7164, 6908, 6652, 6396, 6140,
+	5884, 5628, 5372, 5116, 4860, 4604, 4348, 4092,
+	3900, 3772, 3644, 3516, 3388, 3260, 3132, 3004,
+	2876, 2748, 2620, 2492, 2364, 2236, 2108, 1980,
+	1884, 1820, 1756, 1692, 1628, 1564, 1500, 1436,
+	1372, 1308, 1244, 1180, 1116, 1052, 988, 924,
+	876, 844, 812, 780, 748, 716, 684, 652,
+	620, 588, 556, 524, 492, 460, 428, 396,
+	372, 356, 340, 324, 308, 292, 276, 260,
+	244, 228, 212, 196, 180, 164, 148, 132,
+	120, 112, 104, 96, 88, 80, 72, 64,
+	56, 48, 40, 32, 24, 16, 8, 0,
+};
+
+static const int16_t alaw_table[256] = {
+	-5504, -5248, -6016, -5760, -4480, -4224, -4992, -4736,
+	-7552, -7296, -8064, -7808, -6528, -6272, -7040, -6784,
+	-2752, -2624, -3008, -2880, -2240, -2112, -2496, -2368,
+	-3776, -3648, -4032, -3904, -3264, -3136, -3520, -3392,
+	-22016, -20992, -24064, -23040, -17920, -16896, -19968, -18944,
+	-30208, -29184, -32256, -31232, -26112, -25088, -28160, -27136,
+	-11008, -10496, -12032, -11520, -8960, -8448, -9984, -9472,
+	-15104, -14592, -16128, -15616, -13056, -12544, -14080, -13568,
+	-344, -328, -376, -360, -280, -264, -312, -296,
+	-472, -456, -504, -488, -408, -392, -440, -424,
+	-88, -72, -120, -104, -24, -8, -56, -40,
+	-216, -200, -248, -232, -152, -136, -184, -168,
+	-1376, -1312, -1504, -1440, -1120, -1056, -1248, -1184,
+	-1888, -1824, -2016, -1952, -1632, -1568, -1760, -1696,
+	-688, -656, -752, -720, -560, -528, -624, -592,
+	-944, -912, -1008, -976, -816, -784, -880, -848,
+	5504, 5248, 6016, 5760, 4480, 4224, 4992, 4736,
+	7552, 7296, 8064, 7808, 6528, 6272, 7040, 6784,
+	2752, 2624, 3008, 2880, 2240, 2112, 2496, 2368,
+	3776, 3648, 4032, 3904, 3264, 3136, 3520, 3392,
+	22016, 20992, 24064, 23040, 17920, 16896, 19968, 18944,
+	30208, 29184, 32256, 31232, 26112, 25088, 28160, 27136,
+	11008, 10496, 12032, 11520, 8960, 8448, 9984, 9472,
+	15104, 14592, 16128, 15616, 13056, 12544, 14080, 13568,
+	344, 328, 376, 360, 280, 264, 312, 296,
+	472, 456, 504, 488, 408, 392, 440, 424,
+	88, 72, 120, 104, 24, 8, 56, 40,
+	216, 200, 248, 232, 152, 136, 184, 168,
+	1376, 1312, 1504, 1440, 1120, 1056, 1248, 1184,
+	1888, 1824, 2016, 1952, 1632, 1568, 1760, 1696,
+	688, 656, 752, 720, 560, 528, 624, 592,
+	944, 912, 1008, 976, 816, 784, 880, 848,
+};
+
+static const int16_t ima_step_table[89] = {
+	7, 8, 9, 10, 11, 12, 13, 14,
+	16, 17, 19, 21, 23, 25, 28, 31,
+	34, 37, 41, 45, 50, 55, 60, 66,
+	73, 80, 88, 97, 107, 118, 130, 143,
+	157, 173, 190, 209, 230, 253, 279, 307,
+	337, 371, 408, 449, 494, 544, 598, 658,
+	724, 796, 876, 963, 1060, 1166, 1282, 1411,
+	1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
+	3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484,
+	7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+	32767,
+};
+
+static const int8_t ima_index_table[16] = {
+	-1, -1, -1, -1, 2, 4, 6, 8,
+	-1, -1, -1, -1, 2, 4, 6, 8,
+};
+
+struct ima_state {
+	int32_t predictor;
+	int32_t index;
+};
+
+void swift_audio_ulaw_decode(int16_t *dst, const uint8_t *src, ssize_t count)
+{
+	ssize_t i;
+
+	/* Forward order keeps the in-place case safe, see the header */
+	for (i = 0; i < count; i++) {
+		dst[i] = ulaw_table[src[i]];
+	}
+}
+
+void swift_audio_alaw_decode(int16_t *dst, const uint8_t *src, ssize_t count)
+{
+	ssize_t i;
+
+	for (i = 0; i < count; i++) {
+		dst[i] = alaw_table[src[i]];
+	}
+}
+
+static inline int16_t ima_decode_nibble(struct ima_state *state, uint32_t nibble)
+{
+	int32_t step = ima_step_table[state->index];
+	int32_t diff = step >> 3;
+
+	if (nibble & 1) {
+		diff += step >> 2;
+	}
+	if (nibble & 2) {
+		diff += step >> 1;
+	}
+	if (nibble & 4) {
+		diff += step;
+	}
+	if (nibble & 8) {
+		diff = -diff;
+	}
+
+	state->predictor += diff;
+	if (state->predictor > INT16_MAX) {
+		state->predictor = INT16_MAX;
+	} else if (state->predictor < INT16_MIN) {
+		state->predictor = INT16_MIN;
+	}
+
+	state->index += ima_index_table[nibble];
+	if (state->index < 0) {
+		state->index = 0;
+	} else if (state->index > 88) {
+		state->index = 88;
+	}
+
+	return (int16_t)state->predictor;
+}
+
+ssize_t swift_audio_ima_block_frames(ssize_t block_size, int channels)
+{
+	ssize_t groups;
+
+	if (channels <= 0 || block_size < 4 * channels) {
+		return 0;
+	}
+
+	groups = (block_size - 4 * channels) / (4 * channels);
+	return 1 + groups * 8;
+}
+
+ssize_t swift_audio_ima_decode_block(int16_t *dst, const uint8_t *block,
+				     ssize_t block_size, int channels)
+{
+	struct ima_state state[2];
+	ssize_t frames = swift_audio_ima_block_frames(block_size, channels);
+	ssize_t groups = (frames - 1) / 8;
+	const uint8_t *data;
+	ssize_t g;
+	int ch;
+
+	if (channels != 1 && channels != 2) {
+		return -EINVAL;
+	}
+	if (frames == 0) {
+		return 0;
+	}
+
+	for (ch = 0; ch < channels; ch++) {
+		const uint8_t *header = block + 4 * ch;
+
+		state[ch].predictor = (int16_t)(header[0] | (header[1] << 8));
+		state[ch].index = header[2] > 88 ? 88 : header[2];
+		dst[ch] = (int16_t)state[ch].predictor;
+	}
+
+	data = block + 4 * channels;
+	for (g = 0; g < groups; g++) {
+		for (ch = 0; ch < channels; ch++) {
+			int16_t *out = dst + (1 + g * 8) * channels + ch;
+			/* 4 bytes hold 8 samples, low nibble first */
+			uint32_t word = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+			int k;
+
+			for (k = 0; k < 8; k++) {
+				out[k * channels] = ima_decode_nibble(&state[ch], word & 0x0F);
+				word >>= 4;
+			}
+			data += 4;
+		}
+	}
+
+	return frames;
+}
@@ -0,0 +1,487 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "swift_audio_format.h"
+
+#if defined(__ARM_FEATURE_DSP) || defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#endif
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Samples processed per pass of the fused I2S conversion */
+#define AUDIO_TILE_SAMPLES	128
+
+static inline int32_t sat16(int32_t x)
+{
+#if defined(__ARM_FEATURE_SAT)
+	return __ssat(x, 16);
+#else
+	return x > INT16_MAX ? INT16_MAX : (x < INT16_MIN ? INT16_MIN : x);
+#endif
+}
+
+static inline int32_t sat32(int64_t x)
+{
+	return x > INT32_MAX ? INT32_MAX : (x < INT32_MIN ? INT32_MIN : (int32_t)x);
+}
+
+void swift_audio_mono_to_stereo_s16(int16_t *dst, const int16_t *src, ssize_t frames)
+{
+	ssize_t i = 0;
+
+#if defined(__ARM_NEON)
+	for (; i + 8 <= frames; i += 8) {
+		int16x8_t v = vld1q_s16(src + i);
+		int16x8x2_t z = { { v, v } };
+
+		vst2q_s16(dst + 2 * i, z);
+	}
+#elif defined(__SSE2__)
+	for (; i + 8 <= frames; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+
+		_mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_unpacklo_epi16(v, v));
+		_mm_storeu_si128((__m128i *)(dst + 2 * i + 8), _mm_unpackhi_epi16(v, v));
+	}
+#else
+	/* Two samples per word, packs into PKHBT/PKHTB on the DSP extension */
+	for (; i + 2 <= frames; i += 2) {
+		uint32_t w, out[2];
+
+		memcpy(&w, src + i, sizeof(w));
+		out[0] = (w & 0xFFFFu) | (w << 16);
+		out[1] = (w >> 16) | (w & 0xFFFF0000u);
+		memcpy(dst + 2 * i, out, sizeof(out));
+	}
+#endif
+	for (; i < frames; i++) {
+		dst[2 * i] = src[i];
+		dst[2 * i + 1] = src[i];
+	}
+}
+
+void swift_audio_mono_to_stereo_s32(int32_t *dst, const int32_t *src, ssize_t frames)
+{
+	ssize_t i = 0;
+
+#if defined(__ARM_NEON)
+	for (; i + 4 <= frames; i += 4) {
+		int32x4_t v = vld1q_s32(src + i);
+		int32x4x2_t z = { { v, v } };
+
+		vst2q_s32(dst + 2 * i, z);
+	}
+#elif defined(__SSE2__)
+	for (; i + 4 <= frames; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+
+		_mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_unpacklo_epi32(v, v));
+		_mm_storeu_si128((__m128i *)(dst + 2 * i + 4), _mm_unpackhi_epi32(v, v));
+	}
+#endif
+	for (; i < frames; i++) {
+		dst[2 * i] = src[i];
+		dst[2 * i + 1] = src[i];
+	}
+}
+
+void swift_audio_interleave_s16(int16_t *dst, const int16_t *left, const int16_t *right, ssize_t frames)
+{
+	ssize_t i = 0;
+
+#if defined(__ARM_NEON)
+	for (; i + 8 <= frames; i += 8) {
+		int16x8x2_t z = { { vld1q_s16(left + i), vld1q_s16(right + i) } };
+
+		vst2q_s16(dst + 2 * i, z);
+	}
+#elif defined(__SSE2__)
+	for (; i + 8 <= frames; i += 8) {
+		__m128i l = _mm_loadu_si128((const __m128i *)(left + i));
+		__m128i r = _mm_loadu_si128((const __m128i *)(right + i));
+
+		_mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_unpacklo_epi16(l, r));
+		_mm_storeu_si128((__m128i *)(dst + 2 * i + 8), _mm_unpackhi_epi16(l, r));
+	}
+#endif
+	for (; i < frames; i++) {
+		dst[2 * i] = left[i];
+		dst[2 * i + 1] = right[i];
+	}
+}
+
+void swift_audio_interleave_s32(int32_t *dst, const int32_t *left, const int32_t *right, ssize_t frames)
+{
+	ssize_t i = 0;
+
+#if defined(__ARM_NEON)
+	for (; i + 4 <= frames; i += 4) {
+		int32x4x2_t z = { { vld1q_s32(left + i), vld1q_s32(right + i) } };
+
+		vst2q_s32(dst + 2 * i, z);
+	}
+#elif defined(__SSE2__)
+	for (; i + 4 <= frames; i += 4) {
+		__m128i l = _mm_loadu_si128((const __m128i *)(left + i));
+		__m128i r = _mm_loadu_si128((const __m128i *)(right + i));
+
+		_mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_unpacklo_epi32(l, r));
+		_mm_storeu_si128((__m128i *)(dst + 2 * i + 4), _mm_unpackhi_epi32(l, r));
+	}
+#endif
+	for (; i < frames; i++) {
+		dst[2 * i] = left[i];
+		dst[2 * i + 1] = right[i];
+	}
+}
+
+void swift_audio_deinterleave_s16(int16_t *left, int16_t *right, const int16_t *src, ssize_t frames)
+{
+	ssize_t i = 0;
+
+#if defined(__ARM_NEON)
+	for (; i + 8 <= frames; i += 8) {
+		int16x8x2_t z = vld2q_s16(src + 2 * i);
+
+		vst1q_s16(left + i, z.val[0]);
+		vst1q_s16(right + i, z.val[1]);
+	}
+#elif defined(__SSE2__)
+	for (; i + 8 <= frames; i += 8) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(src + 2 * i + 8));
+		/* Sign extend the even lanes, shift down the odd lanes, then pack */
+		__m128i la = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+		__m128i lb = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+		__m128i ra = _mm_srai_epi32(a, 16);
+		__m128i rb = _mm_srai_epi32(b, 16);
+
+		_mm_storeu_si128((__m128i *)(left + i), _mm_packs_epi32(la, lb));
+		_mm_storeu_si128((__m128i *)(right + i), _mm_packs_epi32(ra, rb));
+	}
+#endif
+	for (; i < frames; i++) {
+		left[i] = src[2 * i];
+		right[i] = src[2 * i + 1];
+	}
+}
+
+void swift_audio_deinterleave_s32(int32_t *left, int32_t *right, const int32_t *src, ssize_t frames)
+{
+	ssize_t i = 0;
+
+#if defined(__ARM_NEON)
+	for (; i + 4 <= frames; i += 4) {
+		int32x4x2_t z = vld2q_s32(src + 2 * i);
+
+		vst1q_s32(left + i, z.val[0]);
+		vst1q_s32(right + i, z.val[1]);
+	}
+#endif
+	for (; i < frames; i++) {
+		left[i] = src[2 * i];
+		right[i] = src[2 * i + 1];
+	}
+}
+
+/*
+ * Widen 16-bit samples into 32-bit containers. When dup is set every sample
+ * is written twice, which turns mono into interleaved stereo for free.
+ */
+static void widen_s16(int32_t *dst, const int16_t *src, ssize_t count, int shift, int dup)
+{
+	ssize_t i = 0;
+
+#if defined(__ARM_NEON)
+	{
+		const int32x4_t s = vdupq_n_s32(shift);
+
+		for (; i + 8 <= count; i += 8) {
+			int16x8_t v = vld1q_s16(src + i);
+			int32x4_t lo = vshlq_s32(vmovl_s16(vget_low_s16(v)), s);
+			int32x4_t hi = vshlq_s32(vmovl_s16(vget_high_s16(v)), s);
+
+			if (dup) {
+				int32x4x2_t zl = { { lo, lo } };
+				int32x4x2_t zh = { { hi, hi } };
+
+				vst2q_s32(dst + 2 * i, zl);
+				vst2q_s32(dst + 2 * i + 8, zh);
+			} else {
+				vst1q_s32(dst + i, lo);
+				vst1q_s32(dst + i + 4, hi);
+			}
+		}
+	}
+#elif defined(__SSE2__)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		for (; i + 8 <= count; i += 8) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+			/* Placing the sample in the upper half yields x << 16 */
+			__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(zero, v), 16 - shift);
+			__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(zero, v), 16 - shift);
+
+			if (dup) {
+				_mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_unpacklo_epi32(lo, lo));
+				_mm_storeu_si128((__m128i *)(dst + 2 * i + 4), _mm_unpackhi_epi32(lo, lo));
+				_mm_storeu_si128((__m128i *)(dst + 2 * i + 8), _mm_unpacklo_epi32(hi, hi));
+				_mm_storeu_si128((__m128i *)(dst + 2 * i + 12), _mm_unpackhi_epi32(hi, hi));
+			} else {
+				_mm_storeu_si128((__m128i *)(dst + i), lo);
+				_mm_storeu_si128((__m128i *)(dst + i + 4), hi);
+			}
+		}
+	}
+#endif
+	if (dup) {
+		for (; i < count; i++) {
+			int32_t v = (int32_t)((uint32_t)(int32_t)src[i] << shift);
+
+			dst[2 * i] = v;
+			dst[2 * i + 1] = v;
+		}
+	} else {
+		for (; i < count; i++) {
+			dst[i] = (int32_t)((uint32_t)(int32_t)src[i] << shift);
+		}
+	}
+}
+
+static int container_bytes(int bits)
+{
+	switch (bits) {
+	case 8:
+		return 1;
+	case 16:
+		return 2;
+	case 24:
+	case 32:
+		return 4;
+	default:
+		return -EINVAL;
+	}
+}
+
+static inline int32_t load_sample(const void *src, int bytes, ssize_t i)
+{
+	switch (bytes) {
+	case 1:
+		return ((const int8_t *)src)[i];
+	case 2:
+		return ((const int16_t *)src)[i];
+	default:
+		return ((const int32_t *)src)[i];
+	}
+}
+
+static inline void store_sample(void *dst, int bytes, ssize_t i, int32_t v)
+{
+	switch (bytes) {
+	case 1:
+		((int8_t *)dst)[i] = (int8_t)v;
+		break;
+	case 2:
+		((int16_t *)dst)[i] = (int16_t)v;
+		break;
+	default:
+		((int32_t *)dst)[i] = v;
+		break;
+	}
+}
+
+int swift_audio_convert(void *dst, int dst_bits, const void *src, int src_bits, ssize_t count)
+{
+	int dst_bytes = container_bytes(dst_bits);
+	int src_bytes = container_bytes(src_bits);
+	int shift = dst_bits - src_bits;
+	ssize_t i;
+
+	if (dst_bytes < 0 || src_bytes < 0 || count < 0) {
+		return -EINVAL;
+	}
+
+	if (src_bits == 16 && dst_bytes == 4) {
+		widen_s16(dst, src, count, shift, 0);
+		return 0;
+	}
+
+	if (shift == 0) {
+		if (dst != src) {
+			memmove(dst, src, count * src_bytes);
+		}
+		return 0;
+	}
+
+	/*
+	 * Widening into a larger container must walk backwards so in-place
+	 * conversion doesn't overwrite unread samples; narrowing walks forwards.
+	 */
+	if (dst_bytes > src_bytes) {
+		for (i = count - 1; i >= 0; i--) {
+			store_sample(dst, dst_bytes, i,
+				     (int32_t)((uint32_t)load_sample(src, src_bytes, i) << shift));
+		}
+	} else if (shift > 0) {
+		for (i = 0; i < count; i++) {
+			store_sample(dst, dst_bytes, i,
+				     (int32_t)((uint32_t)load_sample(src, src_bytes, i) << shift));
+		}
+	} else {
+		for (i = 0; i < count; i++) {
+			store_sample(dst, dst_bytes, i, load_sample(src, src_bytes, i) >> -shift);
+		}
+	}
+
+	return 0;
+}
+
+/* Same as swift_audio_gain_q15() but reads from src, src may equal dst */
+static void gain_q15_copy(int16_t *dst, const int16_t *src, ssize_t count, int32_t gain)
+{
+	ssize_t i = 0;
+
+	if (gain >= SWIFT_AUDIO_GAIN_Q15_UNITY) {
+		if (dst != src) {
+			memcpy(dst, src, count * sizeof(int16_t));
+		}
+		return;
+	}
+
+#if defined(__ARM_FEATURE_DSP)
+	{
+		int32_t g = gain & 0xFFFF;
+
+		for (; i + 2 <= count; i += 2) {
+			int32_t w;
+			int32_t lo, hi;
+
+			memcpy(&w, src + i, sizeof(w));
+			lo = __ssat((__smulbb(w, g) + 0x4000) >> 15, 16);
+			hi = __ssat((__smultb(w, g) + 0x4000) >> 15, 16);
+			w = (int32_t)(((uint32_t)lo & 0xFFFFu) | ((uint32_t)hi << 16));
+			memcpy(dst + i, &w, sizeof(w));
+		}
+	}
+#elif defined(__ARM_NEON)
+	{
+		int16_t g = (int16_t)gain;
+
+		/* vqrdmulh computes sat((2 * x * g + 2^15) >> 16), the rounded Q15 product */
+		for (; i + 8 <= count; i += 8) {
+			vst1q_s16(dst + i, vqrdmulhq_n_s16(vld1q_s16(src + i), g));
+		}
+	}
+#elif defined(__SSE2__)
+	{
+		const __m128i g = _mm_set1_epi16((int16_t)gain);
+		const __m128i round = _mm_set1_epi32(0x4000);
+
+		for (; i + 8 <= count; i += 8) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+			__m128i lo = _mm_mullo_epi16(v, g);
+			__m128i hi = _mm_mulhi_epi16(v, g);
+			__m128i p0 = _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round);
+			__m128i p1 = _mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round);
+
+			p0 = _mm_srai_epi32(p0, 15);
+			p1 = _mm_srai_epi32(p1, 15);
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(p0, p1));
+		}
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = (int16_t)sat16((src[i] * gain + 0x4000) >> 15);
+	}
+}
+
+void swift_audio_gain_q15(int16_t *buf, ssize_t count, int32_t gain_q15)
+{
+	gain_q15_copy(buf, buf, count, gain_q15);
+}
+
+void swift_audio_gain_q31(int32_t *buf, ssize_t count, int32_t gain_q31)
+{
+	ssize_t i;
+
+	for (i = 0; i < count; i++) {
+		buf[i] = sat32(((int64_t)buf[i] * gain_q31 + (1 << 30)) >> 31);
+	}
+}
+
+int swift_audio_s16_to_i2s(void *dst, int dst_bits,
+			   const int16_t *src, int src_channels,
+			   ssize_t frames, int32_t gain_q15)
+{
+	int16_t tile[AUDIO_TILE_SAMPLES];
+	int dst_bytes = container_bytes(dst_bits);
+	ssize_t count = frames * src_channels;
+	ssize_t done = 0;
+
+	if (dst_bytes < 0 || (src_channels != 1 && src_channels != 2) || frames < 0 ||
+	    gain_q15 < INT16_MIN || gain_q15 > SWIFT_AUDIO_GAIN_Q15_UNITY) {
+		return -EINVAL;
+	}
+
+	/*
+	 * Work through the source in small tiles so the gain stage stays in
+	 * registers/L1 and no frame sized scratch buffer is needed.
+	 */
+	while (done < count) {
+		ssize_t n = count - done;
+		const int16_t *in = src + done;
+		/* Output sample index of the first sample in this tile */
+		ssize_t out = done * 2 / src_channels;
+		ssize_t i;
+
+		if (n > AUDIO_TILE_SAMPLES) {
+			n = AUDIO_TILE_SAMPLES;
+		}
+
+		if (gain_q15 != SWIFT_AUDIO_GAIN_Q15_UNITY) {
+			gain_q15_copy(tile, in, n, gain_q15);
+			in = tile;
+		}
+
+		switch (dst_bits) {
+		case 8:
+			for (i = 0; i < n; i++) {
+				int8_t v = (int8_t)(in[i] >> 8);
+
+				if (src_channels == 1) {
+					((int8_t *)dst)[out + 2 * i] = v;
+					((int8_t *)dst)[out + 2 * i + 1] = v;
+				} else {
+					((int8_t *)dst)[out + i] = v;
+				}
+			}
+			break;
+		case 16:
+			if (src_channels == 1) {
+				swift_audio_mono_to_stereo_s16((int16_t *)dst + out, in, n);
+			} else {
+				memcpy((int16_t *)dst + out, in, n * sizeof(int16_t));
+			}
+			break;
+		default:
+			widen_s16((int32_t *)dst + out, in, n, dst_bits - 16, src_channels == 1);
+			break;
+		}
+
+		done += n;
+	}
+
+	return (int)(frames * 2 * dst_bytes);
+}
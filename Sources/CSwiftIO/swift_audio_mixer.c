@@ -0,0 +1,181 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+
+#include "swift_audio_mixer.h"
+
+#if defined(__ARM_FEATURE_DSP) || defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#endif
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* One period of sin() in Q15, the extra entry makes interpolation branch free */
+static const int16_t sine_table[257] = {
+	0, 804, 1608, 2410, 3212, 4011, 4808, 5602,
+	6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+	12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+	18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+	23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+	27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+	30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+	32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+	32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285,
+	32137, 31971, 31785, 31580, 31356, 31113, 30852, 30571,
+	30273, 29956, 29621, 29268, 28898, 28510, 28105, 27683,
+	27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731,
+	23170, 22594, 22005, 21403, 20787, 20159, 19519, 18868,
+	18204, 17530, 16846, 16151, 15446, 14732, 14010, 13279,
+	12539, 11793, 11039, 10278, 9512, 8739, 7962, 7179,
+	6393, 5602, 4808, 4011, 3212, 2410, 1608, 804,
+	0, -804, -1608, -2410, -3212, -4011, -4808, -5602,
+	-6393, -7179, -7962, -8739, -9512, -10278, -11039, -11793,
+	-12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530,
+	-18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+	-23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+	-27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+	-30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+	-32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+	-32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+	-32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+	-30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+	-27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+	-23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868,
+	-18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+	-12539, -11793, -11039, -10278, -9512, -8739, -7962, -7179,
+	-6393, -5602, -4808, -4011, -3212, -2410, -1608, -804,
+	0,
+};
+
+static inline int32_t sat16(int32_t x)
+{
+#if defined(__ARM_FEATURE_SAT)
+	return __ssat(x, 16);
+#else
+	return x > INT16_MAX ? INT16_MAX : (x < INT16_MIN ? INT16_MIN : x);
+#endif
+}
+
+static inline int32_t scale_q15(int32_t x, int32_t gain)
+{
+	return sat16((x * gain + 0x4000) >> 15);
+}
+
+void swift_audio_mix_s16(int16_t *dst, const int16_t *src, int src_channels,
+			 ssize_t frames, int16_t gain_left, int16_t gain_right)
+{
+	ssize_t i = 0;
+
+#if defined(__ARM_FEATURE_DSP)
+	{
+		/*
+		 * One stereo frame per 32-bit word, QADD16 saturates both halves.
+		 * SMULxB take the gains from the bottom halves, the mono products
+		 * use the signed gains.
+		 */
+		int32_t gl = gain_left & 0xFFFF;
+		int32_t gr = gain_right & 0xFFFF;
+
+		for (; i < frames; i++) {
+			int32_t l, r, w, d;
+
+			if (src_channels == 1) {
+				l = (int32_t)src[i] * gain_left;
+				r = (int32_t)src[i] * gain_right;
+			} else {
+				memcpy(&w, src + 2 * i, sizeof(w));
+				l = __smulbb(w, gl);
+				r = __smultb(w, gr);
+			}
+			l = __ssat((l + 0x4000) >> 15, 16);
+			r = __ssat((r + 0x4000) >> 15, 16);
+			w = (int32_t)(((uint32_t)l & 0xFFFFu) | ((uint32_t)r << 16));
+			memcpy(&d, dst + 2 * i, sizeof(d));
+			d = __qadd16(d, w);
+			memcpy(dst + 2 * i, &d, sizeof(d));
+		}
+	}
+#elif defined(__ARM_NEON)
+	for (; i + 8 <= frames; i += 8) {
+		int16x8x2_t bus = vld2q_s16(dst + 2 * i);
+		int16x8_t l, r;
+
+		if (src_channels == 1) {
+			int16x8_t v = vld1q_s16(src + i);
+
+			l = v;
+			r = v;
+		} else {
+			int16x8x2_t v = vld2q_s16(src + 2 * i);
+
+			l = v.val[0];
+			r = v.val[1];
+		}
+		/* vqrdmulh is the rounded, saturated Q15 product */
+		bus.val[0] = vqaddq_s16(bus.val[0], vqrdmulhq_n_s16(l, gain_left));
+		bus.val[1] = vqaddq_s16(bus.val[1], vqrdmulhq_n_s16(r, gain_right));
+		vst2q_s16(dst + 2 * i, bus);
+	}
+#elif defined(__SSE2__)
+	{
+		const __m128i gl = _mm_set1_epi16(gain_left);
+		const __m128i gr = _mm_set1_epi16(gain_right);
+		/* Even lanes get the left gain, odd lanes the right gain */
+		const __m128i glr = _mm_unpacklo_epi16(gl, gr);
+		const __m128i round = _mm_set1_epi32(0x4000);
+
+		for (; i + 4 <= frames; i += 4) {
+			__m128i v, lo, hi, p0, p1;
+
+			if (src_channels == 1) {
+				__m128i m = _mm_loadl_epi64((const __m128i *)(src + i));
+
+				v = _mm_unpacklo_epi16(m, m);
+			} else {
+				v = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+			}
+			lo = _mm_mullo_epi16(v, glr);
+			hi = _mm_mulhi_epi16(v, glr);
+			p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), 15);
+			p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), 15);
+			v = _mm_packs_epi32(p0, p1);
+			v = _mm_adds_epi16(_mm_loadu_si128((const __m128i *)(dst + 2 * i)), v);
+			_mm_storeu_si128((__m128i *)(dst + 2 * i), v);
+		}
+	}
+#endif
+	for (; i < frames; i++) {
+		int32_t l = src_channels == 1 ? src[i] : src[2 * i];
+		int32_t r = src_channels == 1 ? src[i] : src[2 * i + 1];
+
+		dst[2 * i] = (int16_t)sat16(dst[2 * i] + scale_q15(l, gain_left));
+		dst[2 * i + 1] = (int16_t)sat16(dst[2 * i + 1] + scale_q15(r, gain_right));
+	}
+}
+
+void swift_audio_tone_s16(int16_t *dst, ssize_t frames,
+			  uint32_t *phase, uint32_t phase_step, int16_t amplitude)
+{
+	uint32_t p = *phase;
+	ssize_t i;
+
+	for (i = 0; i < frames; i++) {
+		uint32_t index = p >> 24;
+		int32_t frac = (int32_t)((p >> 8) & 0xFFFF);
+		int32_t a = sine_table[index];
+		int32_t b = sine_table[index + 1];
+		int32_t s = a + (((b - a) * frac) >> 16);
+
+		dst[i] = (int16_t)((s * amplitude + 0x4000) >> 15);
+		p += phase_step;
+	}
+	*phase = p;
+}
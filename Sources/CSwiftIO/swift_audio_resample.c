@@ -0,0 +1,297 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+
+#include "swift_audio_resample.h"
+
+#if defined(__ARM_FEATURE_DSP) || defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#endif
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define RESAMPLE_ONE		((uint64_t)1 << 32)
+#define RESAMPLE_MAX_CHANNELS	2
+
+struct resampler {
+	int channels;
+	int taps;
+	int phase_bits;
+	/* Input samples per output sample in Q32.32 */
+	uint64_t step;
+	/* Position of the next output, relative to the filter window, Q32.32 */
+	uint64_t position;
+	/* Write index into the history rings */
+	int head;
+	/* phases * taps Q15 coefficients, NULL for linear interpolation */
+	int16_t *coef;
+	/*
+	 * Per channel ring of 2 * taps samples. Every sample is stored twice,
+	 * taps apart, so the newest taps samples are always contiguous.
+	 */
+	int16_t *history[RESAMPLE_MAX_CHANNELS];
+};
+
+static void quality_params(swift_audio_resample_quality_t quality, int *taps, int *phase_bits)
+{
+	switch (quality) {
+	case SWIFT_AUDIO_RESAMPLE_FAST:
+		*taps = 2;
+		*phase_bits = 0;
+		break;
+	case SWIFT_AUDIO_RESAMPLE_MEDIUM:
+		*taps = 8;
+		*phase_bits = 6;
+		break;
+	case SWIFT_AUDIO_RESAMPLE_HIGH:
+		*taps = 16;
+		*phase_bits = 7;
+		break;
+	default:
+		*taps = 0;
+		*phase_bits = 0;
+		break;
+	}
+}
+
+static inline int32_t sat16(int32_t x)
+{
+#if defined(__ARM_FEATURE_SAT)
+	return __ssat(x, 16);
+#else
+	return x > INT16_MAX ? INT16_MAX : (x < INT16_MIN ? INT16_MIN : x);
+#endif
+}
+
+static ssize_t align4(ssize_t size)
+{
+	return (size + 3) & ~(ssize_t)3;
+}
+
+ssize_t swift_audio_resampler_size(swift_audio_resample_quality_t quality, int channels)
+{
+	int taps, phase_bits;
+	ssize_t size;
+
+	quality_params(quality, &taps, &phase_bits);
+	if (taps == 0 || channels < 1 || channels > RESAMPLE_MAX_CHANNELS) {
+		return -EINVAL;
+	}
+
+	size = align4(sizeof(struct resampler));
+	if (phase_bits > 0) {
+		size += align4(sizeof(int16_t) * taps << phase_bits);
+	}
+	size += align4(sizeof(int16_t) * 2 * taps) * channels;
+
+	return size;
+}
+
+/* Blackman windowed sinc, cutoff relative to the input Nyquist frequency */
+static void design_filter(int16_t *coef, int taps, int phases, double cutoff)
+{
+	const double pi = 3.14159265358979323846;
+	int p, k;
+
+	for (p = 0; p < phases; p++) {
+		double frac = (double)p / phases;
+		double h[32];
+		double sum = 0.0;
+		int32_t total = 0;
+		int16_t *row = coef + p * taps;
+
+		for (k = 0; k < taps; k++) {
+			/* Distance from the output point, which lies frac after tap taps/2 - 1 */
+			double x = (double)(k - (taps / 2 - 1)) - frac;
+			double w = (x + taps / 2.0) / taps;
+			double s = x == 0.0 ? 1.0 : sin(pi * cutoff * x) / (pi * cutoff * x);
+
+			if (w < 0.0 || w > 1.0) {
+				w = 0.0;
+			} else {
+				w = 0.42 - 0.5 * cos(2.0 * pi * w) + 0.08 * cos(4.0 * pi * w);
+			}
+			h[k] = s * w;
+			sum += h[k];
+		}
+
+		/* Normalize every phase to unity DC gain */
+		for (k = 0; k < taps; k++) {
+			row[k] = (int16_t)lrint(h[k] / sum * 32768.0 * 0.999);
+			total += row[k];
+		}
+		/* Put the rounding error on the center tap */
+		row[taps / 2 - 1] += (int16_t)((int32_t)(32768 * 0.999) - total);
+	}
+}
+
+void *swift_audio_resampler_init(void *mem, ssize_t size,
+				 int in_rate, int out_rate,
+				 swift_audio_resample_quality_t quality, int channels)
+{
+	struct resampler *rs = mem;
+	ssize_t needed = swift_audio_resampler_size(quality, channels);
+	uint8_t *p;
+	int ch;
+
+	if (mem == NULL || needed < 0 || size < needed || in_rate <= 0 || out_rate <= 0) {
+		return NULL;
+	}
+
+	memset(mem, 0, needed);
+	rs->channels = channels;
+	quality_params(quality, &rs->taps, &rs->phase_bits);
+	rs->step = ((uint64_t)in_rate << 32) / (uint64_t)out_rate;
+
+	p = (uint8_t *)mem + align4(sizeof(struct resampler));
+	if (rs->phase_bits > 0) {
+		double cutoff = out_rate < in_rate ? (double)out_rate / in_rate : 1.0;
+
+		rs->coef = (int16_t *)p;
+		/* Leave some transition band below Nyquist */
+		design_filter(rs->coef, rs->taps, 1 << rs->phase_bits, cutoff * 0.9);
+		p += align4(sizeof(int16_t) * rs->taps << rs->phase_bits);
+	}
+	for (ch = 0; ch < channels; ch++) {
+		rs->history[ch] = (int16_t *)p;
+		p += align4(sizeof(int16_t) * 2 * rs->taps);
+	}
+
+	swift_audio_resampler_reset(rs);
+	return rs;
+}
+
+void swift_audio_resampler_reset(void *handle)
+{
+	struct resampler *rs = handle;
+	int ch;
+
+	for (ch = 0; ch < rs->channels; ch++) {
+		memset(rs->history[ch], 0, sizeof(int16_t) * 2 * rs->taps);
+	}
+	rs->head = 0;
+	/*
+	 * Consume taps / 2 + 1 inputs before the first output so the first output
+	 * lines up with the first input and the filter delay is hidden.
+	 */
+	rs->position = RESAMPLE_ONE * (rs->taps / 2 + 1);
+}
+
+static inline int32_t dot_q15(const int16_t *x, const int16_t *c, int taps)
+{
+	int32_t acc = 0;
+	int k = 0;
+
+#if defined(__ARM_FEATURE_DSP)
+	/* SMLAD: two 16x16 multiply-accumulates per instruction */
+	for (; k + 2 <= taps; k += 2) {
+		int32_t xv, cv;
+
+		memcpy(&xv, x + k, sizeof(xv));
+		memcpy(&cv, c + k, sizeof(cv));
+		acc = __smlad(xv, cv, acc);
+	}
+#elif defined(__ARM_NEON)
+	{
+		int32x4_t sum = vdupq_n_s32(0);
+
+		for (; k + 4 <= taps; k += 4) {
+			sum = vmlal_s16(sum, vld1_s16(x + k), vld1_s16(c + k));
+		}
+		acc = vgetq_lane_s32(sum, 0) + vgetq_lane_s32(sum, 1) +
+		      vgetq_lane_s32(sum, 2) + vgetq_lane_s32(sum, 3);
+	}
+#elif defined(__SSE2__)
+	{
+		__m128i sum = _mm_setzero_si128();
+		int32_t lanes[4];
+
+		for (; k + 8 <= taps; k += 8) {
+			__m128i xv = _mm_loadu_si128((const __m128i *)(x + k));
+			__m128i cv = _mm_loadu_si128((const __m128i *)(c + k));
+
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(xv, cv));
+		}
+		_mm_storeu_si128((__m128i *)lanes, sum);
+		acc = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
+#endif
+	for (; k < taps; k++) {
+		acc += (int32_t)x[k] * c[k];
+	}
+	return acc;
+}
+
+int swift_audio_resampler_process(void *handle,
+				  const int16_t *in, ssize_t *in_frames,
+				  int16_t *out, ssize_t *out_frames)
+{
+	struct resampler *rs = handle;
+	const int channels = rs == NULL ? 0 : rs->channels;
+	const int taps = rs == NULL ? 0 : rs->taps;
+	ssize_t consumed = 0;
+	ssize_t produced = 0;
+	int ch;
+
+	if (rs == NULL || in_frames == NULL || out_frames == NULL ||
+	    *in_frames < 0 || *out_frames < 0) {
+		return -EINVAL;
+	}
+
+	while (produced < *out_frames) {
+		uint32_t frac;
+
+		/* Slide the window forward until the output point is inside it */
+		while (rs->position >= RESAMPLE_ONE) {
+			if (consumed == *in_frames) {
+				goto done;
+			}
+			for (ch = 0; ch < channels; ch++) {
+				int16_t v = in[consumed * channels + ch];
+
+				rs->history[ch][rs->head] = v;
+				rs->history[ch][rs->head + taps] = v;
+			}
+			rs->head = rs->head + 1 == taps ? 0 : rs->head + 1;
+			consumed++;
+			rs->position -= RESAMPLE_ONE;
+		}
+
+		frac = (uint32_t)rs->position;
+		for (ch = 0; ch < channels; ch++) {
+			/* Oldest to newest taps samples */
+			const int16_t *window = rs->history[ch] + rs->head;
+			int32_t y;
+
+			if (rs->coef == NULL) {
+				int32_t a = window[0];
+				int32_t b = window[1];
+
+				y = a + (int32_t)(((int64_t)(b - a) * frac) >> 32);
+			} else {
+				const int16_t *row = rs->coef + (frac >> (32 - rs->phase_bits)) * taps;
+
+				y = sat16((dot_q15(window, row, taps) + 0x4000) >> 15);
+			}
+			out[produced * channels + ch] = (int16_t)y;
+		}
+
+		produced++;
+		rs->position += rs->step;
+	}
+
+done:
+	*in_frames = consumed;
+	*out_frames = produced;
+	return 0;
+}
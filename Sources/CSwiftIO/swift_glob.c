@@ -0,0 +1,107 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+
+#include "swift_glob.h"
+
+/* Match one character against a [...] set, return the pattern after it */
+static const char *match_set(const char *p, char c, int *matched)
+{
+	int negate = 0;
+	int found = 0;
+
+	if (*p == '!') {
+		negate = 1;
+		p++;
+	}
+
+	/* A ']' right after the bracket is a member */
+	do {
+		if (*p == '\0') {
+			/* Unterminated set never matches */
+			*matched = 0;
+			return p;
+		}
+		if (p[1] == '-' && p[2] != ']' && p[2] != '\0') {
+			if (c >= p[0] && c <= p[2]) {
+				found = 1;
+			}
+			p += 3;
+		} else {
+			if (c == *p) {
+				found = 1;
+			}
+			p++;
+		}
+	} while (*p != ']');
+
+	*matched = found != negate;
+	return p + 1;
+}
+
+int swift_glob_match(const char *pattern, const char *name)
+{
+	const char *p = pattern;
+	const char *n = name;
+	/* Where to resume after the last '*' if the rest fails */
+	const char *star_p = NULL;
+	const char *star_n = NULL;
+	int matched;
+
+	while (*n != '\0') {
+		if (*p == '*') {
+			star_p = ++p;
+			star_n = n;
+			continue;
+		}
+		if (*p == '?') {
+			p++;
+			n++;
+			continue;
+		}
+		if (*p == '[') {
+			const char *next = match_set(p + 1, *n, &matched);
+			if (matched) {
+				p = next;
+				n++;
+				continue;
+			}
+		} else if (*p != '\0' && *p == *n) {
+			p++;
+			n++;
+			continue;
+		}
+
+		/* Mismatch, let the last '*' swallow one more character */
+		if (star_p == NULL) {
+			return 0;
+		}
+		p = star_p;
+		n = ++star_n;
+	}
+
+	while (*p == '*') {
+		p++;
+	}
+	return *p == '\0';
+}
+
+int swift_glob_filter(swift_fs_dirent_t *entries, int n, const char *pattern, int flags)
+{
+	int kept = 0;
+
+	for (int i = 0; i < n; i++) {
+		if (((flags & SWIFT_GLOB_KEEP_DIRS) && entries[i].type == SWIFT_FS_DIR_ENTRY_DIR) ||
+		    swift_glob_match(pattern, entries[i].name)) {
+			if (kept != i) {
+				entries[kept] = entries[i];
+			}
+			kept++;
+		}
+	}
+	return kept;
+}
@@ -0,0 +1,235 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "swift_image.h"
+
+#define QOI_OP_INDEX	0x00
+#define QOI_OP_DIFF	0x40
+#define QOI_OP_LUMA	0x80
+#define QOI_OP_RUN	0xC0
+#define QOI_OP_RGB	0xFE
+#define QOI_OP_RGBA	0xFF
+#define QOI_MASK_2	0xC0
+
+#define QOI_HASH(p)	(((p).r * 3 + (p).g * 5 + (p).b * 7 + (p).a * 11) & 63)
+
+static uint32_t read_be32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+int swift_qoi_parse_header(const uint8_t *header, uint32_t *width, uint32_t *height, int *channels)
+{
+	if (memcmp(header, "qoif", 4) != 0) {
+		return -EINVAL;
+	}
+
+	*width = read_be32(header + 4);
+	*height = read_be32(header + 8);
+	*channels = header[12];
+
+	if (*width == 0 || *height == 0 || (*channels != 3 && *channels != 4)) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* Work out which columns of the current image row land in the framebuffer */
+static void qoi_begin_row(swift_qoi_decoder_t *dec)
+{
+	int row = dec->origin_y + (int)dec->y;
+	int start, end;
+
+	dec->visible_start = 0;
+	dec->visible_count = 0;
+
+	if (row < 0 || row >= dec->dst_height || dec->y >= dec->height) {
+		return;
+	}
+
+	start = dec->origin_x < 0 ? -dec->origin_x : 0;
+	end = dec->dst_width - dec->origin_x;
+	if (end > (int)dec->width) {
+		end = (int)dec->width;
+	}
+
+	if (end > start) {
+		dec->visible_start = (uint32_t)start;
+		dec->visible_count = (uint32_t)(end - start);
+	}
+}
+
+int swift_qoi_decoder_init(swift_qoi_decoder_t *dec, uint32_t width, uint32_t height,
+			   void *dst, int dst_pitch, int dst_width, int dst_height,
+			   swift_lcd_pixel_format_t dst_format, int x, int y)
+{
+	switch (dst_format) {
+	case SWIFT_LCD_PIXEL_FORMAT_RGB_565:
+		dec->bpp = 2;
+		break;
+	case SWIFT_LCD_PIXEL_FORMAT_RGB_888:
+		dec->bpp = 3;
+		break;
+	case SWIFT_LCD_PIXEL_FORMAT_ARGB_8888:
+		dec->bpp = 4;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	memset(dec->index, 0, sizeof(dec->index));
+	dec->px.r = 0;
+	dec->px.g = 0;
+	dec->px.b = 0;
+	dec->px.a = 255;
+	dec->run = 0;
+	dec->width = width;
+	dec->height = height;
+	dec->x = 0;
+	dec->y = 0;
+
+	dec->dst = dst;
+	dec->dst_pitch = dst_pitch;
+	dec->dst_width = dst_width;
+	dec->dst_height = dst_height;
+	dec->dst_format = dst_format;
+	dec->origin_x = x;
+	dec->origin_y = y;
+
+	qoi_begin_row(dec);
+
+	return 0;
+}
+
+int swift_qoi_decode_done(const swift_qoi_decoder_t *dec)
+{
+	return dec->y >= dec->height || dec->origin_y + (int)dec->y >= dec->dst_height;
+}
+
+static inline void qoi_store(swift_qoi_decoder_t *dec, uint32_t col, struct swift_qoi_pixel px)
+{
+	int row = dec->origin_y + (int)dec->y;
+	int column = dec->origin_x + (int)(dec->visible_start + col);
+	uint8_t *p = dec->dst + (ptrdiff_t)row * dec->dst_pitch + column * dec->bpp;
+
+	switch (dec->dst_format) {
+	case SWIFT_LCD_PIXEL_FORMAT_RGB_565:
+		*(uint16_t *)p = (uint16_t)(((px.r & 0xF8) << 8) | ((px.g & 0xFC) << 3) | (px.b >> 3));
+		break;
+	case SWIFT_LCD_PIXEL_FORMAT_ARGB_8888:
+		*(uint32_t *)p = 0xFF000000u | ((uint32_t)px.r << 16) | ((uint32_t)px.g << 8) | px.b;
+		break;
+	default:
+		p[0] = px.b;
+		p[1] = px.g;
+		p[2] = px.r;
+		break;
+	}
+}
+
+/* Emit count copies of the current pixel, returns how many were emitted */
+static uint32_t qoi_emit(swift_qoi_decoder_t *dec, uint32_t count)
+{
+	uint32_t emitted = 0;
+
+	while (count > 0 && !swift_qoi_decode_done(dec)) {
+		uint32_t n = dec->width - dec->x;
+		uint32_t i;
+
+		if (n > count) {
+			n = count;
+		}
+
+		if (dec->px.a != 0 && dec->visible_count > 0) {
+			for (i = 0; i < n; i++) {
+				uint32_t col = dec->x + i - dec->visible_start;
+
+				if (col < dec->visible_count) {
+					qoi_store(dec, col, dec->px);
+				}
+			}
+		}
+
+		dec->x += n;
+		count -= n;
+		emitted += n;
+
+		if (dec->x == dec->width) {
+			dec->x = 0;
+			dec->y++;
+			qoi_begin_row(dec);
+		}
+	}
+
+	return emitted;
+}
+
+ssize_t swift_qoi_decode(swift_qoi_decoder_t *dec, const uint8_t *src, ssize_t size)
+{
+	struct swift_qoi_pixel px = dec->px;
+	ssize_t p = 0;
+
+	if (dec->run > 0) {
+		dec->run -= qoi_emit(dec, dec->run);
+	}
+
+	while (p < size && !swift_qoi_decode_done(dec)) {
+		uint8_t b1 = src[p];
+		uint32_t run = 1;
+
+		if (b1 == QOI_OP_RGB) {
+			if (p + 4 > size) {
+				break;
+			}
+			px.r = src[p + 1];
+			px.g = src[p + 2];
+			px.b = src[p + 3];
+			p += 4;
+		} else if (b1 == QOI_OP_RGBA) {
+			if (p + 5 > size) {
+				break;
+			}
+			px.r = src[p + 1];
+			px.g = src[p + 2];
+			px.b = src[p + 3];
+			px.a = src[p + 4];
+			p += 5;
+		} else if ((b1 & QOI_MASK_2) == QOI_OP_INDEX) {
+			px = dec->index[b1];
+			p += 1;
+		} else if ((b1 & QOI_MASK_2) == QOI_OP_DIFF) {
+			px.r += ((b1 >> 4) & 0x03) - 2;
+			px.g += ((b1 >> 2) & 0x03) - 2;
+			px.b += (b1 & 0x03) - 2;
+			p += 1;
+		} else if ((b1 & QOI_MASK_2) == QOI_OP_LUMA) {
+			int vg;
+
+			if (p + 2 > size) {
+				break;
+			}
+			vg = (b1 & 0x3F) - 32;
+			px.r += vg - 8 + ((src[p + 1] >> 4) & 0x0F);
+			px.g += vg;
+			px.b += vg - 8 + (src[p + 1] & 0x0F);
+			p += 2;
+		} else {
+			run = (b1 & 0x3F) + 1;
+			p += 1;
+		}
+
+		dec->index[QOI_HASH(px)] = px;
+		dec->px = px;
+		dec->run = run - qoi_emit(dec, run);
+	}
+
+	return p;
+}
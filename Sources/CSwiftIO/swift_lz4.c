@@ -0,0 +1,233 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "swift_lz4.h"
+
+#define MIN_MATCH	4
+/* The last match must start this far from the end of the block */
+#define MF_LIMIT	12
+/* The last bytes of a block are always literals */
+#define LAST_LITERALS	5
+#define MAX_OFFSET	65535
+#define ML_MASK		15
+#define RUN_MASK	15
+
+static inline uint32_t read32(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32_t hash4(uint32_t v)
+{
+	return (v * 2654435761U) >> (32 - SWIFT_LZ4_HASH_BITS);
+}
+
+/* Write the 255-run tail of a length, return the new output position */
+static uint8_t *write_length(uint8_t *op, int len)
+{
+	while (len >= 255) {
+		*op++ = 255;
+		len -= 255;
+	}
+	*op++ = (uint8_t)len;
+	return op;
+}
+
+/* Emit literals and an optional match, NULL if the output is too small */
+static uint8_t *emit(uint8_t *op, const uint8_t *op_end,
+		     const uint8_t *literals, int lit_len, int offset, int match_len)
+{
+	uint8_t *token = op++;
+	int need = 1 + lit_len;
+
+	/* Exact count of the extra length bytes, see write_length */
+	if (lit_len >= RUN_MASK) {
+		need += 1 + (lit_len - RUN_MASK) / 255;
+	}
+	if (offset) {
+		need += 2;
+		if (match_len - MIN_MATCH >= ML_MASK) {
+			need += 1 + (match_len - MIN_MATCH - ML_MASK) / 255;
+		}
+	}
+	if (op_end - token < need) {
+		return NULL;
+	}
+
+	if (lit_len >= RUN_MASK) {
+		*token = RUN_MASK << 4;
+		op = write_length(op, lit_len - RUN_MASK);
+	} else {
+		*token = (uint8_t)(lit_len << 4);
+	}
+	memcpy(op, literals, lit_len);
+	op += lit_len;
+
+	if (offset) {
+		*op++ = (uint8_t)offset;
+		*op++ = (uint8_t)(offset >> 8);
+		match_len -= MIN_MATCH;
+		if (match_len >= ML_MASK) {
+			*token |= ML_MASK;
+			op = write_length(op, match_len - ML_MASK);
+		} else {
+			*token |= (uint8_t)match_len;
+		}
+	}
+	return op;
+}
+
+int swift_lz4_compress(swift_lz4_state_t *state, const uint8_t *src, int src_len,
+		       uint8_t *dst, int dst_cap)
+{
+	const uint8_t *dst_end = dst + dst_cap;
+	uint8_t *op = dst;
+	int anchor = 0;
+	int ip = 0;
+
+	if (src_len < 0 || src_len > SWIFT_LZ4_MAX_BLOCK) {
+		return -EINVAL;
+	}
+
+	if (src_len > MF_LIMIT) {
+		const int limit = src_len - MF_LIMIT;
+		const int match_limit = src_len - LAST_LITERALS;
+		int misses = 0;
+
+		memset(state->table, 0, sizeof(state->table));
+
+		while (ip < limit) {
+			uint32_t seq = read32(src + ip);
+			uint32_t h = hash4(seq);
+			int ref = state->table[h];
+
+			state->table[h] = (uint16_t)ip;
+
+			if (ref >= ip || ip - ref > MAX_OFFSET || read32(src + ref) != seq) {
+				/* Skip faster through data that doesn't compress */
+				ip += 1 + (misses++ >> 5);
+				continue;
+			}
+			misses = 0;
+
+			/* Extend backwards over literals, then forwards */
+			while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+				ip--;
+				ref--;
+			}
+			int len = MIN_MATCH;
+			while (ip + len < match_limit && src[ip + len] == src[ref + len]) {
+				len++;
+			}
+
+			op = emit(op, dst_end, src + anchor, ip - anchor, ip - ref, len);
+			if (op == NULL) {
+				return 0;
+			}
+
+			ip += len;
+			anchor = ip;
+			if (ip - 2 < limit) {
+				state->table[hash4(read32(src + ip - 2))] = (uint16_t)(ip - 2);
+			}
+		}
+	}
+
+	op = emit(op, dst_end, src + anchor, src_len - anchor, 0, 0);
+	if (op == NULL) {
+		return 0;
+	}
+	return (int)(op - dst);
+}
+
+/* Read the 255-run tail of a length, -1 if the input ends */
+static int read_length(const uint8_t **ip, const uint8_t *ip_end)
+{
+	int len = 0;
+	uint8_t b;
+
+	do {
+		if (*ip >= ip_end) {
+			return -1;
+		}
+		b = *(*ip)++;
+		len += b;
+	} while (b == 255);
+	return len;
+}
+
+int swift_lz4_decompress(const uint8_t *src, int src_len, uint8_t *dst, int dst_cap)
+{
+	const uint8_t *ip = src;
+	const uint8_t *ip_end = src + src_len;
+	uint8_t *op = dst;
+	uint8_t *op_end = dst + dst_cap;
+
+	while (ip < ip_end) {
+		uint8_t token = *ip++;
+		int lit_len = token >> 4;
+
+		if (lit_len == RUN_MASK) {
+			int extra = read_length(&ip, ip_end);
+			if (extra < 0) {
+				return -EINVAL;
+			}
+			lit_len += extra;
+		}
+		if (ip_end - ip < lit_len || op_end - op < lit_len) {
+			return -EINVAL;
+		}
+		memcpy(op, ip, lit_len);
+		ip += lit_len;
+		op += lit_len;
+
+		/* The last sequence has literals only */
+		if (ip == ip_end) {
+			break;
+		}
+
+		if (ip_end - ip < 2) {
+			return -EINVAL;
+		}
+		int offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > op - dst) {
+			return -EINVAL;
+		}
+
+		int match_len = token & ML_MASK;
+		if (match_len == ML_MASK) {
+			int extra = read_length(&ip, ip_end);
+			if (extra < 0) {
+				return -EINVAL;
+			}
+			match_len += extra;
+		}
+		match_len += MIN_MATCH;
+		if (op_end - op < match_len) {
+			return -EINVAL;
+		}
+
+		const uint8_t *ref = op - offset;
+		if (offset >= match_len) {
+			memcpy(op, ref, match_len);
+			op += match_len;
+		} else {
+			/* Overlapping copy repeats the last offset bytes */
+			while (match_len-- > 0) {
+				*op++ = *ref++;
+			}
+		}
+	}
+
+	return (int)(op - dst);
+}
@@ -0,0 +1,139 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+#include <stddef.h>
+
+#include "swift_pool.h"
+
+#define TAG_ONE		0x10000u
+#define TAG_MASK	0xFFFF0000u
+#define INDEX_MASK	0x0000FFFFu
+
+/* The link to the next free block lives in the first word of a block */
+static inline uint32_t *link_of(swift_pool_t *pool, uint32_t index)
+{
+	return (uint32_t *)(pool->buf + (index - 1) * pool->block_size);
+}
+
+int swift_pool_init(swift_pool_t *pool, void *buf, uint32_t block_size,
+		    uint32_t block_count)
+{
+	if (buf == NULL || ((uintptr_t)buf & 3) != 0 ||
+	    block_size < 4 || (block_size & 3) != 0 ||
+	    block_count == 0 || block_count > SWIFT_POOL_MAX_BLOCKS) {
+		return -EINVAL;
+	}
+
+	pool->buf = (uint8_t *)buf;
+	pool->block_size = block_size;
+	pool->block_count = block_count;
+	pool->used = 0;
+	pool->high_water = 0;
+	pool->failures = 0;
+
+	for (uint32_t index = 1; index < block_count; index++) {
+		*link_of(pool, index) = index + 1;
+	}
+	*link_of(pool, block_count) = 0;
+	__atomic_store_n(&pool->head, 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+void *swift_pool_alloc(swift_pool_t *pool)
+{
+	uint32_t head = __atomic_load_n(&pool->head, __ATOMIC_ACQUIRE);
+	uint32_t next, used, high;
+	uint32_t *block;
+
+	do {
+		uint32_t index = head & INDEX_MASK;
+
+		if (index == 0) {
+			__atomic_fetch_add(&pool->failures, 1, __ATOMIC_RELAXED);
+			return NULL;
+		}
+		/*
+		 * The block may be taken and written by someone else meanwhile,
+		 * the tag of the head has then changed and the swap fails.
+		 */
+		block = link_of(pool, index);
+		next = ((head + TAG_ONE) & TAG_MASK) |
+		       (__atomic_load_n(block, __ATOMIC_RELAXED) & INDEX_MASK);
+	} while (!__atomic_compare_exchange_n(&pool->head, &head, next, true,
+					      __ATOMIC_ACQUIRE,
+					      __ATOMIC_ACQUIRE));
+
+	used = __atomic_add_fetch(&pool->used, 1, __ATOMIC_RELAXED);
+	high = __atomic_load_n(&pool->high_water, __ATOMIC_RELAXED);
+	while (used > high &&
+	       !__atomic_compare_exchange_n(&pool->high_water, &high, used,
+					    true, __ATOMIC_RELAXED,
+					    __ATOMIC_RELAXED)) {
+	}
+	return block;
+}
+
+int swift_pool_free(swift_pool_t *pool, void *block)
+{
+	uint32_t offset, index, head, next;
+
+	if (!swift_pool_owns(pool, block)) {
+		return -EINVAL;
+	}
+	offset = (uint32_t)((uint8_t *)block - pool->buf);
+	if (offset % pool->block_size != 0) {
+		return -EINVAL;
+	}
+	index = offset / pool->block_size + 1;
+
+	/* Before the block is free again, so used never exceeds block_count */
+	__atomic_fetch_sub(&pool->used, 1, __ATOMIC_RELAXED);
+
+	head = __atomic_load_n(&pool->head, __ATOMIC_RELAXED);
+	do {
+		__atomic_store_n((uint32_t *)block, head & INDEX_MASK,
+				 __ATOMIC_RELAXED);
+		next = ((head + TAG_ONE) & TAG_MASK) | index;
+	} while (!__atomic_compare_exchange_n(&pool->head, &head, next, true,
+					      __ATOMIC_RELEASE,
+					      __ATOMIC_RELAXED));
+	return 0;
+}
+
+bool swift_pool_owns(const swift_pool_t *pool, const void *ptr)
+{
+	const uint8_t *p = (const uint8_t *)ptr;
+
+	return p >= pool->buf &&
+	       p < pool->buf + pool->block_size * pool->block_count;
+}
+
+void *swift_pools_alloc(swift_pool_t *pools, int count, size_t size)
+{
+	for (int i = 0; i < count; i++) {
+		void *block;
+
+		if (pools[i].block_size < size) {
+			continue;
+		}
+		block = swift_pool_alloc(&pools[i]);
+		if (block != NULL) {
+			return block;
+		}
+	}
+	return NULL;
+}
+
+int swift_pools_free(swift_pool_t *pools, int count, void *block)
+{
+	for (int i = 0; i < count; i++) {
+		if (swift_pool_owns(&pools[i], block)) {
+			return swift_pool_free(&pools[i], block);
+		}
+	}
+	return -EINVAL;
+}
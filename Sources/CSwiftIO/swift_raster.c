@@ -0,0 +1,523 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "swift_raster.h"
+
+#if defined(__ARM_ACLE)
+#include <arm_acle.h>
+#endif
+
+/*
+ * The accelerator hooks are optional, a HAL without them links with NULL
+ * addresses and the CPU kernels are used.
+ */
+#if defined(__GNUC__)
+#pragma weak swifthal_lcd_accel_fill
+#pragma weak swifthal_lcd_accel_copy
+#pragma weak swifthal_lcd_accel_blend
+#pragma weak swifthal_lcd_accel_blend_mask
+#define ACCEL_PRESENT(fn)	((fn) != NULL)
+#else
+#define ACCEL_PRESENT(fn)	0
+#endif
+
+/* Word stores into pixel buffers of narrower types */
+typedef uint32_t __attribute__((may_alias)) word_t;
+
+/* Spread an RGB565 pixel as 0b00000gggggg00000rrrrr000000bbbbb for blending */
+#define RGB565_SPREAD_MASK	0x07E0F81Fu
+
+#define ROW(ptr, pitch, y)	((void *)((uint8_t *)(ptr) + (ptrdiff_t)(pitch) * (y)))
+#define CROW(ptr, pitch, y)	((const void *)((const uint8_t *)(ptr) + (ptrdiff_t)(pitch) * (y)))
+
+static inline int use_accel(int w, int h)
+{
+	return w * h >= SWIFT_RASTER_ACCEL_MIN_PIXELS;
+}
+
+static inline uint16_t argb_to_rgb565(uint32_t c)
+{
+	return (uint16_t)(((c >> 8) & 0xF800) | ((c >> 5) & 0x07E0) | ((c >> 3) & 0x001F));
+}
+
+static inline uint32_t rgb565_to_argb(uint32_t p)
+{
+	uint32_t r = (p >> 11) & 0x1F;
+	uint32_t g = (p >> 5) & 0x3F;
+	uint32_t b = p & 0x1F;
+
+	r = (r << 3) | (r >> 2);
+	g = (g << 2) | (g >> 4);
+	b = (b << 3) | (b >> 2);
+
+	return 0xFF000000u | (r << 16) | (g << 8) | b;
+}
+
+static inline uint32_t rgb565_spread(uint32_t p)
+{
+	return (p | (p << 16)) & RGB565_SPREAD_MASK;
+}
+
+static inline uint16_t rgb565_join(uint32_t x)
+{
+	x &= RGB565_SPREAD_MASK;
+	return (uint16_t)(x | (x >> 16));
+}
+
+/* alpha5 in [0, 32] */
+static inline uint16_t blend_rgb565(uint32_t src_spread, uint32_t dst, uint32_t alpha5)
+{
+	uint32_t d = rgb565_spread(dst);
+
+	return rgb565_join((src_spread * alpha5 + d * (32 - alpha5)) >> 5);
+}
+
+/* alpha256 in [0, 256], the alpha byte of dst is kept */
+static inline uint32_t blend_argb(uint32_t src, uint32_t dst, uint32_t alpha256)
+{
+	uint32_t inv = 256 - alpha256;
+	uint32_t rb = ((src & 0x00FF00FFu) * alpha256 + (dst & 0x00FF00FFu) * inv) >> 8;
+	uint32_t g = ((src & 0x0000FF00u) * alpha256 + (dst & 0x0000FF00u) * inv) >> 8;
+
+	return (dst & 0xFF000000u) | (rb & 0x00FF00FFu) | (g & 0x0000FF00u);
+}
+
+int swift_raster_bpp(swift_lcd_pixel_format_t format)
+{
+	switch (format) {
+	case SWIFT_LCD_PIXEL_FORMAT_RGB_565:
+		return 2;
+	case SWIFT_LCD_PIXEL_FORMAT_RGB_888:
+		return 3;
+	case SWIFT_LCD_PIXEL_FORMAT_ARGB_8888:
+		return 4;
+	default:
+		return 1;
+	}
+}
+
+static void fill_row16(uint16_t *p, int w, uint16_t v)
+{
+	uint32_t v2 = v | ((uint32_t)v << 16);
+	word_t *q;
+	int n;
+
+	if (((uintptr_t)p & 2) && w > 0) {
+		*p++ = v;
+		w--;
+	}
+
+	q = (word_t *)p;
+	for (n = w >> 1; n >= 4; n -= 4) {
+		q[0] = v2;
+		q[1] = v2;
+		q[2] = v2;
+		q[3] = v2;
+		q += 4;
+	}
+	while (n-- > 0) {
+		*q++ = v2;
+	}
+
+	if (w & 1) {
+		*(uint16_t *)q = v;
+	}
+}
+
+static void fill_row32(uint32_t *p, int w, uint32_t v)
+{
+	for (; w >= 4; w -= 4) {
+		p[0] = v;
+		p[1] = v;
+		p[2] = v;
+		p[3] = v;
+		p += 4;
+	}
+	while (w-- > 0) {
+		*p++ = v;
+	}
+}
+
+static void fill_row24(uint8_t *p, int w, uint32_t c)
+{
+	uint8_t b = (uint8_t)c, g = (uint8_t)(c >> 8), r = (uint8_t)(c >> 16);
+	uint32_t w0, w1, w2;
+	word_t *q;
+
+	/* Whole pixels until the pointer is word aligned */
+	while (((uintptr_t)p & 3) && w > 0) {
+		p[0] = b;
+		p[1] = g;
+		p[2] = r;
+		p += 3;
+		w--;
+	}
+
+	/* Four pixels are exactly three words */
+	w0 = b | (g << 8) | ((uint32_t)r << 16) | ((uint32_t)b << 24);
+	w1 = g | (r << 8) | ((uint32_t)b << 16) | ((uint32_t)g << 24);
+	w2 = r | (b << 8) | ((uint32_t)g << 16) | ((uint32_t)r << 24);
+
+	q = (word_t *)p;
+	for (; w >= 4; w -= 4) {
+		q[0] = w0;
+		q[1] = w1;
+		q[2] = w2;
+		q += 3;
+	}
+
+	p = (uint8_t *)q;
+	while (w-- > 0) {
+		p[0] = b;
+		p[1] = g;
+		p[2] = r;
+		p += 3;
+	}
+}
+
+void swift_raster_fill(void *dst, int pitch, swift_lcd_pixel_format_t format,
+		       int w, int h, uint32_t color)
+{
+	int y;
+
+	if (w <= 0 || h <= 0) {
+		return;
+	}
+
+	if (use_accel(w, h) && ACCEL_PRESENT(swifthal_lcd_accel_fill) &&
+	    swifthal_lcd_accel_fill(dst, pitch, w, h, format, color) == 0) {
+		return;
+	}
+
+	switch (format) {
+	case SWIFT_LCD_PIXEL_FORMAT_RGB_565: {
+		uint16_t v = argb_to_rgb565(color);
+
+		for (y = 0; y < h; y++) {
+			fill_row16(ROW(dst, pitch, y), w, v);
+		}
+		break;
+	}
+	case SWIFT_LCD_PIXEL_FORMAT_ARGB_8888:
+		for (y = 0; y < h; y++) {
+			fill_row32(ROW(dst, pitch, y), w, color);
+		}
+		break;
+	case SWIFT_LCD_PIXEL_FORMAT_RGB_888:
+		for (y = 0; y < h; y++) {
+			fill_row24(ROW(dst, pitch, y), w, color);
+		}
+		break;
+	default:
+		for (y = 0; y < h; y++) {
+			memset(ROW(dst, pitch, y), (uint8_t)color, w);
+		}
+		break;
+	}
+}
+
+void swift_raster_copy(void *dst, int dst_pitch,
+		       const void *src, int src_pitch,
+		       swift_lcd_pixel_format_t format, int w, int h)
+{
+	size_t row_bytes;
+	int y;
+
+	if (w <= 0 || h <= 0) {
+		return;
+	}
+
+	if (use_accel(w, h) && ACCEL_PRESENT(swifthal_lcd_accel_copy) &&
+	    swifthal_lcd_accel_copy(dst, dst_pitch, format, src, src_pitch, format, w, h) == 0) {
+		return;
+	}
+
+	row_bytes = (size_t)w * swift_raster_bpp(format);
+	if (row_bytes == (size_t)dst_pitch && dst_pitch == src_pitch) {
+		memcpy(dst, src, row_bytes * h);
+		return;
+	}
+
+	for (y = 0; y < h; y++) {
+		memcpy(ROW(dst, dst_pitch, y), CROW(src, src_pitch, y), row_bytes);
+	}
+}
+
+static void convert_row(void *dst, swift_lcd_pixel_format_t dst_format,
+			const void *src, swift_lcd_pixel_format_t src_format, int w)
+{
+	int x;
+
+	if (src_format == SWIFT_LCD_PIXEL_FORMAT_RGB_565) {
+		const uint16_t *s = src;
+
+		if (dst_format == SWIFT_LCD_PIXEL_FORMAT_ARGB_8888) {
+			uint32_t *d = dst;
+
+			for (x = 0; x < w; x++) {
+				d[x] = rgb565_to_argb(s[x]);
+			}
+		} else {
+			uint8_t *d = dst;
+
+			for (x = 0; x < w; x++, d += 3) {
+				uint32_t c = rgb565_to_argb(s[x]);
+
+				d[0] = (uint8_t)c;
+				d[1] = (uint8_t)(c >> 8);
+				d[2] = (uint8_t)(c >> 16);
+			}
+		}
+	} else if (src_format == SWIFT_LCD_PIXEL_FORMAT_ARGB_8888) {
+		const uint32_t *s = src;
+
+		if (dst_format == SWIFT_LCD_PIXEL_FORMAT_RGB_565) {
+			uint16_t *d = dst;
+
+			/* Two pixels per store once the destination is aligned */
+			x = 0;
+			if (((uintptr_t)d & 2) && w > 0) {
+				d[0] = argb_to_rgb565(s[0]);
+				x = 1;
+			}
+			for (; x + 1 < w; x += 2) {
+				*(word_t *)&d[x] = argb_to_rgb565(s[x]) |
+						   ((uint32_t)argb_to_rgb565(s[x + 1]) << 16);
+			}
+			if (x < w) {
+				d[x] = argb_to_rgb565(s[x]);
+			}
+		} else {
+			uint8_t *d = dst;
+
+			for (x = 0; x < w; x++, d += 3) {
+				d[0] = (uint8_t)s[x];
+				d[1] = (uint8_t)(s[x] >> 8);
+				d[2] = (uint8_t)(s[x] >> 16);
+			}
+		}
+	} else {
+		const uint8_t *s = src;
+
+		if (dst_format == SWIFT_LCD_PIXEL_FORMAT_RGB_565) {
+			uint16_t *d = dst;
+
+			for (x = 0; x < w; x++, s += 3) {
+				d[x] = (uint16_t)(((s[2] & 0xF8) << 8) | ((s[1] & 0xFC) << 3) | (s[0] >> 3));
+			}
+		} else {
+			uint32_t *d = dst;
+
+			for (x = 0; x < w; x++, s += 3) {
+				d[x] = 0xFF000000u | ((uint32_t)s[2] << 16) | ((uint32_t)s[1] << 8) | s[0];
+			}
+		}
+	}
+}
+
+int swift_raster_convert(void *dst, int dst_pitch, swift_lcd_pixel_format_t dst_format,
+			 const void *src, int src_pitch, swift_lcd_pixel_format_t src_format,
+			 int w, int h)
+{
+	int y;
+
+	if (dst_format == src_format) {
+		swift_raster_copy(dst, dst_pitch, src, src_pitch, src_format, w, h);
+		return 0;
+	}
+
+	if (dst_format == SWIFT_LCD_PIXEL_FORMAT_RGB_8RAW ||
+	    src_format == SWIFT_LCD_PIXEL_FORMAT_RGB_8RAW) {
+		return -EINVAL;
+	}
+
+	if (w <= 0 || h <= 0) {
+		return 0;
+	}
+
+	if (use_accel(w, h) && ACCEL_PRESENT(swifthal_lcd_accel_copy) &&
+	    swifthal_lcd_accel_copy(dst, dst_pitch, dst_format,
+				    src, src_pitch, src_format, w, h) == 0) {
+		return 0;
+	}
+
+	for (y = 0; y < h; y++) {
+		convert_row(ROW(dst, dst_pitch, y), dst_format,
+			    CROW(src, src_pitch, y), src_format, w);
+	}
+
+	return 0;
+}
+
+void swift_raster_blend_argb8888_rgb565(uint16_t *dst, int dst_pitch,
+					const uint32_t *src, int src_pitch,
+					int w, int h)
+{
+	int x, y;
+
+	if (w <= 0 || h <= 0) {
+		return;
+	}
+
+	if (use_accel(w, h) && ACCEL_PRESENT(swifthal_lcd_accel_blend) &&
+	    swifthal_lcd_accel_blend(dst, dst_pitch, SWIFT_LCD_PIXEL_FORMAT_RGB_565,
+				     src, src_pitch, w, h) == 0) {
+		return;
+	}
+
+	for (y = 0; y < h; y++) {
+		uint16_t *d = ROW(dst, dst_pitch, y);
+		const uint32_t *s = CROW(src, src_pitch, y);
+
+		for (x = 0; x < w; x++) {
+			uint32_t c = s[x];
+			uint32_t a = c >> 24;
+
+			if (a == 0) {
+				continue;
+			}
+			if (a == 0xFF) {
+				d[x] = argb_to_rgb565(c);
+				continue;
+			}
+			d[x] = blend_rgb565(rgb565_spread(argb_to_rgb565(c)), d[x], (a + 4) >> 3);
+		}
+	}
+}
+
+void swift_raster_blend_argb8888(uint32_t *dst, int dst_pitch,
+				 const uint32_t *src, int src_pitch,
+				 int w, int h)
+{
+	int x, y;
+
+	if (w <= 0 || h <= 0) {
+		return;
+	}
+
+	if (use_accel(w, h) && ACCEL_PRESENT(swifthal_lcd_accel_blend) &&
+	    swifthal_lcd_accel_blend(dst, dst_pitch, SWIFT_LCD_PIXEL_FORMAT_ARGB_8888,
+				     src, src_pitch, w, h) == 0) {
+		return;
+	}
+
+	for (y = 0; y < h; y++) {
+		uint32_t *d = ROW(dst, dst_pitch, y);
+		const uint32_t *s = CROW(src, src_pitch, y);
+
+		for (x = 0; x < w; x++) {
+			uint32_t c = s[x];
+			uint32_t a = c >> 24;
+
+			if (a == 0) {
+				continue;
+			}
+			if (a == 0xFF) {
+				d[x] = (d[x] & 0xFF000000u) | (c & 0x00FFFFFFu);
+				continue;
+			}
+			d[x] = blend_argb(c, d[x], a + (a >> 7));
+		}
+	}
+}
+
+int swift_raster_blend_mask(void *dst, int dst_pitch, swift_lcd_pixel_format_t dst_format,
+			    const uint8_t *mask, int mask_pitch, int w, int h,
+			    uint32_t color)
+{
+	uint32_t ca = color >> 24;
+	int x, y;
+
+	if (dst_format != SWIFT_LCD_PIXEL_FORMAT_RGB_565 &&
+	    dst_format != SWIFT_LCD_PIXEL_FORMAT_ARGB_8888) {
+		return -EINVAL;
+	}
+
+	if (w <= 0 || h <= 0 || ca == 0) {
+		return 0;
+	}
+
+	if (use_accel(w, h) && ACCEL_PRESENT(swifthal_lcd_accel_blend_mask) &&
+	    swifthal_lcd_accel_blend_mask(dst, dst_pitch, dst_format,
+					  mask, mask_pitch, w, h, color) == 0) {
+		return 0;
+	}
+
+	/* Scale the mask by the color alpha, 0..255 stays 0..255 */
+	ca += ca >> 7;
+
+	if (dst_format == SWIFT_LCD_PIXEL_FORMAT_RGB_565) {
+		uint16_t solid = argb_to_rgb565(color);
+		uint32_t spread = rgb565_spread(solid);
+
+		for (y = 0; y < h; y++) {
+			uint16_t *d = ROW(dst, dst_pitch, y);
+			const uint8_t *m = CROW(mask, mask_pitch, y);
+
+			for (x = 0; x < w; x++) {
+				uint32_t a = (m[x] * ca) >> 8;
+
+				if (a == 0) {
+					continue;
+				}
+				if (a == 0xFF) {
+					d[x] = solid;
+					continue;
+				}
+				d[x] = blend_rgb565(spread, d[x], (a + 4) >> 3);
+			}
+		}
+	} else {
+		for (y = 0; y < h; y++) {
+			uint32_t *d = ROW(dst, dst_pitch, y);
+			const uint8_t *m = CROW(mask, mask_pitch, y);
+
+			for (x = 0; x < w; x++) {
+				uint32_t a = (m[x] * ca) >> 8;
+
+				if (a == 0) {
+					continue;
+				}
+				d[x] = blend_argb(color, d[x], a + (a >> 7));
+			}
+		}
+	}
+
+	return 0;
+}
+
+void swift_raster_swap16(uint16_t *buf, ssize_t count)
+{
+	word_t *q;
+	ssize_t n;
+
+	if (((uintptr_t)buf & 2) && count > 0) {
+		*buf = (uint16_t)((*buf << 8) | (*buf >> 8));
+		buf++;
+		count--;
+	}
+
+	/* Two pixels per word */
+	q = (word_t *)buf;
+	for (n = count >> 1; n > 0; n--, q++) {
+#if defined(__ARM_ACLE)
+		*q = __rev16(*q);
+#else
+		uint32_t v = *q;
+
+		*q = ((v & 0x00FF00FFu) << 8) | ((v >> 8) & 0x00FF00FFu);
+#endif
+	}
+
+	if (count & 1) {
+		buf = (uint16_t *)q;
+		*buf = (uint16_t)((*buf << 8) | (*buf >> 8));
+	}
+}
@@ -0,0 +1,357 @@
+//=== AsyncFileService.swift ----------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The AsyncFileService class runs file operations on a worker thread, so a
+/// slow SD card never stalls the thread that asked for them.
+///
+/// A write to an SD card usually takes a millisecond, but now and then the
+/// card erases a block or the file system updates its tables and the same
+/// write takes hundreds of milliseconds. The service queues the request
+/// and returns at once. The operation runs later on a worker, then the
+/// request is completed: its completion closure is called on the worker
+/// and anyone waiting on it is woken up.
+///
+/// The requests run one at a time, in the order they were submitted. The
+/// service runs them on a ``WorkerPool`` of its own, or on a pool shared
+/// with other jobs: while it has requests, it then keeps one worker of the
+/// pool busy.
+///
+/// The queue holds at most `depth` requests. When it is full, submitting
+/// waits up to the given timeout for a free slot and throws
+/// `Errno.resourceTemporarilyUnavailable` if none frees up, so a producer
+/// can decide to drop data rather than block.
+///
+/// ```swift
+/// let files = AsyncFileService(depth: 8)
+/// let opening = try files.open("/SD:/log.bin", options: .create)
+/// try opening.wait().get()
+/// let file = opening.file!
+///
+/// while true {
+///     let samples: [UInt8] = readSensor()
+///     try files.write(file, samples, timeout: 0)
+///     sleep(ms: 10)
+/// }
+/// ```
+///
+/// Buffers passed as pointers must stay valid until the request completes.
+/// A file handed to the service should only be used through it.
+public final class AsyncFileService {
+  /// A file operation.
+  public enum Operation {
+    case open(String, FileDescriptor.AccessMode, FileDescriptor.OpenOptions)
+    case close(FileDescriptor)
+    /// Reads at the current offset, or at the offset if it isn't nil.
+    case read(FileDescriptor, UnsafeMutableRawBufferPointer, offset: Int?)
+    /// Writes at the current offset, or at the offset if it isn't nil.
+    case write(FileDescriptor, UnsafeRawBufferPointer, offset: Int?)
+    /// Writes a copy of the bytes owned by the request.
+    case writeBytes(FileDescriptor, [UInt8], offset: Int?)
+    case sync(FileDescriptor)
+  }
+
+  /// A queued file operation and its result.
+  public final class Request {
+    public let operation: Operation
+    private let done = Semaphore(initialCount: 0, maxCount: 1)
+    private let completion: ((Request) -> Void)?
+    fileprivate var submitTime: Int64 = 0
+
+    /// The bytes read or written, nil until the request completes.
+    public fileprivate(set) var result: Result<Int, Errno>? = nil
+    /// The opened file of an `.open` request.
+    public fileprivate(set) var file: FileDescriptor? = nil
+    /// The time in milliseconds from submitting to completion.
+    public fileprivate(set) var latency: Int64 = 0
+
+    init(_ operation: Operation, completion: ((Request) -> Void)?) {
+      self.operation = operation
+      self.completion = completion
+    }
+
+    deinit {
+      done.destroy()
+    }
+
+    /// Whether the operation has run.
+    public var isDone: Bool { result != nil }
+
+    /**
+       Waits for the request to complete.
+       - Parameter timeout: **OPTIONAL** The longest time to wait in
+          milliseconds, forever by default.
+       - Returns: The result of the operation, or
+          `Errno.resourceTemporarilyUnavailable` if it didn't complete in
+          time.
+       */
+    @discardableResult
+    public func wait(_ timeout: Int = Int(SWIFT_FOREVER)) -> Result<Int, Errno> {
+      if let result = result {
+        return result
+      }
+      if case .failure = done.take(timeout) {
+        return .failure(Errno.resourceTemporarilyUnavailable)
+      }
+      done.give()
+      return result!
+    }
+
+    fileprivate func complete(_ result: Result<Int, Errno>) {
+      latency = getSystemUptimeInMilliseconds() - submitTime
+      self.result = result
+      completion?(self)
+      done.give()
+    }
+  }
+
+  /// Statistics of the service.
+  public typealias Statistics = QueueStatistics
+
+  private let queue: BoundedQueue<Request>
+  private let lock = Mutex()
+  private let pool: WorkerPool
+  private let priority: WorkerPool.Priority
+  /// Whether a job of the pool is running the queued requests.
+  private var isDraining = false
+
+  /// The most requests the queue holds.
+  public let depth: Int
+  /// The statistics since creation or the last reset. They are copied
+  /// under the lock, so no field is read halfway through an update.
+  public var statistics: Statistics {
+    lock.lock()
+    defer { lock.unlock() }
+    return queue.statistics
+  }
+
+  /**
+     Creates the service with a worker thread of its own.
+
+     - Parameter depth: **OPTIONAL** The most requests waiting at once,
+        16 by default.
+     - Parameter priority: **OPTIONAL** The priority of the service thread.
+        It should be lower than control loops and higher than idle work,
+        10 by default.
+     - Parameter stackSize: **OPTIONAL** The stack size of the service
+        thread in bytes, 2048 by default.
+     */
+  public convenience init(depth: Int = 16, priority: Int = 10, stackSize: Int = 2048) {
+    self.init(
+      pool: WorkerPool(workerCount: 1, depth: 1, priority: priority, stackSize: stackSize),
+      depth: depth)
+  }
+
+  /**
+     Creates the service on a worker pool.
+
+     - Parameter pool: **REQUIRED** The pool that runs the requests. Its
+        workers need a stack large enough for the file system.
+     - Parameter priority: **OPTIONAL** The queue of the pool to use,
+        `.normal` by default.
+     - Parameter depth: **OPTIONAL** The most requests waiting at once,
+        16 by default.
+     */
+  public init(pool: WorkerPool, priority: WorkerPool.Priority = .normal, depth: Int = 16) {
+    guard depth > 0 else {
+      print("error: AsyncFileService depth must > 0")
+      fatalError()
+    }
+
+    self.depth = depth
+    self.pool = pool
+    self.priority = priority
+    queue = BoundedQueue(depth: depth)
+  }
+
+  /// The count of requests waiting in the queue.
+  public var pendingCount: Int {
+    lock.lock()
+    defer { lock.unlock() }
+    return queue.count
+  }
+
+  /**
+     Queues an operation.
+
+     - Parameter operation: **REQUIRED** The operation to run.
+     - Parameter timeout: **OPTIONAL** The longest time in milliseconds to
+        wait for a free slot when the queue is full, forever by default. If
+        the service is idle, it may wait as long again for a slot in the
+        queue of the pool.
+     - Parameter completion: **OPTIONAL** Called on the worker when the
+        operation has run. Keep it short, the next request waits for it.
+     - Returns: The request, to wait on or check later.
+     */
+  @discardableResult
+  public func submit(
+    _ operation: Operation,
+    timeout: Int = Int(SWIFT_FOREVER),
+    completion: ((Request) -> Void)? = nil
+  ) throws(Errno) -> Request {
+    let request = Request(operation, completion: completion)
+
+    guard queue.reserve(timeout) else {
+      lock.lock()
+      queue.statistics.rejected += 1
+      lock.unlock()
+      throw Errno.resourceTemporarilyUnavailable
+    }
+
+    lock.lock()
+    defer { lock.unlock() }
+
+    // Only one job runs the requests, so they stay in order. The queue of
+    // the service is empty when none runs, and the job waits for the lock
+    // before taking a request.
+    if !isDraining {
+      do throws(Errno) {
+        try pool.submit(priority, timeout: timeout) { [self] in
+          drain()
+        }
+      } catch {
+        queue.cancelReservation()
+        queue.statistics.rejected += 1
+        throw error
+      }
+      isDraining = true
+    }
+
+    request.submitTime = getSystemUptimeInMilliseconds()
+    queue.push(request)
+    return request
+  }
+
+  /// Queues opening a file, the file is in ``Request/file`` once done.
+  @discardableResult
+  public func open(
+    _ path: String,
+    _ mode: FileDescriptor.AccessMode = .readWrite,
+    options: FileDescriptor.OpenOptions = FileDescriptor.OpenOptions(),
+    timeout: Int = Int(SWIFT_FOREVER),
+    completion: ((Request) -> Void)? = nil
+  ) throws(Errno) -> Request {
+    try submit(.open(path, mode, options), timeout: timeout, completion: completion)
+  }
+
+  /// Queues writing a copy of the bytes.
+  @discardableResult
+  public func write(
+    _ file: FileDescriptor,
+    _ data: [UInt8],
+    offset: Int? = nil,
+    timeout: Int = Int(SWIFT_FOREVER),
+    completion: ((Request) -> Void)? = nil
+  ) throws(Errno) -> Request {
+    try submit(.writeBytes(file, data, offset: offset), timeout: timeout, completion: completion)
+  }
+
+  /// Queues reading into a buffer that stays valid until completion.
+  @discardableResult
+  public func read(
+    _ file: FileDescriptor,
+    into buffer: UnsafeMutableRawBufferPointer,
+    offset: Int? = nil,
+    timeout: Int = Int(SWIFT_FOREVER),
+    completion: ((Request) -> Void)? = nil
+  ) throws(Errno) -> Request {
+    try submit(.read(file, buffer, offset: offset), timeout: timeout, completion: completion)
+  }
+
+  /// Queues flushing the cached writes of a file.
+  @discardableResult
+  public func sync(
+    _ file: FileDescriptor,
+    timeout: Int = Int(SWIFT_FOREVER),
+    completion: ((Request) -> Void)? = nil
+  ) throws(Errno) -> Request {
+    try submit(.sync(file), timeout: timeout, completion: completion)
+  }
+
+  /// Queues closing a file.
+  @discardableResult
+  public func close(
+    _ file: FileDescriptor,
+    timeout: Int = Int(SWIFT_FOREVER),
+    completion: ((Request) -> Void)? = nil
+  ) throws(Errno) -> Request {
+    try submit(.close(file), timeout: timeout, completion: completion)
+  }
+
+  /// Clears the statistics.
+  public func resetStatistics() {
+    lock.lock()
+    queue.statistics = Statistics()
+    lock.unlock()
+  }
+
+  /// Runs the queued requests until none is left, on a worker of the pool.
+  private func drain() {
+    while true {
+      lock.lock()
+      guard let request = queue.pop() else {
+        isDraining = false
+        lock.unlock()
+        return
+      }
+      lock.unlock()
+
+      let start = getSystemUptimeInMilliseconds()
+      let result = perform(request)
+      let serviceTime = getSystemUptimeInMilliseconds() - start
+
+      request.complete(result)
+
+      var failed = false
+      if case .failure = result {
+        failed = true
+      }
+      lock.lock()
+      queue.didComplete(latency: request.latency, serviceTime: serviceTime, failed: failed)
+      lock.unlock()
+    }
+  }
+
+  private func perform(_ request: Request) -> Result<Int, Errno> {
+    do throws(Errno) {
+      switch request.operation {
+      case .open(let path, let mode, let options):
+        request.file = try FileDescriptor.open(path, mode, options: options)
+        return .success(0)
+      case .close(let file):
+        try file.close()
+        return .success(0)
+      case .read(let file, let buffer, let offset):
+        if let offset = offset {
+          return .success(try file.read(fromAbsoluteOffest: offset, into: buffer))
+        }
+        return .success(try file.read(into: buffer))
+      case .write(let file, let data, let offset):
+        if let offset = offset {
+          return .success(try file.write(toAbsoluteOffset: offset, data))
+        }
+        return .success(try file.write(data))
+      case .writeBytes(let file, let data, let offset):
+        if let offset = offset {
+          return .success(try file.write(toAbsoluteOffset: offset, data))
+        }
+        return .success(try file.write(data))
+      case .sync(let file):
+        try file.sync()
+        return .success(0)
+      }
+    } catch {
+      return .failure(error)
+    }
+  }
+}
@@ -0,0 +1,357 @@
+//=== AudioDecoder.swift --------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The AudioDecoder class streams compressed audio from a file and decodes
+/// it into 16-bit samples block by block.
+///
+/// It supports WAV files with 16-bit PCM, IMA-ADPCM (format 0x11),
+/// G.711 µ-law and A-law data. IMA-ADPCM takes 1/4 of the space of 16-bit
+/// PCM and G.711 takes 1/2, so less data needs to be read from the SD card.
+///
+/// The decoded samples are written into the buffer you provide, which can
+/// then be sent with ``I2S/write(_:channels:gain:)``:
+///
+/// ```swift
+/// let file = try FileDescriptor.open("/SD:/voice.wav", .readOnly)
+/// let decoder = try AudioDecoder(file)
+/// let i2s = I2S(Id.I2S0, rate: decoder.sampleRate, bits: 16)
+///
+/// let buffer = UnsafeMutableBufferPointer<Int16>.allocate(capacity: 1024)
+/// while true {
+///     let count = try decoder.read(into: buffer)
+///     if count == 0 { break }
+///     i2s.write(UnsafeBufferPointer(rebasing: buffer[0..<count]), channels: decoder.channels)
+/// }
+/// ```
+///
+/// It can also be added to an ``AudioMixer`` with
+/// ``AudioMixer/addSource(decoder:gain:pan:)``.
+public final class AudioDecoder {
+  private let file: FileDescriptor
+  private let dataStart: Int
+  private let dataSize: Int
+  private var dataRemaining: Int
+
+  /// Compressed block read from the file, used by IMA-ADPCM.
+  private var blockBuffer: UnsafeMutableRawBufferPointer?
+  /// Decoded samples that didn't fit in the caller's buffer.
+  private var pcmBuffer: UnsafeMutableBufferPointer<Int16>?
+  private var pcmPosition = 0
+  private var pcmCount = 0
+
+  /// The encoding of the audio data.
+  public let format: Format
+  /// The sample rate of the audio.
+  public let sampleRate: Int
+  /// The number of channels, 1 or 2.
+  public let channels: Int
+  /// The size in bytes of an encoded block. Only IMA-ADPCM uses blocks.
+  public let blockSize: Int
+
+  /// The count of frames decoded so far.
+  public private(set) var decodedFrames = 0
+  /// The total time in nanoseconds spent decoding, file reads excluded.
+  ///
+  /// Divide it by the seconds of audio decoded
+  /// (``decodedFrames`` / ``sampleRate``) to get the decode cost of
+  /// one second of audio.
+  public private(set) var decodeTime: Int64 = 0
+
+  /**
+     Opens a WAV file for decoding.
+
+     The file offset is moved to the start of the audio data.
+     - Parameter file: **REQUIRED** A WAV file opened for reading.
+     */
+  public convenience init(_ file: FileDescriptor) throws(Errno) {
+    var riff = [UInt8](repeating: 0, count: 12)
+    try file.seek(offset: 0)
+    guard try file.read(into: &riff) == 12,
+      AudioDecoder.readUInt32(riff, 0) == AudioDecoder.riffID,
+      AudioDecoder.readUInt32(riff, 8) == AudioDecoder.waveID
+    else {
+      throw Errno.invalidArgument
+    }
+
+    var chunk = [UInt8](repeating: 0, count: 16)
+    var fmt: (tag: Int, channels: Int, rate: Int, blockAlign: Int, bits: Int)? = nil
+
+    while true {
+      guard try file.read(into: &chunk, count: 8) == 8 else {
+        throw Errno.invalidArgument
+      }
+      let id = AudioDecoder.readUInt32(chunk, 0)
+      let size = AudioDecoder.readUInt32(chunk, 4)
+
+      if id == AudioDecoder.dataID {
+        break
+      }
+
+      if id == AudioDecoder.fmtID {
+        guard size >= 16, try file.read(into: &chunk, count: 16) == 16 else {
+          throw Errno.invalidArgument
+        }
+        fmt = (
+          AudioDecoder.readUInt16(chunk, 0), AudioDecoder.readUInt16(chunk, 2),
+          AudioDecoder.readUInt32(chunk, 4), AudioDecoder.readUInt16(chunk, 12),
+          AudioDecoder.readUInt16(chunk, 14)
+        )
+        // Chunks are padded to an even size.
+        try file.seek(offset: (size - 16) + (size & 1), from: .current)
+      } else {
+        try file.seek(offset: size + (size & 1), from: .current)
+      }
+    }
+
+    guard let fmt = fmt else {
+      throw Errno.invalidArgument
+    }
+
+    let format: Format
+    switch (fmt.tag, fmt.bits) {
+    case (Int(SWIFT_AUDIO_WAV_FORMAT_PCM), 16):
+      format = .pcm16
+    case (Int(SWIFT_AUDIO_WAV_FORMAT_IMA_ADPCM), 4):
+      format = .imaADPCM
+    case (Int(SWIFT_AUDIO_WAV_FORMAT_MULAW), 8):
+      format = .muLaw
+    case (Int(SWIFT_AUDIO_WAV_FORMAT_ALAW), 8):
+      format = .aLaw
+    default:
+      throw Errno.notSupported
+    }
+
+    let dataStart = try file.tell()
+    let dataSize = AudioDecoder.readUInt32(chunk, 4)
+
+    try self.init(
+      file, format: format, sampleRate: fmt.rate, channels: fmt.channels,
+      blockSize: fmt.blockAlign, dataStart: dataStart, dataSize: dataSize)
+  }
+
+  /**
+     Decodes headerless audio data in a file.
+
+     - Parameter file: **REQUIRED** A file opened for reading.
+     - Parameter format: **REQUIRED** The encoding of the data.
+     - Parameter sampleRate: **REQUIRED** The sample rate of the audio.
+     - Parameter channels: **OPTIONAL** The number of channels, 1 or 2.
+     - Parameter blockSize: **OPTIONAL** The size of an IMA-ADPCM block in
+        bytes. It's ignored by the other formats.
+     - Parameter offset: **OPTIONAL** The file offset where the data starts.
+     - Parameter size: **OPTIONAL** The size of the data in bytes. If nil,
+        the data lasts to the end of the file.
+     */
+  public convenience init(
+    _ file: FileDescriptor,
+    format: Format,
+    sampleRate: Int,
+    channels: Int = 1,
+    blockSize: Int = 256,
+    offset: Int = 0,
+    size: Int? = nil
+  ) throws(Errno) {
+    try file.seek(offset: 0, from: .end)
+    let end = try file.tell()
+    try file.seek(offset: offset)
+
+    try self.init(
+      file, format: format, sampleRate: sampleRate, channels: channels,
+      blockSize: blockSize, dataStart: offset, dataSize: size ?? (end - offset))
+  }
+
+  private init(
+    _ file: FileDescriptor, format: Format, sampleRate: Int, channels: Int,
+    blockSize: Int, dataStart: Int, dataSize: Int
+  ) throws(Errno) {
+    guard channels == 1 || channels == 2, sampleRate > 0, dataSize >= 0 else {
+      throw Errno.invalidArgument
+    }
+
+    self.file = file
+    self.format = format
+    self.sampleRate = sampleRate
+    self.channels = channels
+    self.dataStart = dataStart
+    self.dataSize = dataSize
+    self.dataRemaining = dataSize
+
+    if format == .imaADPCM {
+      let frames = swift_audio_ima_block_frames(blockSize, Int32(channels))
+      guard frames > 0 else {
+        throw Errno.invalidArgument
+      }
+      self.blockSize = blockSize
+      blockBuffer = UnsafeMutableRawBufferPointer.allocate(byteCount: blockSize, alignment: 4)
+      pcmBuffer = UnsafeMutableBufferPointer<Int16>.allocate(capacity: frames * channels)
+    } else {
+      self.blockSize = 0
+    }
+  }
+
+  deinit {
+    blockBuffer?.deallocate()
+    pcmBuffer?.deallocate()
+  }
+
+  /// Whether all the audio data has been decoded.
+  public var isAtEnd: Bool {
+    dataRemaining == 0 && pcmPosition == pcmCount
+  }
+
+  /**
+     Decodes samples into a buffer.
+
+     The samples are interleaved if the audio is stereo, and the count is
+     always a multiple of ``channels``.
+     - Parameter buffer: **REQUIRED** The buffer to store the samples.
+     - Returns: The count of samples decoded, 0 at the end of the audio.
+     */
+  @discardableResult
+  public func read(into buffer: UnsafeMutableBufferPointer<Int16>) throws(Errno) -> Int {
+    let capacity = buffer.count - buffer.count % channels
+    guard let base = buffer.baseAddress, capacity > 0 else {
+      return 0
+    }
+
+    var written = drainPending(into: base, capacity: capacity)
+
+    while written < capacity && dataRemaining > 0 {
+      let output = base + written
+      let space = capacity - written
+      let count: Int
+
+      switch format {
+      case .pcm16:
+        let bytes = min(space * 2, dataRemaining)
+        let read = try file.read(into: UnsafeMutableRawBufferPointer(start: output, count: bytes))
+        count = read / 2
+        dataRemaining -= read
+        if read < bytes {
+          dataRemaining = 0
+        }
+      case .muLaw, .aLaw:
+        // Read the bytes into the upper half and expand them in place.
+        let bytes = min(space, dataRemaining)
+        let source = UnsafeMutableRawPointer(output) + bytes
+        let read = try file.read(into: UnsafeMutableRawBufferPointer(start: source, count: bytes))
+        let start = getClockCycle()
+        if format == .muLaw {
+          swift_audio_ulaw_decode(output, source.assumingMemoryBound(to: UInt8.self), read)
+        } else {
+          swift_audio_alaw_decode(output, source.assumingMemoryBound(to: UInt8.self), read)
+        }
+        decodeTime += cyclesToNanoseconds(start: start, stop: getClockCycle())
+        count = read
+        dataRemaining -= read
+        if read < bytes {
+          dataRemaining = 0
+        }
+      case .imaADPCM:
+        count = try decodeBlock(into: output, capacity: space)
+      }
+
+      if count == 0 {
+        break
+      }
+      written += count
+    }
+
+    let frames = written / channels
+    decodedFrames += frames
+    return frames * channels
+  }
+
+  /**
+     Restarts decoding from the beginning of the audio data.
+     */
+  public func rewind() throws(Errno) {
+    try file.seek(offset: dataStart)
+    dataRemaining = dataSize
+    pcmPosition = 0
+    pcmCount = 0
+  }
+
+  private func drainPending(into base: UnsafeMutablePointer<Int16>, capacity: Int) -> Int {
+    guard let pcm = pcmBuffer, pcmPosition < pcmCount else {
+      return 0
+    }
+    let count = min(capacity, pcmCount - pcmPosition)
+    base.update(from: pcm.baseAddress! + pcmPosition, count: count)
+    pcmPosition += count
+    return count
+  }
+
+  /// Decodes one IMA-ADPCM block, directly into the output if it fits.
+  private func decodeBlock(into output: UnsafeMutablePointer<Int16>, capacity: Int) throws(Errno)
+    -> Int
+  {
+    let block = blockBuffer!
+    let pcm = pcmBuffer!
+    let bytes = min(blockSize, dataRemaining)
+    let read = try file.read(into: block, count: bytes)
+
+    dataRemaining = read < bytes ? 0 : dataRemaining - read
+
+    let samples = swift_audio_ima_block_frames(read, Int32(channels)) * channels
+    guard samples > 0 else {
+      return 0
+    }
+    let direct = samples <= capacity
+    let start = getClockCycle()
+    let frames = swift_audio_ima_decode_block(
+      direct ? output : pcm.baseAddress!, block.baseAddress!.assumingMemoryBound(to: UInt8.self),
+      read, Int32(channels))
+    decodeTime += cyclesToNanoseconds(start: start, stop: getClockCycle())
+
+    guard frames > 0 else {
+      return 0
+    }
+    if direct {
+      return frames * channels
+    }
+
+    pcmPosition = 0
+    pcmCount = frames * channels
+    return drainPending(into: output, capacity: capacity)
+  }
+
+  // Little-endian chunk ids: "RIFF", "WAVE", "fmt " and "data".
+  private static let riffID = 0x4646_4952
+  private static let waveID = 0x4556_4157
+  private static let fmtID = 0x2074_6D66
+  private static let dataID = 0x6174_6164
+
+  private static func readUInt16(_ bytes: [UInt8], _ offset: Int) -> Int {
+    Int(bytes[offset]) | Int(bytes[offset + 1]) << 8
+  }
+
+  private static func readUInt32(_ bytes: [UInt8], _ offset: Int) -> Int {
+    readUInt16(bytes, offset) | readUInt16(bytes, offset + 2) << 16
+  }
+}
+
+extension AudioDecoder {
+  /// The encoding of the audio data.
+  public enum Format {
+    /// Signed 16-bit little-endian PCM.
+    case pcm16
+    /// IMA-ADPCM as stored in WAV files (format 0x11), 4 bits per sample.
+    case imaADPCM
+    /// G.711 µ-law, 8 bits per sample.
+    case muLaw
+    /// G.711 A-law, 8 bits per sample.
+    case aLaw
+  }
+}
@@ -0,0 +1,466 @@
+//=== AudioMixer.swift ----------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The AudioMixer class mixes several audio sources into one stereo stream
+/// and sends it to an ``I2S`` interface block by block.
+///
+/// Each source has its own gain and pan. The mixing is done in 16-bit fixed
+/// point with saturation, so loud sources are clipped instead of wrapping
+/// around. The mixer works on a fixed-size block that is allocated once, so
+/// no memory is allocated while audio is playing.
+///
+/// ```swift
+/// let i2s = I2S(Id.I2S0, rate: 16_000, bits: 16)
+/// let mixer = AudioMixer(i2s)
+///
+/// // Background music stored as raw 16-bit mono PCM on the SD card.
+/// let music = try FileDescriptor.open("/SD:/music.pcm", .readOnly)
+/// mixer.addSource(file: music, channels: 1, gain: 0.6)
+///
+/// // Mix and play in a dedicated thread.
+/// mixer.start(priority: 2, stackSize: 4 * 1024)
+///
+/// // Play a short beep on the right side over the music.
+/// let beep = mixer.addTone(frequency: 1000, gain: 0.3, pan: 1.0)
+/// sleep(ms: 100)
+/// mixer.removeSource(beep)
+/// ```
+public final class AudioMixer {
+  /// A closure that fills the buffer with interleaved 16-bit samples and
+  /// returns the count of samples written. Returning fewer samples than the
+  /// buffer holds means the source has ended and it is removed from the mixer.
+  ///
+  /// The closure is called from the mixing thread, so it should finish well
+  /// within the duration of a block.
+  public typealias Source = (UnsafeMutableBufferPointer<Int16>) -> Int
+
+  private final class Track {
+    let id: Int
+    let channels: Int
+    let source: Source
+    var gainLeft: Int16 = 0
+    var gainRight: Int16 = 0
+    var gain: Float
+    var pan: Float
+    var finished = false
+
+    init(id: Int, channels: Int, gain: Float, pan: Float, source: @escaping Source) {
+      self.id = id
+      self.channels = channels
+      self.gain = gain
+      self.pan = pan
+      self.source = source
+      updateGain()
+    }
+
+    /// Converts gain and pan to per-channel Q15 gains using a linear
+    /// balance law: the side the sound is panned to stays at full gain.
+    func updateGain() {
+      let gain = min(max(self.gain, 0.0), 1.0)
+      let pan = min(max(self.pan, -1.0), 1.0)
+      let left = gain * (pan > 0 ? 1.0 - pan : 1.0)
+      let right = gain * (pan < 0 ? 1.0 + pan : 1.0)
+
+      gainLeft = Int16(left * Float(Int16.max))
+      gainRight = Int16(right * Float(Int16.max))
+    }
+  }
+
+  private let i2s: I2S
+  private let mutex = Mutex()
+  private var tracks: [Track] = []
+  private var nextId = 0
+  /// Whether the mixing thread should go on, read by it under `mutex`.
+  private var running = false
+  /// Serializes ``start(priority:stackSize:)`` and ``stop()``, held while
+  /// waiting for the thread to end.
+  private let threadLock = Mutex()
+  /// Given by the mixing thread when it ends.
+  private let stopped = Semaphore(initialCount: 0, maxCount: 1)
+  private var mixStatistics = Statistics()
+
+  private let mixBuffer: UnsafeMutableBufferPointer<Int16>
+  private let sourceBuffer: UnsafeMutableBufferPointer<Int16>
+
+  /// The count of stereo frames produced by each block.
+  public let blockFrames: Int
+
+  /// The mixing time statistics since the mixer was created or reset.
+  public var statistics: Statistics {
+    mutex.lock()
+    defer { mutex.unlock() }
+    return mixStatistics
+  }
+
+  /// The playback duration of one block in nanoseconds. The average mixing
+  /// time in ``statistics`` should stay well below it.
+  public var blockDuration: Int64 {
+    Int64(blockFrames) * 1_000_000_000 / Int64(i2s.sampleRate)
+  }
+
+  /// Initializes a mixer that sends audio to the specified I2S interface.
+  /// - Parameters:
+  ///   - i2s: **REQUIRED** The I2S interface to play the mixed audio.
+  ///   - blockFrames: **OPTIONAL** The count of stereo frames mixed at a
+  ///   time, 256 by default. A larger block lowers the overhead per sample
+  ///   but adds latency.
+  public init(_ i2s: I2S, blockFrames: Int = 256) {
+    guard blockFrames > 0 else {
+      print("error: AudioMixer blockFrames must > 0")
+      fatalError()
+    }
+
+    self.i2s = i2s
+    self.blockFrames = blockFrames
+    mixBuffer = UnsafeMutableBufferPointer<Int16>.allocate(capacity: blockFrames * 2)
+    sourceBuffer = UnsafeMutableBufferPointer<Int16>.allocate(capacity: blockFrames * 2)
+  }
+
+  deinit {
+    mutex.destroy()
+    threadLock.destroy()
+    stopped.destroy()
+    mixBuffer.deallocate()
+    sourceBuffer.deallocate()
+  }
+
+  /// Adds a source that provides samples through a closure.
+  /// - Parameters:
+  ///   - channels: **OPTIONAL** The number of channels of the samples, 1 or 2.
+  ///   - gain: **OPTIONAL** The volume of the source between 0.0 and 1.0.
+  ///   - pan: **OPTIONAL** The position of the source between -1.0 (left)
+  ///   and 1.0 (right), 0.0 by default which is centered.
+  ///   - source: A closure that fills the buffer with samples.
+  /// - Returns: The id of the source used to change or remove it.
+  @discardableResult
+  public func addSource(
+    channels: Int = 1,
+    gain: Float = 1.0,
+    pan: Float = 0.0,
+    _ source: @escaping Source
+  ) -> Int {
+    guard channels == 1 || channels == 2 else {
+      print("error: AudioMixer source channels must be 1 or 2")
+      fatalError()
+    }
+
+    mutex.lock()
+    let id = nextId
+    nextId += 1
+    tracks.append(Track(id: id, channels: channels, gain: gain, pan: pan, source: source))
+    mutex.unlock()
+
+    return id
+  }
+
+  /// Adds a source that plays samples stored in memory.
+  ///
+  /// The memory is not copied, so it must stay valid until the source ends
+  /// or is removed.
+  /// - Parameters:
+  ///   - buffer: The interleaved 16-bit samples.
+  ///   - channels: **OPTIONAL** The number of channels of the samples, 1 or 2.
+  ///   - loop: **OPTIONAL** Whether to restart from the beginning at the end.
+  ///   - gain: **OPTIONAL** The volume of the source between 0.0 and 1.0.
+  ///   - pan: **OPTIONAL** The position of the source between -1.0 (left)
+  ///   and 1.0 (right).
+  /// - Returns: The id of the source used to change or remove it.
+  @discardableResult
+  public func addSource(
+    buffer: UnsafeBufferPointer<Int16>,
+    channels: Int = 1,
+    loop: Bool = false,
+    gain: Float = 1.0,
+    pan: Float = 0.0
+  ) -> Int {
+    var position = 0
+
+    return addSource(channels: channels, gain: gain, pan: pan) { output in
+      var written = 0
+
+      while written < output.count {
+        if position == buffer.count {
+          guard loop && buffer.count > 0 else { break }
+          position = 0
+        }
+        let count = min(output.count - written, buffer.count - position)
+        (output.baseAddress! + written).update(from: buffer.baseAddress! + position, count: count)
+        written += count
+        position += count
+      }
+      return written
+    }
+  }
+
+  /// Adds a source that streams raw 16-bit little-endian samples from a file,
+  /// starting at the current file offset.
+  /// - Parameters:
+  ///   - file: The opened file.
+  ///   - channels: **OPTIONAL** The number of channels of the samples, 1 or 2.
+  ///   - gain: **OPTIONAL** The volume of the source between 0.0 and 1.0.
+  ///   - pan: **OPTIONAL** The position of the source between -1.0 (left)
+  ///   and 1.0 (right).
+  /// - Returns: The id of the source used to change or remove it.
+  @discardableResult
+  public func addSource(
+    file: FileDescriptor,
+    channels: Int = 1,
+    gain: Float = 1.0,
+    pan: Float = 0.0
+  ) -> Int {
+    addSource(channels: channels, gain: gain, pan: pan) { output in
+      let bytes = (try? file.read(into: UnsafeMutableRawBufferPointer(output))) ?? 0
+      return bytes / MemoryLayout<Int16>.stride
+    }
+  }
+
+  /// Adds a source that plays audio from a decoder until it ends.
+  ///
+  /// The mixer doesn't resample, so the sample rate of the decoder should
+  /// match the I2S interface.
+  /// - Parameters:
+  ///   - decoder: The decoder that provides the samples.
+  ///   - gain: **OPTIONAL** The volume of the source between 0.0 and 1.0.
+  ///   - pan: **OPTIONAL** The position of the source between -1.0 (left)
+  ///   and 1.0 (right).
+  /// - Returns: The id of the source used to change or remove it.
+  @discardableResult
+  public func addSource(
+    decoder: AudioDecoder,
+    gain: Float = 1.0,
+    pan: Float = 0.0
+  ) -> Int {
+    addSource(channels: decoder.channels, gain: gain, pan: pan) { output in
+      (try? decoder.read(into: output)) ?? 0
+    }
+  }
+
+  /// Adds a sine tone that plays until it's removed.
+  /// - Parameters:
+  ///   - frequency: The frequency of the tone in Hz.
+  ///   - amplitude: **OPTIONAL** The peak amplitude between 0.0 and 1.0.
+  ///   - gain: **OPTIONAL** The volume of the source between 0.0 and 1.0.
+  ///   - pan: **OPTIONAL** The position of the source between -1.0 (left)
+  ///   and 1.0 (right).
+  /// - Returns: The id of the source used to change or remove it.
+  @discardableResult
+  public func addTone(
+    frequency: Int,
+    amplitude: Float = 1.0,
+    gain: Float = 1.0,
+    pan: Float = 0.0
+  ) -> Int {
+    let step = UInt32(truncatingIfNeeded: (UInt64(frequency) << 32) / UInt64(i2s.sampleRate))
+    let peak = Int16(min(max(amplitude, 0.0), 1.0) * Float(Int16.max))
+    var phase: UInt32 = 0
+
+    return addSource(channels: 1, gain: gain, pan: pan) { output in
+      swift_audio_tone_s16(output.baseAddress, output.count, &phase, step, peak)
+      return output.count
+    }
+  }
+
+  /// Removes a source from the mixer.
+  /// - Parameter id: The id returned when adding the source.
+  public func removeSource(_ id: Int) {
+    mutex.lock()
+    tracks.removeAll { $0.id == id }
+    mutex.unlock()
+  }
+
+  /// Removes all sources from the mixer.
+  public func removeAllSources() {
+    mutex.lock()
+    tracks.removeAll()
+    mutex.unlock()
+  }
+
+  /// Sets the volume of a source.
+  /// - Parameters:
+  ///   - gain: The volume between 0.0 and 1.0.
+  ///   - id: The id returned when adding the source.
+  public func setGain(_ gain: Float, for id: Int) {
+    mutex.lock()
+    if let track = tracks.first(where: { $0.id == id }) {
+      track.gain = gain
+      track.updateGain()
+    }
+    mutex.unlock()
+  }
+
+  /// Sets the position of a source in the stereo field.
+  /// - Parameters:
+  ///   - pan: The position between -1.0 (left) and 1.0 (right).
+  ///   - id: The id returned when adding the source.
+  public func setPan(_ pan: Float, for id: Int) {
+    mutex.lock()
+    if let track = tracks.first(where: { $0.id == id }) {
+      track.pan = pan
+      track.updateGain()
+    }
+    mutex.unlock()
+  }
+
+  /// Mixes one block from all sources and sends it to the I2S interface.
+  ///
+  /// If you don't use ``start(priority:stackSize:)``, call this method in a
+  /// loop. Silence is sent when there is no source so the audio keeps
+  /// playing without underrun.
+  /// - Returns: The result of the data transmission.
+  @discardableResult
+  public func mixBlock() -> Result<Int, Errno> {
+    let start = getClockCycle()
+
+    mixBuffer.update(repeating: 0)
+
+    // The sources may read a card and take milliseconds, so they run
+    // outside the lock on a snapshot of the tracks. A source removed
+    // meanwhile may still fill this one block.
+    mutex.lock()
+    let active = tracks
+    mutex.unlock()
+
+    var anyFinished = false
+    for track in active {
+      let count = blockFrames * track.channels
+      let filled = track.source(UnsafeMutableBufferPointer(rebasing: sourceBuffer[0..<count]))
+      let frames = min(max(filled, 0), count) / track.channels
+
+      if frames > 0 {
+        mutex.lock()
+        let gainLeft = track.gainLeft
+        let gainRight = track.gainRight
+        mutex.unlock()
+
+        swift_audio_mix_s16(
+          mixBuffer.baseAddress, sourceBuffer.baseAddress, Int32(track.channels),
+          frames, gainLeft, gainRight)
+      }
+      if filled < count {
+        track.finished = true
+        anyFinished = true
+      }
+    }
+
+    if anyFinished {
+      mutex.lock()
+      tracks.removeAll { $0.finished }
+      mutex.unlock()
+    }
+
+    let time = cyclesToNanoseconds(start: start, stop: getClockCycle())
+    mutex.lock()
+    mixStatistics.record(time)
+    mutex.unlock()
+
+    if i2s.sampleBits == 16 {
+      let result = i2s.writeAll(UnsafeRawBufferPointer(mixBuffer)).map { blockFrames * 4 }
+      if case .failure(let err) = result {
+        //print("error: \(self).\(#function) line \(#line) -> " + String(describing: err))
+        let errDescription = err.description
+        print("error: \(self).\(#function) line \(#line) -> " + errDescription)
+      }
+      return result
+    } else {
+      return i2s.write(UnsafeBufferPointer(mixBuffer), channels: 2)
+    }
+  }
+
+  /// Starts a thread that keeps mixing and playing blocks until ``stop()``
+  /// is called.
+  /// - Parameters:
+  ///   - priority: The priority of the mixing thread.
+  ///   - stackSize: The stack size of the mixing thread in bytes.
+  public func start(priority: Int, stackSize: Int) {
+    threadLock.lock()
+    defer { threadLock.unlock() }
+
+    mutex.lock()
+    let wasRunning = running
+    running = true
+    mutex.unlock()
+    guard !wasRunning else { return }
+
+    createThread(
+      name: "audio_mixer",
+      priority: priority,
+      stackSize: stackSize,
+      p1: Unmanaged.passRetained(self).toOpaque()
+    ) { p1, _, _ in
+      let mixer = Unmanaged<AudioMixer>.fromOpaque(p1!).takeUnretainedValue()
+      while mixer.isRunning {
+        mixer.mixBlock()
+      }
+      mixer.stopped.give()
+      Unmanaged<AudioMixer>.fromOpaque(p1!).release()
+    }
+  }
+
+  /// Stops the mixing thread and waits until it has sent the current
+  /// block, so a following ``start(priority:stackSize:)`` never mixes in
+  /// two threads at once. Don't call it from a source.
+  public func stop() {
+    threadLock.lock()
+    defer { threadLock.unlock() }
+
+    mutex.lock()
+    let wasRunning = running
+    running = false
+    mutex.unlock()
+
+    if wasRunning {
+      stopped.take()
+    }
+  }
+
+  /// Clears the mixing time statistics.
+  public func resetStatistics() {
+    mutex.lock()
+    mixStatistics = Statistics()
+    mutex.unlock()
+  }
+
+  private var isRunning: Bool {
+    mutex.lock()
+    defer { mutex.unlock() }
+    return running
+  }
+}
+
+extension AudioMixer {
+  /// The time spent on mixing blocks, in nanoseconds. The time to send the
+  /// block over I2S is not included.
+  public struct Statistics {
+    /// The count of mixed blocks.
+    public private(set) var blockCount = 0
+    /// The mixing time of the latest block.
+    public private(set) var lastMixTime: Int64 = 0
+    /// The longest mixing time of a block.
+    public private(set) var maxMixTime: Int64 = 0
+    /// The mixing time of all blocks.
+    public private(set) var totalMixTime: Int64 = 0
+
+    /// The average mixing time of a block.
+    public var averageMixTime: Int64 {
+      blockCount == 0 ? 0 : totalMixTime / Int64(blockCount)
+    }
+
+    mutating func record(_ time: Int64) {
+      blockCount += 1
+      lastMixTime = time
+      maxMixTime = max(maxMixTime, time)
+      totalMixTime += time
+    }
+  }
+}
@@ -0,0 +1,246 @@
+//=== AudioResampler.swift ------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The AudioResampler class converts 16-bit audio from one sample rate to
+/// another while it's streamed.
+///
+/// Use it to play audio whose sample rate isn't in
+/// ``I2S/supportedSampleRate``, or to mix sources of different rates in an
+/// ``AudioMixer``. It uses a fixed-point polyphase filter that works with
+/// any ratio and keeps its state between blocks, so the audio can be
+/// processed in blocks of any size.
+///
+/// ```swift
+/// let i2s = I2S(Id.I2S0, rate: 16_000, bits: 16)
+/// let resampler = AudioResampler(inputRate: 10_000, outputRate: i2s.sampleRate)
+///
+/// // Resample and play a block of 10 kHz mono samples.
+/// resampler.write(samples, to: i2s)
+/// ```
+public final class AudioResampler {
+  private let memory: UnsafeMutableRawBufferPointer
+  private let handle: UnsafeMutableRawPointer
+
+  private let inputBuffer: UnsafeMutableBufferPointer<Int16>
+  private var inputPosition = 0
+  private var inputCount = 0
+  private let outputBuffer: UnsafeMutableBufferPointer<Int16>
+
+  /// The sample rate of the input audio.
+  public let inputRate: Int
+  /// The sample rate of the output audio.
+  public let outputRate: Int
+  /// The number of interleaved channels, 1 or 2.
+  public let channels: Int
+  /// The quality of the filter.
+  public let quality: Quality
+
+  /// The count of frames produced so far.
+  public private(set) var processedFrames = 0
+  /// The total time in nanoseconds spent resampling.
+  ///
+  /// Divide it by the seconds of audio produced
+  /// (``processedFrames`` / ``outputRate``) to get the CPU cost of one
+  /// second of audio for the chosen ``quality``.
+  public private(set) var processTime: Int64 = 0
+
+  /// Initializes a resampler.
+  /// - Parameters:
+  ///   - inputRate: **REQUIRED** The sample rate of the input audio.
+  ///   - outputRate: **REQUIRED** The sample rate of the output audio.
+  ///   - channels: **OPTIONAL** The number of interleaved channels, 1 or 2.
+  ///   - quality: **OPTIONAL** The quality of the filter, `.medium` by default.
+  ///   - blockFrames: **OPTIONAL** The count of frames in the internal
+  ///   blocks used by ``write(_:to:gain:)`` and ``source(_:)``.
+  public init(
+    inputRate: Int,
+    outputRate: Int,
+    channels: Int = 1,
+    quality: Quality = .medium,
+    blockFrames: Int = 256
+  ) {
+    let size = swift_audio_resampler_size(quality.rawValue, Int32(channels))
+    guard size > 0, inputRate > 0, outputRate > 0, blockFrames > 0 else {
+      print("error: AudioResampler parameters are invalid!")
+      fatalError()
+    }
+
+    self.inputRate = inputRate
+    self.outputRate = outputRate
+    self.channels = channels
+    self.quality = quality
+
+    memory = UnsafeMutableRawBufferPointer.allocate(byteCount: size, alignment: 8)
+    guard
+      let ptr = swift_audio_resampler_init(
+        memory.baseAddress, size, Int32(inputRate), Int32(outputRate),
+        quality.rawValue, Int32(channels))
+    else {
+      print("error: AudioResampler initialization failed!")
+      fatalError()
+    }
+    handle = ptr
+
+    inputBuffer = UnsafeMutableBufferPointer<Int16>.allocate(capacity: blockFrames * channels)
+    outputBuffer = UnsafeMutableBufferPointer<Int16>.allocate(capacity: blockFrames * channels)
+  }
+
+  deinit {
+    memory.deallocate()
+    inputBuffer.deallocate()
+    outputBuffer.deallocate()
+  }
+
+  /// Resamples interleaved samples from the input into the output buffer.
+  ///
+  /// It stops when the input is used up or the output is full. The samples
+  /// left in the input should be passed again in the next call.
+  /// - Parameters:
+  ///   - input: The input samples.
+  ///   - output: The buffer to store the resampled samples.
+  /// - Returns: The count of input samples consumed and output samples
+  /// produced.
+  @discardableResult
+  public func process(
+    _ input: UnsafeBufferPointer<Int16>,
+    into output: UnsafeMutableBufferPointer<Int16>
+  ) -> (consumed: Int, produced: Int) {
+    var inFrames = input.count / channels
+    var outFrames = output.count / channels
+
+    let start = getClockCycle()
+    swift_audio_resampler_process(
+      handle, input.baseAddress, &inFrames, output.baseAddress, &outFrames)
+    processTime += cyclesToNanoseconds(start: start, stop: getClockCycle())
+    processedFrames += outFrames
+
+    return (inFrames * channels, outFrames * channels)
+  }
+
+  /// Clears the filter history and any buffered input so a new stream
+  /// can start.
+  public func reset() {
+    swift_audio_resampler_reset(handle)
+    inputPosition = 0
+    inputCount = 0
+  }
+
+  /// Resamples the samples and sends them to an I2S interface.
+  ///
+  /// The audio is processed in blocks, so no array of the whole resampled
+  /// audio is created.
+  /// - Parameters:
+  ///   - data: The input samples.
+  ///   - i2s: The I2S interface whose sample rate is ``outputRate``.
+  ///   - gain: **OPTIONAL** The volume between 0.0 and 1.0.
+  /// - Returns: The count of input samples that were consumed.
+  @discardableResult
+  public func write(
+    _ data: UnsafeBufferPointer<Int16>,
+    to i2s: I2S,
+    gain: Float = 1.0
+  ) -> Result<Int, Errno> {
+    var consumed = 0
+
+    while consumed < data.count - data.count % channels {
+      let (used, produced) = process(
+        UnsafeBufferPointer(rebasing: data[consumed...]), into: outputBuffer)
+
+      if produced > 0 {
+        let result = i2s.write(
+          UnsafeBufferPointer(rebasing: outputBuffer[0..<produced]),
+          channels: channels, gain: gain)
+        if case .failure(let err) = result {
+          return .failure(err)
+        }
+      }
+      if used == 0 && produced == 0 {
+        break
+      }
+      consumed += used
+    }
+
+    return .success(consumed)
+  }
+
+  /// Wraps a source so it can be added to an ``AudioMixer`` running at
+  /// ``outputRate``.
+  ///
+  /// ```swift
+  /// let resampler = AudioResampler(inputRate: decoder.sampleRate, outputRate: i2s.sampleRate)
+  /// mixer.addSource(channels: decoder.channels, resampler.source { buffer in
+  ///     (try? decoder.read(into: buffer)) ?? 0
+  /// })
+  /// ```
+  /// - Parameter upstream: The source that provides samples at ``inputRate``.
+  /// - Returns: A source that provides the resampled samples.
+  public func source(_ upstream: @escaping AudioMixer.Source) -> AudioMixer.Source {
+    var ended = false
+
+    return { output in
+      var written = 0
+
+      while written < output.count {
+        if self.inputPosition == self.inputCount {
+          guard !ended else { break }
+          self.inputCount = upstream(self.inputBuffer)
+          self.inputPosition = 0
+          if self.inputCount < self.inputBuffer.count {
+            ended = true
+          }
+          if self.inputCount <= 0 {
+            self.inputCount = 0
+            break
+          }
+        }
+
+        let (used, produced) = self.process(
+          UnsafeBufferPointer(
+            rebasing: self.inputBuffer[self.inputPosition..<self.inputCount]),
+          into: UnsafeMutableBufferPointer(rebasing: output[written...]))
+        self.inputPosition += used
+        written += produced
+
+        if used == 0 && produced == 0 {
+          break
+        }
+      }
+      return written
+    }
+  }
+}
+
+extension AudioResampler {
+  /// The quality of the resampling filter. A higher quality needs more CPU
+  /// time per sample.
+  public enum Quality {
+    /// Linear interpolation.
+    case fast
+    /// 8-tap windowed sinc filter.
+    case medium
+    /// 16-tap windowed sinc filter.
+    case high
+
+    var rawValue: swift_audio_resample_quality_t {
+      switch self {
+      case .fast:
+        return SWIFT_AUDIO_RESAMPLE_FAST
+      case .medium:
+        return SWIFT_AUDIO_RESAMPLE_MEDIUM
+      case .high:
+        return SWIFT_AUDIO_RESAMPLE_HIGH
+      }
+    }
+  }
+}
@@ -0,0 +1,106 @@
+//=== BoundedQueue.swift --------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// Statistics of a queue of jobs, such as the requests of an
+/// ``AsyncFileService`` or the jobs of one ``WorkerPool`` priority.
+public struct QueueStatistics {
+  /// The count of jobs run.
+  public var completed = 0
+  /// The count of jobs that ran and failed.
+  public var failed = 0
+  /// The count of submissions refused because the queue stayed full.
+  public var rejected = 0
+  /// The most jobs waiting in the queue at once.
+  public var maxDepth = 0
+  /// The total time in milliseconds from submitting to completion.
+  public var totalLatency: Int64 = 0
+  /// The longest time in milliseconds from submitting to completion.
+  public var maxLatency: Int64 = 0
+  /// The longest time in milliseconds a single job ran.
+  public var maxServiceTime: Int64 = 0
+
+  /// The mean time in milliseconds from submitting to completion.
+  public var averageLatency: Int64 {
+    completed > 0 ? totalLatency / Int64(completed) : 0
+  }
+}
+
+/// A fixed ring of waiting jobs and the statistics of the jobs that went
+/// through it.
+///
+/// A submitter takes a free slot with ``reserve(_:)`` first, outside the
+/// lock of the owner, as it may block. Everything else runs under that
+/// lock.
+final class BoundedQueue<Element> {
+  private var items: [Element?]
+  private var head = 0
+  /// Counts the free slots.
+  private let space: Semaphore
+
+  /// The count of jobs waiting.
+  private(set) var count = 0
+  var statistics = QueueStatistics()
+
+  init(depth: Int) {
+    items = [Element?](repeating: nil, count: depth)
+    space = Semaphore(initialCount: depth, maxCount: depth)
+  }
+
+  deinit {
+    space.destroy()
+  }
+
+  /// Waits up to `timeout` milliseconds for a free slot, the caller then
+  /// pushes a job or gives the slot back with ``cancelReservation()``.
+  func reserve(_ timeout: Int) -> Bool {
+    if case .failure = space.take(timeout) {
+      return false
+    }
+    return true
+  }
+
+  /// Gives back a slot that won't be used.
+  func cancelReservation() {
+    space.give()
+  }
+
+  /// Appends a job into a reserved slot.
+  func push(_ element: Element) {
+    items[(head + count) % items.count] = element
+    count += 1
+    statistics.maxDepth = max(statistics.maxDepth, count)
+  }
+
+  /// Takes the oldest job and frees its slot, nil if the queue is empty.
+  func pop() -> Element? {
+    guard count > 0 else { return nil }
+    let element = items[head]
+    items[head] = nil
+    head = (head + 1) % items.count
+    count -= 1
+    space.give()
+    return element
+  }
+
+  /// Adds a job that has run to the statistics.
+  func didComplete(latency: Int64, serviceTime: Int64, failed: Bool) {
+    statistics.completed += 1
+    if failed {
+      statistics.failed += 1
+    }
+    statistics.totalLatency += latency
+    statistics.maxLatency = max(statistics.maxLatency, latency)
+    statistics.maxServiceTime = max(statistics.maxServiceTime, serviceTime)
+  }
+}
@@ -0,0 +1,264 @@
+//=== BufferedFileReader.swift --------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The BufferedFileReader class reads a file in large, sector-aligned
+/// blocks and hands out lines, records or bytes from its buffer.
+///
+/// Lines and records are returned as views into the internal buffer, so
+/// reading them allocates nothing. A view stays valid until the next call
+/// to the reader; copy the bytes if you need them longer.
+///
+/// ```swift
+/// let file = try FileDescriptor.open("/SD:/config.txt", .readOnly)
+/// let reader = try BufferedFileReader(file)
+///
+/// while let line = try reader.readLine() {
+///     // line doesn't include the line break.
+/// }
+/// ```
+public final class BufferedFileReader {
+  private let file: FileDescriptor
+  private let buffer: UnsafeMutableRawBufferPointer
+  /// The start of the unread bytes in the buffer.
+  private var position = 0
+  /// The end of the valid bytes in the buffer.
+  private var end = 0
+  private var fileOffset: Int
+  private var reachedEnd = false
+
+  /// The size of the buffer in bytes, a multiple of 512. It is also the
+  /// longest line or record that can be read.
+  public let bufferSize: Int
+
+  /// The count of reads issued to the file system.
+  public private(set) var fileReads = 0
+  /// The total time in nanoseconds spent in file system reads.
+  public private(set) var fileReadTime: Int64 = 0
+
+  /**
+     Creates a reader at the current offset of a file.
+
+     - Parameter file: **REQUIRED** A file opened for reading.
+     - Parameter bufferSize: **OPTIONAL** The size of the buffer, rounded up
+        to a multiple of 512. 8192 by default.
+     */
+  public init(_ file: FileDescriptor, bufferSize: Int = 8192) throws(Errno) {
+    guard bufferSize > 0 else {
+      throw Errno.invalidArgument
+    }
+
+    let size = (bufferSize + BufferedFileReader.sectorSize - 1) & ~(BufferedFileReader.sectorSize - 1)
+
+    self.file = file
+    self.bufferSize = size
+    fileOffset = try file.tell()
+    buffer = UnsafeMutableRawBufferPointer.allocate(byteCount: size, alignment: 32)
+  }
+
+  deinit {
+    buffer.deallocate()
+  }
+
+  /// Whether all the bytes of the file have been returned.
+  public var isAtEnd: Bool {
+    reachedEnd && position == end
+  }
+
+  /// The file offset of the next byte to be returned.
+  public var offset: Int {
+    fileOffset - (end - position)
+  }
+
+  /**
+     Reads bytes into a buffer.
+     - Parameter destination: **REQUIRED** The region of memory to read into.
+     - Returns: The bytes read, less than the size of the destination only at
+        the end of the file.
+     */
+  @discardableResult
+  public func read(into destination: UnsafeMutableRawBufferPointer) throws(Errno) -> Int {
+    guard let base = destination.baseAddress else { return 0 }
+    var copied = 0
+
+    while copied < destination.count {
+      if position == end {
+        // Large reads skip the buffer once it is empty. The buffer then no
+        // longer ends at the file offset, so it is dropped.
+        if destination.count - copied >= bufferSize {
+          position = 0
+          end = 0
+          let read = try readFile(
+            into: UnsafeMutableRawBufferPointer(start: base + copied, count: destination.count - copied))
+          copied += read
+          if read == 0 { break }
+          continue
+        }
+        if try fill() == 0 { break }
+      }
+      let chunk = min(destination.count - copied, end - position)
+      (base + copied).copyMemory(from: buffer.baseAddress! + position, byteCount: chunk)
+      position += chunk
+      copied += chunk
+    }
+    return copied
+  }
+
+  /**
+     Reads a line.
+
+     Both `\n` and `\r\n` end a line. A line longer than the buffer is
+     returned in pieces of ``bufferSize`` bytes.
+     - Returns: The bytes of the line without the line break, nil at the end
+        of the file. The view is valid until the next call to the reader.
+     */
+  public func readLine() throws(Errno) -> UnsafeRawBufferPointer? {
+    guard var line = try readRecord(delimiter: 0x0A) else { return nil }
+
+    if line.count > 0 && line[line.count - 1] == 0x0D {
+      line = UnsafeRawBufferPointer(rebasing: line[0..<(line.count - 1)])
+    }
+    return line
+  }
+
+  /**
+     Reads the bytes up to a delimiter.
+     - Parameter delimiter: **REQUIRED** The byte that ends a record.
+     - Returns: The bytes of the record without the delimiter, nil at the
+        end of the file. The view is valid until the next call to the reader.
+     */
+  public func readRecord(delimiter: UInt8) throws(Errno) -> UnsafeRawBufferPointer? {
+    var searched = position
+
+    while true {
+      if let index = find(delimiter, from: searched) {
+        let record = UnsafeRawBufferPointer(start: buffer.baseAddress! + position, count: index - position)
+        position = index + 1
+        return record
+      }
+
+      // Keep the partial record and read more behind it. A full buffer
+      // without a delimiter is returned as a piece.
+      let scanned = end - position
+      var exhausted = scanned == bufferSize
+      if !exhausted {
+        exhausted = try fill() == 0
+      }
+      if exhausted {
+        guard end > position else { return nil }
+        let record = UnsafeRawBufferPointer(start: buffer.baseAddress! + position, count: end - position)
+        position = end
+        return record
+      }
+      searched = position + scanned
+    }
+  }
+
+  /**
+     Reads a record of a fixed size.
+     - Parameter count: **REQUIRED** The size of the record, not larger than
+        ``bufferSize``.
+     - Returns: The bytes of the record, nil if the file ends before a whole
+        record. The view is valid until the next call to the reader.
+     */
+  public func readRecord(count: Int) throws(Errno) -> UnsafeRawBufferPointer? {
+    guard count > 0 && count <= bufferSize else {
+      throw Errno.invalidArgument
+    }
+
+    while end - position < count {
+      if try fill() == 0 {
+        return nil
+      }
+    }
+
+    let record = UnsafeRawBufferPointer(start: buffer.baseAddress! + position, count: count)
+    position += count
+    return record
+  }
+
+  /**
+     Moves to an offset of the file.
+
+     The buffered bytes are reused if the offset is inside the buffer.
+     - Parameter offset: **REQUIRED** The file offset of the next read.
+     */
+  public func seek(to offset: Int) throws(Errno) {
+    if offset >= fileOffset - end && offset <= fileOffset {
+      // Still in the buffer.
+      position = end - (fileOffset - offset)
+      return
+    }
+    try file.seek(offset: offset)
+    fileOffset = offset
+    position = 0
+    end = 0
+    reachedEnd = false
+  }
+
+  /// Clears the statistics.
+  public func resetStatistics() {
+    fileReads = 0
+    fileReadTime = 0
+  }
+
+  private func find(_ byte: UInt8, from start: Int) -> Int? {
+    var index = start
+    while index < end {
+      if buffer[index] == byte {
+        return index
+      }
+      index += 1
+    }
+    return nil
+  }
+
+  /// Moves the unread bytes to the front and reads up to the next aligned
+  /// file offset behind them. Returns the bytes added.
+  private func fill() throws(Errno) -> Int {
+    guard !reachedEnd else { return 0 }
+
+    let pending = end - position
+    if pending > 0 && position > 0 {
+      buffer.baseAddress!.copyMemory(from: buffer.baseAddress! + position, byteCount: pending)
+    }
+    position = 0
+    end = pending
+
+    // Stop at a sector boundary so the next read starts aligned.
+    var space = bufferSize - pending
+    let misalignment = (fileOffset + space) % BufferedFileReader.sectorSize
+    if space > misalignment {
+      space -= misalignment
+    }
+
+    let read = try readFile(
+      into: UnsafeMutableRawBufferPointer(start: buffer.baseAddress! + end, count: space))
+    end += read
+    if read == 0 {
+      reachedEnd = true
+    }
+    return read
+  }
+
+  private func readFile(into destination: UnsafeMutableRawBufferPointer) throws(Errno) -> Int {
+    let start = getClockCycle()
+    let read = try file.read(into: destination)
+    fileReadTime += cyclesToNanoseconds(start: start, stop: getClockCycle())
+    fileReads += 1
+    fileOffset += read
+    return read
+  }
+
+  private static let sectorSize = 512
+}
@@ -0,0 +1,234 @@
+//=== BufferedFileWriter.swift --------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The BufferedFileWriter class collects small writes in RAM and writes
+/// them to the file in large, sector-aligned blocks.
+///
+/// Every `FileDescriptor.write` goes straight to the file system, so
+/// writing many short records makes the SD card rewrite the same sector
+/// again and again. The writer copies records into its buffer and
+/// only calls the file system when the buffer fills up, when you call
+/// ``flush(sync:)``, or when the oldest buffered byte is older than the
+/// flush interval.
+///
+/// Full buffers end on a multiple of the buffer size in the file, so the
+/// card always sees whole sectors. The alignment is worked out from the file
+/// offset when the writer is created, so seek to the end first if the file
+/// is opened for appending.
+///
+/// ```swift
+/// let file = try FileDescriptor.open("/SD:/log.txt", options: .create)
+/// try file.seek(offset: 0, from: .end)
+/// let writer = try BufferedFileWriter(file, bufferSize: 8192, flushInterval: 1000)
+///
+/// while true {
+///     try writer.write("temperature: 25.3\n")
+///     sleep(ms: 10)
+/// }
+/// ```
+public final class BufferedFileWriter {
+  private let file: FileDescriptor
+  private let buffer: UnsafeMutableRawBufferPointer
+  private var count = 0
+  /// The bytes the buffer may hold before the next aligned boundary.
+  private var limit: Int
+  private var fileOffset: Int
+  private var firstPendingTime: Int64 = 0
+
+  /// The size of the buffer in bytes, a multiple of 512.
+  public let bufferSize: Int
+  /// The longest time in milliseconds data stays in the buffer, nil if it
+  /// is only flushed when full or on request.
+  public var flushInterval: Int?
+
+  /// The count of bytes passed to the writer.
+  public private(set) var bytesWritten = 0
+  /// The count of writes issued to the file system.
+  public private(set) var fileWrites = 0
+  /// The total time in nanoseconds spent in file system writes.
+  public private(set) var fileWriteTime: Int64 = 0
+
+  /**
+     Creates a writer at the current offset of a file.
+
+     - Parameter file: **REQUIRED** A file opened for writing.
+     - Parameter bufferSize: **OPTIONAL** The size of the buffer, rounded up
+        to a multiple of 512. 8192 by default, 4096 to 32768 works best for
+        SD cards.
+     - Parameter flushInterval: **OPTIONAL** The longest time in
+        milliseconds data stays in the buffer.
+     */
+  public init(_ file: FileDescriptor, bufferSize: Int = 8192, flushInterval: Int? = nil)
+    throws(Errno)
+  {
+    guard bufferSize > 0 else {
+      throw Errno.invalidArgument
+    }
+
+    let size = (bufferSize + BufferedFileWriter.sectorSize - 1) & ~(BufferedFileWriter.sectorSize - 1)
+
+    self.file = file
+    self.bufferSize = size
+    self.flushInterval = flushInterval
+    fileOffset = try file.tell()
+    limit = size - fileOffset % size
+    buffer = UnsafeMutableRawBufferPointer.allocate(byteCount: size, alignment: 32)
+  }
+
+  deinit {
+    try? flush()
+    buffer.deallocate()
+  }
+
+  /// The count of bytes waiting in the buffer.
+  public var pendingBytes: Int { count }
+
+  /**
+     Writes the contents of a buffer.
+     - Parameter data: **REQUIRED** The bytes to write.
+     */
+  public func write(_ data: UnsafeRawBufferPointer) throws(Errno) {
+    guard var source = data.baseAddress else { return }
+    var remaining = data.count
+
+    bytesWritten += remaining
+
+    // Large writes go straight to the file once the buffer is aligned.
+    if count == 0 && remaining >= bufferSize && limit == bufferSize {
+      let direct = remaining - remaining % bufferSize
+      if try writeFile(UnsafeRawBufferPointer(start: source, count: direct)) < direct {
+        throw Errno.noSpace
+      }
+      source += direct
+      remaining -= direct
+    }
+
+    while remaining > 0 {
+      if count == 0 {
+        firstPendingTime = getSystemUptimeInMilliseconds()
+      }
+      let chunk = min(remaining, limit - count)
+      (buffer.baseAddress! + count).copyMemory(from: source, byteCount: chunk)
+      count += chunk
+      source += chunk
+      remaining -= chunk
+
+      if count == limit {
+        try flushBuffer()
+      }
+    }
+
+    try flushIfExpired()
+  }
+
+  /**
+     Writes an array of bytes.
+     - Parameter data: **REQUIRED** The bytes to write.
+     */
+  public func write(_ data: [UInt8]) throws(Errno) {
+    var result: Result<(), Errno> = .success(())
+    data.withUnsafeBytes { pointer in
+      do throws(Errno) {
+        try write(pointer)
+      } catch {
+        result = .failure(error)
+      }
+    }
+    if case .failure(let err) = result {
+      throw err
+    }
+  }
+
+  /**
+     Writes the UTF-8 contents of a string.
+     - Parameter string: **REQUIRED** The string to write.
+     */
+  public func write(_ string: String) throws(Errno) {
+    var string = string
+    var result: Result<(), Errno> = .success(())
+    string.withUTF8 { pointer in
+      do throws(Errno) {
+        try write(UnsafeRawBufferPointer(pointer))
+      } catch {
+        result = .failure(error)
+      }
+    }
+    if case .failure(let err) = result {
+      throw err
+    }
+  }
+
+  /**
+     Writes the buffered bytes to the file.
+     - Parameter sync: **OPTIONAL** Whether to also flush the cache of the
+        file system to the card, false by default.
+     */
+  public func flush(sync: Bool = false) throws(Errno) {
+    if count > 0 {
+      try flushBuffer()
+    }
+    if sync {
+      try file.sync()
+    }
+  }
+
+  /**
+     Flushes the buffer if the flush interval has passed.
+
+     Writes flush by time on their own. Call this method regularly if the
+     writer may stay idle for longer than the interval.
+     */
+  public func flushIfExpired() throws(Errno) {
+    guard let interval = flushInterval, count > 0 else { return }
+
+    if getSystemUptimeInMilliseconds() - firstPendingTime >= Int64(interval) {
+      try flushBuffer()
+    }
+  }
+
+  /// Clears the statistics.
+  public func resetStatistics() {
+    bytesWritten = 0
+    fileWrites = 0
+    fileWriteTime = 0
+  }
+
+  private func flushBuffer() throws(Errno) {
+    let written = try writeFile(UnsafeRawBufferPointer(start: buffer.baseAddress!, count: count))
+    if written < count {
+      // Keep what didn't fit for the next flush. It ends where the buffered
+      // bytes did, so it still fits in the new limit.
+      buffer.baseAddress!.copyMemory(from: buffer.baseAddress! + written, byteCount: count - written)
+      count -= written
+      throw Errno.noSpace
+    }
+    count = 0
+  }
+
+  /// Writes to the file and returns the bytes written, less than the count
+  /// of data if the volume is full.
+  @discardableResult
+  private func writeFile(_ data: UnsafeRawBufferPointer) throws(Errno) -> Int {
+    let start = getClockCycle()
+    let written = try file.write(data)
+    fileWriteTime += cyclesToNanoseconds(start: start, stop: getClockCycle())
+    fileWrites += 1
+
+    fileOffset += written
+    limit = bufferSize - fileOffset % bufferSize
+    return written
+  }
+
+  private static let sectorSize = 512
+}
@@ -0,0 +1,225 @@
+//=== CachedFile.swift ----------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The CachedFile class keeps recently read blocks of a read-only file in
+/// RAM, so small random reads don't each wait for the SD card.
+///
+/// Fonts, images and lookup tables are usually read a few bytes at a time
+/// all over the file. The cache reads whole blocks and serves the small
+/// reads from them. When all blocks are in use, the one not touched for the
+/// longest time is replaced, using the CLOCK approximation of LRU.
+///
+/// Besides copying reads, ``bytes(at:count:)`` returns a view straight into
+/// the cached block, so looking up a glyph or a table entry copies nothing.
+/// A view stays valid until the next call to the cache.
+///
+/// ```swift
+/// let file = try FileDescriptor.open("/SD:/font.bin", .readOnly)
+/// let font = try CachedFile(file, blockSize: 4096, blockCount: 8)
+///
+/// let entry = try font.bytes(at: 16 + Int(character) * 8, count: 8)
+/// let offset = entry.loadUnaligned(as: UInt32.self)
+/// ```
+public final class CachedFile {
+  private let file: FileDescriptor
+  private let storage: UnsafeMutableRawBufferPointer
+  /// Holds a range that spans two blocks.
+  private let scratch: UnsafeMutableRawBufferPointer
+  /// The file block held by each slot, -1 if empty.
+  private var blocks: [Int]
+  /// The valid bytes of each slot, less than the block size at the end.
+  private var lengths: [Int]
+  private var referenced: [Bool]
+  private var slots: [Int: Int] = [:]
+  private var hand = 0
+
+  /// The size of a block in bytes, a multiple of 512.
+  public let blockSize: Int
+  /// The count of blocks kept in RAM.
+  public let blockCount: Int
+
+  /// The count of block lookups served from RAM.
+  public private(set) var hits = 0
+  /// The count of block lookups that read the file.
+  public private(set) var misses = 0
+  /// The total time in nanoseconds spent in file reads.
+  public private(set) var fileReadTime: Int64 = 0
+
+  /**
+     Creates a cache in front of a file.
+
+     The file must not change while it is cached.
+     - Parameter file: **REQUIRED** A file opened for reading.
+     - Parameter blockSize: **OPTIONAL** The size of a block, rounded up to
+        a multiple of 512. 4096 by default.
+     - Parameter blockCount: **OPTIONAL** The count of blocks kept in RAM,
+        8 by default.
+     */
+  public init(_ file: FileDescriptor, blockSize: Int = 4096, blockCount: Int = 8) throws(Errno) {
+    guard blockSize > 0 && blockCount > 0 else {
+      throw Errno.invalidArgument
+    }
+
+    let size = (blockSize + CachedFile.sectorSize - 1) & ~(CachedFile.sectorSize - 1)
+
+    self.file = file
+    self.blockSize = size
+    self.blockCount = blockCount
+    blocks = [Int](repeating: -1, count: blockCount)
+    lengths = [Int](repeating: 0, count: blockCount)
+    referenced = [Bool](repeating: false, count: blockCount)
+    storage = UnsafeMutableRawBufferPointer.allocate(byteCount: size * blockCount, alignment: 32)
+    scratch = UnsafeMutableRawBufferPointer.allocate(byteCount: size, alignment: 4)
+  }
+
+  deinit {
+    storage.deallocate()
+    scratch.deallocate()
+  }
+
+  /// The size of the file in bytes.
+  public var size: Int { file.size }
+
+  /// The share of block lookups served from RAM, from 0 to 1.
+  public var hitRatio: Float {
+    hits + misses > 0 ? Float(hits) / Float(hits + misses) : 0
+  }
+
+  /**
+     Reads bytes at an offset into a buffer.
+     - Parameter offset: **REQUIRED** The file offset where reading begins.
+     - Parameter buffer: **REQUIRED** The region of memory to read into.
+     - Returns: The bytes read, less than the size of the buffer only at the
+        end of the file.
+     */
+  @discardableResult
+  public func read(fromAbsoluteOffset offset: Int, into buffer: UnsafeMutableRawBufferPointer)
+    throws(Errno) -> Int
+  {
+    guard let base = buffer.baseAddress, offset >= 0 else { return 0 }
+    var copied = 0
+
+    while copied < buffer.count {
+      let block = try self.block(at: offset + copied)
+      if block.count == 0 { break }
+      let chunk = min(buffer.count - copied, block.count)
+      (base + copied).copyMemory(from: block.baseAddress!, byteCount: chunk)
+      copied += chunk
+    }
+    return copied
+  }
+
+  /**
+     Returns the cached bytes from an offset to the end of its block.
+     - Parameter offset: **REQUIRED** The file offset.
+     - Returns: A view into the cache, empty at the end of the file. The view
+        is valid until the next call to the cache.
+     */
+  public func block(at offset: Int) throws(Errno) -> UnsafeRawBufferPointer {
+    guard offset >= 0 else {
+      throw Errno.invalidArgument
+    }
+
+    let slot = try lookup(offset / blockSize)
+    let start = offset % blockSize
+    guard start < lengths[slot] else {
+      return UnsafeRawBufferPointer(start: nil, count: 0)
+    }
+    return UnsafeRawBufferPointer(
+      start: storage.baseAddress! + slot * blockSize + start, count: lengths[slot] - start)
+  }
+
+  /**
+     Returns a range of the file without copying it if it lies in one block.
+
+     A range across two blocks is copied into an internal buffer.
+     - Parameter offset: **REQUIRED** The file offset of the first byte.
+     - Parameter count: **REQUIRED** The bytes wanted, not larger than
+        ``blockSize``.
+     - Returns: A view of the bytes, shorter than count only at the end of
+        the file. The view is valid until the next call to the cache.
+     */
+  public func bytes(at offset: Int, count: Int) throws(Errno) -> UnsafeRawBufferPointer {
+    guard count >= 0 && count <= blockSize else {
+      throw Errno.invalidArgument
+    }
+
+    let first = try block(at: offset)
+    if first.count >= count || first.count < blockSize - offset % blockSize {
+      // Whole range in the block, or the file ends in it.
+      return UnsafeRawBufferPointer(rebasing: first[0..<min(count, first.count)])
+    }
+
+    let read = try self.read(
+      fromAbsoluteOffset: offset,
+      into: UnsafeMutableRawBufferPointer(rebasing: scratch[0..<count]))
+    return UnsafeRawBufferPointer(rebasing: scratch[0..<read])
+  }
+
+  /// Drops all cached blocks, for example after the file was replaced.
+  public func invalidate() {
+    for slot in 0..<blockCount {
+      blocks[slot] = -1
+      lengths[slot] = 0
+      referenced[slot] = false
+    }
+    slots.removeAll()
+  }
+
+  /// Clears the statistics.
+  public func resetStatistics() {
+    hits = 0
+    misses = 0
+    fileReadTime = 0
+  }
+
+  /// Returns the slot of a block, reading it into the slot picked by the
+  /// clock hand if it isn't cached.
+  private func lookup(_ block: Int) throws(Errno) -> Int {
+    if let slot = slots[block] {
+      hits += 1
+      referenced[slot] = true
+      return slot
+    }
+    misses += 1
+
+    // Skip recently used slots, clearing their bit on the way.
+    while referenced[hand] {
+      referenced[hand] = false
+      hand = (hand + 1) % blockCount
+    }
+    let slot = hand
+    hand = (hand + 1) % blockCount
+
+    if blocks[slot] >= 0 {
+      slots[blocks[slot]] = nil
+    }
+    blocks[slot] = -1
+
+    let start = getClockCycle()
+    let read = try file.read(
+      fromAbsoluteOffest: block * blockSize,
+      into: UnsafeMutableRawBufferPointer(
+        start: storage.baseAddress! + slot * blockSize, count: blockSize))
+    fileReadTime += cyclesToNanoseconds(start: start, stop: getClockCycle())
+
+    blocks[slot] = block
+    lengths[slot] = read
+    referenced[slot] = true
+    slots[block] = slot
+    return slot
+  }
+
+  private static let sectorSize = 512
+}
@@ -0,0 +1,436 @@
+//=== CompressedFile.swift ------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The CompressedFileWriter class compresses data with LZ4 on its way to a
+/// file.
+///
+/// Text and sensor logs usually shrink to a half or a third, so the card
+/// is written less often and holds more data. The data is cut into blocks
+/// that are compressed on their own, each behind a small header:
+///
+/// | Bytes | Content                                                  |
+/// | ----- | -------------------------------------------------------- |
+/// | 4     | Payload size, the top bit set if the block is stored raw |
+/// | 4     | Size of the data once decompressed                       |
+/// | 4     | CRC-32 of the payload                                    |
+/// | n     | Payload, an LZ4 block or the raw data                    |
+///
+/// all little endian. If power is lost while a block is written, a
+/// ``CompressedFileReader`` still returns every block before it. The
+/// payloads are standard LZ4 blocks, so the files can be decoded on a
+/// computer too.
+///
+/// All memory is allocated when the writer is created: two blocks and
+/// 2 KB for the compressor.
+///
+/// ```swift
+/// let file = try FileDescriptor.open("/SD:/log.lz", options: .create)
+/// let writer = try CompressedFileWriter(file)
+///
+/// try writer.write("time,temperature,humidity\n")
+/// try writer.flush()
+/// ```
+public final class CompressedFileWriter {
+  private let file: FileDescriptor
+  private let input: UnsafeMutableRawBufferPointer
+  /// The block header followed by the compressed payload.
+  private let output: UnsafeMutableRawBufferPointer
+  private let state: UnsafeMutablePointer<swift_lz4_state_t>
+  private var count = 0
+
+  /// The size of the data in a block in bytes.
+  public let blockSize: Int
+
+  /// The count of bytes passed to the writer.
+  public private(set) var bytesIn = 0
+  /// The count of bytes written to the file, headers included.
+  public private(set) var bytesOut = 0
+  /// The count of blocks written.
+  public private(set) var blocks = 0
+  /// The total time in nanoseconds spent compressing.
+  public private(set) var compressTime: Int64 = 0
+
+  /**
+     Creates a writer at the current offset of a file.
+
+     - Parameter file: **REQUIRED** A file opened for writing.
+     - Parameter blockSize: **OPTIONAL** The size of the data in a block,
+        64 to 65535 bytes. Larger blocks compress better, smaller ones lose
+        less on a power cut. 4096 by default.
+     */
+  public init(_ file: FileDescriptor, blockSize: Int = 4096) throws(Errno) {
+    guard blockSize >= 64 && blockSize <= Int(SWIFT_LZ4_MAX_BLOCK) else {
+      throw Errno.invalidArgument
+    }
+
+    self.file = file
+    self.blockSize = blockSize
+    input = UnsafeMutableRawBufferPointer.allocate(byteCount: blockSize, alignment: 4)
+    output = UnsafeMutableRawBufferPointer.allocate(
+      byteCount: CompressedFileWriter.headerSize + CompressedFileWriter.bound(blockSize),
+      alignment: 4)
+    state = UnsafeMutablePointer<swift_lz4_state_t>.allocate(capacity: 1)
+  }
+
+  deinit {
+    try? flush()
+    input.deallocate()
+    output.deallocate()
+    state.deallocate()
+  }
+
+  /// The bytes written to the file for every byte passed in, lower is
+  /// better.
+  public var ratio: Float {
+    bytesIn > 0 ? Float(bytesOut) / Float(bytesIn) : 0
+  }
+
+  /**
+     Writes the contents of a buffer.
+     - Parameter data: **REQUIRED** The bytes to write.
+     */
+  public func write(_ data: UnsafeRawBufferPointer) throws(Errno) {
+    guard var source = data.baseAddress else { return }
+    var remaining = data.count
+
+    while remaining > 0 {
+      // A block whose write failed before is still waiting.
+      if count == blockSize {
+        try writeBlock()
+      }
+
+      let chunk = min(remaining, blockSize - count)
+      (input.baseAddress! + count).copyMemory(from: source, byteCount: chunk)
+      count += chunk
+      source += chunk
+      remaining -= chunk
+      bytesIn += chunk
+
+      if count == blockSize {
+        try writeBlock()
+      }
+    }
+  }
+
+  /**
+     Writes an array of bytes.
+     - Parameter data: **REQUIRED** The bytes to write.
+     */
+  public func write(_ data: [UInt8]) throws(Errno) {
+    var result: Result<(), Errno> = .success(())
+    data.withUnsafeBytes { pointer in
+      do throws(Errno) {
+        try write(pointer)
+      } catch {
+        result = .failure(error)
+      }
+    }
+    if case .failure(let err) = result {
+      throw err
+    }
+  }
+
+  /**
+     Writes the UTF-8 contents of a string.
+     - Parameter string: **REQUIRED** The string to write.
+     */
+  public func write(_ string: String) throws(Errno) {
+    var string = string
+    var result: Result<(), Errno> = .success(())
+    string.withUTF8 { pointer in
+      do throws(Errno) {
+        try write(UnsafeRawBufferPointer(pointer))
+      } catch {
+        result = .failure(error)
+      }
+    }
+    if case .failure(let err) = result {
+      throw err
+    }
+  }
+
+  /**
+     Compresses the buffered bytes into a block, shorter than
+     ``blockSize``, and writes it.
+     - Parameter sync: **OPTIONAL** Whether to also flush the cache of the
+        file system to the card, false by default.
+     */
+  public func flush(sync: Bool = false) throws(Errno) {
+    if count > 0 {
+      try writeBlock()
+    }
+    if sync {
+      try file.sync()
+    }
+  }
+
+  /// Clears the statistics.
+  public func resetStatistics() {
+    bytesIn = 0
+    bytesOut = 0
+    blocks = 0
+    compressTime = 0
+  }
+
+  /// Writes the buffered bytes as a block. If the write fails the bytes
+  /// stay buffered and the file offset goes back to the block start, so
+  /// the next write or flush retries the whole block.
+  private func writeBlock() throws(Errno) {
+    let length = count
+    let blockStart = try file.tell()
+
+    let payload = output.baseAddress! + CompressedFileWriter.headerSize
+    let input = self.input.baseAddress!
+
+    let start = getClockCycle()
+    let compressed = swift_lz4_compress(
+      state, input.assumingMemoryBound(to: UInt8.self), Int32(length),
+      payload.assumingMemoryBound(to: UInt8.self),
+      Int32(min(length - 1, output.count - CompressedFileWriter.headerSize)))
+    compressTime += cyclesToNanoseconds(start: start, stop: getClockCycle())
+
+    var written = 0
+    do throws(Errno) {
+      written = try writeEncoded(length, compressed: Int(compressed))
+    } catch {
+      try? file.seek(offset: blockStart)
+      throw error
+    }
+
+    count = 0
+    bytesOut += written
+    blocks += 1
+  }
+
+  private func writeEncoded(_ length: Int, compressed: Int) throws(Errno) -> Int {
+    let header = output.baseAddress!
+    let payload = header + CompressedFileWriter.headerSize
+    let input = self.input.baseAddress!
+
+    let written: Int
+    if compressed > 0 {
+      // Header and payload are contiguous.
+      let size = compressed
+      CompressedFileWriter.storeHeader(
+        header, size: UInt32(size), length: length,
+        crc: swift_crc32(0, payload, size))
+      let total = CompressedFileWriter.headerSize + size
+      written = try file.write(UnsafeRawBufferPointer(start: header, count: total))
+      if written < total {
+        throw Errno.noSpace
+      }
+    } else {
+      // Didn't shrink, store the raw bytes behind the header.
+      CompressedFileWriter.storeHeader(
+        header, size: UInt32(length) | CompressedFileWriter.rawFlag, length: length,
+        crc: swift_crc32(0, input, length))
+      written = try file.write([
+        UnsafeRawBufferPointer(start: header, count: CompressedFileWriter.headerSize),
+        UnsafeRawBufferPointer(start: input, count: length),
+      ])
+      if written < CompressedFileWriter.headerSize + length {
+        throw Errno.noSpace
+      }
+    }
+    return written
+  }
+
+  private static func storeHeader(
+    _ header: UnsafeMutableRawPointer, size: UInt32, length: Int, crc: UInt32
+  ) {
+    header.storeBytes(of: size.littleEndian, as: UInt32.self)
+    header.storeBytes(of: UInt32(length).littleEndian, toByteOffset: 4, as: UInt32.self)
+    header.storeBytes(of: crc.littleEndian, toByteOffset: 8, as: UInt32.self)
+  }
+
+  static func bound(_ size: Int) -> Int {
+    size + size / 255 + 16
+  }
+
+  static let headerSize = 12
+  static let rawFlag: UInt32 = 0x8000_0000
+}
+
+/// The CompressedFileReader class reads back a file written by
+/// ``CompressedFileWriter``.
+///
+/// Each block is checked against its CRC before it is decompressed. The
+/// reader stops at the first block that is cut short or damaged, which is
+/// where a power cut during writing leaves the file, and sets
+/// ``isTruncated``.
+///
+/// ```swift
+/// let file = try FileDescriptor.open("/SD:/log.lz", .readOnly)
+/// let reader = try CompressedFileReader(file)
+/// var buffer = [UInt8](repeating: 0, count: 256)
+///
+/// while try reader.read(into: &buffer) > 0 {
+///     // ...
+/// }
+/// ```
+public final class CompressedFileReader {
+  private let file: FileDescriptor
+  private let compressed: UnsafeMutableRawBufferPointer
+  private let decoded: UnsafeMutableRawBufferPointer
+  private var position = 0
+  private var end = 0
+  private var reachedEnd = false
+
+  /// The largest block the reader accepts, the block size of the writer.
+  public let blockSize: Int
+  /// Whether reading stopped at a partial or damaged block rather than at
+  /// the end of the file.
+  public private(set) var isTruncated = false
+
+  /// The count of blocks read.
+  public private(set) var blocks = 0
+  /// The total time in nanoseconds spent decompressing.
+  public private(set) var decompressTime: Int64 = 0
+
+  /**
+     Creates a reader at the current offset of a file.
+
+     - Parameter file: **REQUIRED** A file opened for reading.
+     - Parameter blockSize: **OPTIONAL** The block size the file was
+        written with, 4096 by default.
+     */
+  public init(_ file: FileDescriptor, blockSize: Int = 4096) throws(Errno) {
+    guard blockSize >= 64 && blockSize <= Int(SWIFT_LZ4_MAX_BLOCK) else {
+      throw Errno.invalidArgument
+    }
+
+    self.file = file
+    self.blockSize = blockSize
+    compressed = UnsafeMutableRawBufferPointer.allocate(
+      byteCount: max(CompressedFileWriter.headerSize, CompressedFileWriter.bound(blockSize)),
+      alignment: 4)
+    decoded = UnsafeMutableRawBufferPointer.allocate(byteCount: blockSize, alignment: 4)
+  }
+
+  deinit {
+    compressed.deallocate()
+    decoded.deallocate()
+  }
+
+  /**
+     Reads decompressed bytes into a buffer.
+     - Parameter destination: **REQUIRED** The region of memory to read into.
+     - Returns: The bytes read, less than the size of the destination only at
+        the end of the valid data.
+     */
+  @discardableResult
+  public func read(into destination: UnsafeMutableRawBufferPointer) throws(Errno) -> Int {
+    guard let base = destination.baseAddress else { return 0 }
+    var copied = 0
+
+    while copied < destination.count {
+      if position == end {
+        guard try readBlock() else { break }
+      }
+      let chunk = min(destination.count - copied, end - position)
+      (base + copied).copyMemory(from: decoded.baseAddress! + position, byteCount: chunk)
+      position += chunk
+      copied += chunk
+    }
+    return copied
+  }
+
+  /**
+     Reads decompressed bytes into an array.
+     - Parameter buffer: **REQUIRED** The array to read into.
+     - Returns: The bytes read.
+     */
+  @discardableResult
+  public func read(into buffer: inout [UInt8]) throws(Errno) -> Int {
+    var result: Result<Int, Errno> = .success(0)
+    buffer.withUnsafeMutableBytes { pointer in
+      do throws(Errno) {
+        result = .success(try read(into: pointer))
+      } catch {
+        result = .failure(error)
+      }
+    }
+    switch result {
+    case .success(let value):
+      return value
+    case .failure(let err):
+      throw err
+    }
+  }
+
+  /// Clears the statistics.
+  public func resetStatistics() {
+    blocks = 0
+    decompressTime = 0
+  }
+
+  /// Reads and checks the next block. Returns false at the end of the
+  /// valid data.
+  private func readBlock() throws(Errno) -> Bool {
+    guard !reachedEnd else { return false }
+    reachedEnd = true
+
+    let header = compressed.baseAddress!
+    let headerRead = try file.read(
+      into: UnsafeMutableRawBufferPointer(start: header, count: CompressedFileWriter.headerSize))
+    guard headerRead == CompressedFileWriter.headerSize else {
+      isTruncated = headerRead > 0
+      return false
+    }
+
+    let word = UInt32(littleEndian: header.loadUnaligned(as: UInt32.self))
+    // A damaged length may not fit an Int on 32-bit boards, it is then
+    // negative and rejected below.
+    let length = Int(
+      truncatingIfNeeded: UInt32(
+        littleEndian: header.loadUnaligned(fromByteOffset: 4, as: UInt32.self)))
+    let crc = UInt32(littleEndian: header.loadUnaligned(fromByteOffset: 8, as: UInt32.self))
+    let isRaw = word & CompressedFileWriter.rawFlag != 0
+    let size = Int(word & ~CompressedFileWriter.rawFlag)
+
+    // A raw payload is read straight into the output.
+    let payload = isRaw ? decoded.baseAddress! : compressed.baseAddress!
+    let capacity = isRaw ? decoded.count : compressed.count
+    guard length > 0 && length <= blockSize && size > 0 && size <= capacity,
+      !isRaw || size == length
+    else {
+      isTruncated = true
+      return false
+    }
+
+    let payloadRead = try file.read(into: UnsafeMutableRawBufferPointer(start: payload, count: size))
+    guard payloadRead == size, swift_crc32(0, payload, size) == crc else {
+      isTruncated = true
+      return false
+    }
+
+    if !isRaw {
+      let start = getClockCycle()
+      let result = swift_lz4_decompress(
+        payload.assumingMemoryBound(to: UInt8.self), Int32(size),
+        decoded.baseAddress!.assumingMemoryBound(to: UInt8.self), Int32(length))
+      decompressTime += cyclesToNanoseconds(start: start, stop: getClockCycle())
+      guard result == length else {
+        isTruncated = true
+        return false
+      }
+    }
+
+    position = 0
+    end = length
+    blocks += 1
+    reachedEnd = false
+    return true
+  }
+}
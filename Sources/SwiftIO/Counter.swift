@@ -99,6 +99,18 @@ public final class Counter {
     }
   }
 
+  /// Sets flags of an event group once the period has elapsed, so a thread
+  /// can wait for this counter together with other events.
+  /// - Parameters:
+  ///   - start: Whether to start the counter once it’s set, `true` by default.
+  ///   - flags: The flags to set.
+  ///   - group: The event group the thread waits on.
+  public func setInterrupt(start: Bool = true, post flags: UInt32, to group: EventGroup) {
+    setInterrupt(start: start) { _ in
+      group.set(flags)
+    }
+  }
+
   /// Starts the counter.
   /// - Parameters:
   ///   - mode: The mode of the counter. If it’s nil, it adopts the mode set
@@ -0,0 +1,455 @@
+//=== DataLogger.swift ----------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The DataLogger class appends records to a series of files so that a
+/// power cut loses at most the records since the last commit, never the
+/// ones before.
+///
+/// Opening a file in append mode and calling `sync()` after every record
+/// makes the file system update its allocation table and directory entry
+/// each time, which is slow and wears the card. The logger instead:
+///
+/// - preallocates every file to ``fileSize`` with `truncate`, so writes
+///   don't grow the file;
+/// - buffers records and syncs them together every ``syncRecords``
+///   records or ``syncInterval`` milliseconds, whichever comes first;
+/// - frames each record with its length, a sequence number and a CRC-32,
+///   so a torn write is detected;
+/// - starts a new file when the current one is full or older than
+///   ``rotationInterval``.
+///
+/// Files are named `<prefix>0000.log`, `<prefix>0001.log`, ... in the
+/// directory. When the logger is created, it scans the newest file for the
+/// last valid record, drops anything behind it and continues from there.
+///
+/// A record on the file is laid out as follows, all little endian:
+///
+/// | Bytes | Content                                    |
+/// | ----- | ------------------------------------------ |
+/// | 4     | Payload length, never 0                    |
+/// | 4     | Sequence number, one more than the last    |
+/// | n     | Payload                                    |
+/// | 4     | CRC-32 of all the bytes above              |
+///
+/// The unused part of a file is zero, so a length of 0 marks the end.
+///
+/// ```swift
+/// let logger = try DataLogger(directory: "/SD:", prefix: "imu")
+///
+/// while true {
+///     let sample: [UInt8] = readSensor()
+///     try logger.append(sample)
+///     sleep(ms: 5)
+/// }
+/// ```
+public final class DataLogger {
+  private let directory: String
+  private let prefix: String
+  private let bufferSize: Int
+  /// Scratch space for the record header and CRC.
+  private let frame: UnsafeMutableRawBufferPointer
+
+  private var file: FileDescriptor
+  private var writer: BufferedFileWriter
+  private var fileIndex: Int
+  /// The end of the last record in the current file.
+  private var fileOffset: Int
+  private var fileOpenTime: Int64
+  private var sequence: UInt32
+  private var pendingRecords = 0
+  private var firstPendingTime: Int64 = 0
+  private var isClosed = false
+
+  /// The size each file is preallocated to, also the largest a file grows.
+  public let fileSize: Int
+  /// The largest payload of one record.
+  public let maxRecordSize: Int
+  /// The count of records after which they are synced to the card.
+  public var syncRecords: Int
+  /// The longest time in milliseconds a record waits before it is synced.
+  public var syncInterval: Int
+  /// The longest time in milliseconds a file is written before a new one
+  /// is started, nil to only start one when the file is full.
+  public var rotationInterval: Int?
+
+  /// The path of the file being written.
+  public private(set) var path: String
+
+  /// The count of records recovered from the newest file at creation.
+  public let recoveredRecords: Int
+  /// The count of records appended.
+  public private(set) var records = 0
+  /// The count of payload bytes appended.
+  public private(set) var bytes = 0
+  /// The count of commits, each one a sync of the file.
+  public private(set) var commits = 0
+  /// The total time in nanoseconds spent in commits.
+  public private(set) var commitTime: Int64 = 0
+  /// The longest time in nanoseconds a commit took.
+  public private(set) var maxCommitTime: Int64 = 0
+  /// The count of new files started.
+  public private(set) var rotations = 0
+
+  /**
+     Opens the newest log file in a directory, or creates the first one.
+
+     - Parameter directory: **REQUIRED** The directory of the log files.
+     - Parameter prefix: **OPTIONAL** The start of the file names, "data"
+        by default.
+     - Parameter fileSize: **OPTIONAL** The size of each file in bytes,
+        1 MiB by default.
+     - Parameter bufferSize: **OPTIONAL** The size of the write buffer,
+        rounded up to a multiple of 512. A record and its 12 bytes of
+        framing must fit in it. 8192 by default.
+     - Parameter syncRecords: **OPTIONAL** The count of records after
+        which they are synced, 64 by default.
+     - Parameter syncInterval: **OPTIONAL** The longest time in
+        milliseconds a record waits to be synced, 1000 by default.
+     - Parameter rotationInterval: **OPTIONAL** The longest time in
+        milliseconds a file is written.
+     */
+  public init(
+    directory: String,
+    prefix: String = "data",
+    fileSize: Int = 1024 * 1024,
+    bufferSize: Int = 8192,
+    syncRecords: Int = 64,
+    syncInterval: Int = 1000,
+    rotationInterval: Int? = nil
+  ) throws(Errno) {
+    let size = (bufferSize + 511) & ~511
+    guard size > DataLogger.overhead, fileSize >= size, syncRecords > 0 else {
+      throw Errno.invalidArgument
+    }
+
+    self.directory = directory
+    self.prefix = prefix
+    self.bufferSize = size
+    self.fileSize = fileSize
+    self.maxRecordSize = size - DataLogger.overhead
+    self.syncRecords = syncRecords
+    self.syncInterval = syncInterval
+    self.rotationInterval = rotationInterval
+
+    // Find the newest file, the one with the largest index. Files may have
+    // been deleted in between, so all of them are listed.
+    var newest: Int? = nil
+    let listing = try Directory(directory, matching: prefix + "*.log")
+    while let entry = try listing.next() {
+      if let index = DataLogger.index(of: entry.name, prefix: prefix), index >= newest ?? 0 {
+        newest = index
+      }
+    }
+
+    var index = 0
+    var recovered = 0
+    var nextSequence: UInt32 = 0
+    var opened: (file: FileDescriptor, offset: Int)? = nil
+
+    if let newest = newest {
+      index = newest
+      let existing = try FileDescriptor.open(DataLogger.path(directory, prefix, index))
+      let scan = try DataLogger.scan(existing, bufferSize: size)
+      recovered = scan.records
+      nextSequence = scan.sequence
+
+      // Zero the torn tail so it can't be mistaken for records later.
+      if scan.isTorn {
+        try existing.truncate(to: scan.end)
+      }
+      if scan.end + DataLogger.overhead < fileSize {
+        try existing.truncate(to: fileSize)
+        try existing.seek(offset: scan.end)
+        opened = (existing, scan.end)
+      } else {
+        try existing.close()
+        index += 1
+      }
+    }
+
+    if opened == nil {
+      opened = (try DataLogger.create(DataLogger.path(directory, prefix, index), size: fileSize), 0)
+    }
+
+    file = opened!.file
+    fileOffset = opened!.offset
+    fileIndex = index
+    path = DataLogger.path(directory, prefix, index)
+    fileOpenTime = getSystemUptimeInMilliseconds()
+    sequence = nextSequence
+    recoveredRecords = recovered
+    writer = try BufferedFileWriter(file, bufferSize: size)
+    frame = UnsafeMutableRawBufferPointer.allocate(byteCount: DataLogger.overhead, alignment: 4)
+  }
+
+  deinit {
+    try? close()
+    frame.deallocate()
+  }
+
+  /// The count of records appended but not yet synced.
+  public var pendingCount: Int { pendingRecords }
+
+  /**
+     Appends a record.
+
+     The record is safe on the card after the next commit, which happens
+     on its own after ``syncRecords`` records or ``syncInterval``
+     milliseconds.
+     - Parameter record: **REQUIRED** The payload, 1 to ``maxRecordSize``
+        bytes.
+     */
+  public func append(_ record: UnsafeRawBufferPointer) throws(Errno) {
+    guard !isClosed else {
+      throw Errno.badFileDescriptor
+    }
+    guard record.count > 0 && record.count <= maxRecordSize else {
+      throw Errno.invalidArgument
+    }
+
+    if fileOffset + DataLogger.overhead + record.count > fileSize || isExpired() {
+      try rotate()
+    }
+
+    let head = frame.baseAddress!
+    head.storeBytes(of: UInt32(record.count).littleEndian, as: UInt32.self)
+    head.storeBytes(of: sequence.littleEndian, toByteOffset: 4, as: UInt32.self)
+    var crc = swift_crc32(0, head, 8)
+    crc = swift_crc32(crc, record.baseAddress, record.count)
+    head.storeBytes(of: crc.littleEndian, toByteOffset: 8, as: UInt32.self)
+
+    try writer.write(UnsafeRawBufferPointer(start: head, count: 8))
+    try writer.write(record)
+    try writer.write(UnsafeRawBufferPointer(start: head + 8, count: 4))
+
+    fileOffset += DataLogger.overhead + record.count
+    sequence &+= 1
+    records += 1
+    bytes += record.count
+
+    if pendingRecords == 0 {
+      firstPendingTime = getSystemUptimeInMilliseconds()
+    }
+    pendingRecords += 1
+
+    if pendingRecords >= syncRecords {
+      try commit()
+    } else {
+      try commitIfExpired()
+    }
+  }
+
+  /**
+     Appends a record from an array of bytes.
+     - Parameter record: **REQUIRED** The payload.
+     */
+  public func append(_ record: [UInt8]) throws(Errno) {
+    var result: Result<(), Errno> = .success(())
+    record.withUnsafeBytes { pointer in
+      do throws(Errno) {
+        try append(pointer)
+      } catch {
+        result = .failure(error)
+      }
+    }
+    if case .failure(let err) = result {
+      throw err
+    }
+  }
+
+  /**
+     Appends the UTF-8 contents of a string as a record.
+     - Parameter string: **REQUIRED** The payload.
+     */
+  public func append(_ string: String) throws(Errno) {
+    var string = string
+    var result: Result<(), Errno> = .success(())
+    string.withUTF8 { pointer in
+      do throws(Errno) {
+        try append(UnsafeRawBufferPointer(pointer))
+      } catch {
+        result = .failure(error)
+      }
+    }
+    if case .failure(let err) = result {
+      throw err
+    }
+  }
+
+  /// Writes the pending records and syncs the file.
+  public func commit() throws(Errno) {
+    guard pendingRecords > 0 else { return }
+
+    let start = getClockCycle()
+    try writer.flush(sync: true)
+    let time = cyclesToNanoseconds(start: start, stop: getClockCycle())
+
+    commitTime += time
+    maxCommitTime = max(maxCommitTime, time)
+    commits += 1
+    pendingRecords = 0
+  }
+
+  /**
+     Commits if the oldest pending record has waited ``syncInterval``
+     milliseconds.
+
+     Appends commit by time on their own. Call this method regularly if
+     records may stop arriving for longer than the interval.
+     */
+  public func commitIfExpired() throws(Errno) {
+    guard pendingRecords > 0 else { return }
+
+    if getSystemUptimeInMilliseconds() - firstPendingTime >= Int64(syncInterval) {
+      try commit()
+    }
+  }
+
+  /// Commits the pending records and starts a new file.
+  public func rotate() throws(Errno) {
+    try finishFile()
+
+    fileIndex += 1
+    path = DataLogger.path(directory, prefix, fileIndex)
+    file = try DataLogger.create(path, size: fileSize)
+    writer = try BufferedFileWriter(file, bufferSize: bufferSize)
+    fileOffset = 0
+    fileOpenTime = getSystemUptimeInMilliseconds()
+    rotations += 1
+  }
+
+  /**
+     Commits the pending records and closes the file, trimming the unused
+     preallocated space.
+     */
+  public func close() throws(Errno) {
+    guard !isClosed else { return }
+    isClosed = true
+    try finishFile()
+  }
+
+  /// Clears the statistics.
+  public func resetStatistics() {
+    records = 0
+    bytes = 0
+    commits = 0
+    commitTime = 0
+    maxCommitTime = 0
+    rotations = 0
+  }
+
+  private func isExpired() -> Bool {
+    guard let interval = rotationInterval, fileOffset > 0 else { return false }
+    return getSystemUptimeInMilliseconds() - fileOpenTime >= Int64(interval)
+  }
+
+  private func finishFile() throws(Errno) {
+    try commit()
+    try file.truncate(to: fileOffset)
+    try file.close()
+  }
+
+  private static func create(_ path: String, size: Int) throws(Errno) -> FileDescriptor {
+    let file = try FileDescriptor.open(path, options: .create)
+    // A file left with the same name must not show its records behind ours.
+    try file.truncate(to: 0)
+    try file.truncate(to: size)
+    return file
+  }
+
+  /// Reads a file from the start and returns the end of the last valid
+  /// record, the count of valid records, the next sequence number and
+  /// whether the records end with a torn or corrupt one.
+  ///
+  /// A record may be longer than the buffer, it was maybe written with a
+  /// larger one, so only the size of the file bounds its length.
+  private static func scan(_ file: FileDescriptor, bufferSize: Int) throws(Errno)
+    -> (end: Int, records: Int, sequence: UInt32, isTorn: Bool)
+  {
+    let size = file.size
+    try file.seek(offset: 0)
+    let reader = try BufferedFileReader(file, bufferSize: bufferSize)
+    let chunk = UnsafeMutableRawBufferPointer.allocate(byteCount: 512, alignment: 4)
+    defer { chunk.deallocate() }
+
+    var end = 0
+    var records = 0
+    var expected: UInt32? = nil
+    var reachedZero = false
+
+    while let head = try reader.readRecord(count: 8) {
+      let length = Int(truncatingIfNeeded: UInt32(littleEndian: head.loadUnaligned(as: UInt32.self)))
+      let sequence = UInt32(littleEndian: head.loadUnaligned(fromByteOffset: 4, as: UInt32.self))
+      if length == 0 {
+        reachedZero = true
+        break
+      }
+      guard length > 0 && length <= size - reader.offset - 4,
+        expected == nil || sequence == expected!
+      else {
+        break
+      }
+
+      var crc = swift_crc32(0, head.baseAddress, 8)
+      var remaining = length
+      while remaining > 0 {
+        let read = try reader.read(
+          into: UnsafeMutableRawBufferPointer(rebasing: chunk[0..<min(remaining, chunk.count)]))
+        guard read > 0 else { break }
+        crc = swift_crc32(crc, chunk.baseAddress, read)
+        remaining -= read
+      }
+      guard remaining == 0, let tail = try reader.readRecord(count: 4),
+        UInt32(littleEndian: tail.loadUnaligned(as: UInt32.self)) == crc
+      else {
+        break
+      }
+
+      end = reader.offset
+      records += 1
+      expected = sequence &+ 1
+    }
+
+    // Anything but the zero preallocated space behind the last record is
+    // a torn or corrupt record.
+    return (end, records, expected ?? 0, !reachedZero && end < size)
+  }
+
+  /// Returns the index in the name of a log file, nil for other names.
+  private static func index(of name: String, prefix: String) -> Int? {
+    guard name.utf8.starts(with: prefix.utf8) && name.utf8.reversed().starts(with: "gol.".utf8)
+    else {
+      return nil
+    }
+    let digits = name.utf8.dropFirst(prefix.utf8.count).dropLast(4)
+    guard !digits.isEmpty && digits.count <= 9 else { return nil }
+    var index = 0
+    for digit in digits {
+      guard digit >= 0x30 && digit <= 0x39 else { return nil }
+      index = index * 10 + Int(digit - 0x30)
+    }
+    return index
+  }
+
+  private static func path(_ directory: String, _ prefix: String, _ index: Int) -> String {
+    var number = "\(index)"
+    while number.utf8.count < 4 {
+      number = "0" + number
+    }
+    return directory + "/" + prefix + number + ".log"
+  }
+
+  /// Length, sequence number and CRC.
+  private static let overhead = 12
+}
@@ -308,6 +308,27 @@ public final class DigitalIn {
     return result
   }
 
+  /// Sets flags of an event group when the interrupt happens, so a thread
+  /// can wait for this pin together with other events.
+  /// - Parameters:
+  ///   - mode: The interrupt mode to detect rising or falling edge.
+  ///   - enable: Whether to enable the interrupt.
+  ///   - flags: The flags to set.
+  ///   - group: The event group the thread waits on.
+  /// - Returns: Whether the configuration succeeds. If it fails, it returns
+  /// the specific error.
+  @discardableResult
+  public func setInterrupt(
+    _ mode: InterruptMode,
+    enable: Bool = true,
+    post flags: UInt32,
+    to group: EventGroup
+  ) -> Result<(), Errno> {
+    return setInterrupt(mode, enable: enable) {
+      group.set(flags)
+    }
+  }
+
   /// Enables the interrupt.
   /// - Returns: Whether the configuration succeeds. If it fails, it returns
   /// the specific error.
@@ -0,0 +1,277 @@
+//=== Directory.swift -----------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The Directory class lists the entries of a directory.
+///
+/// Entries are read from the file system several at a time and filtered
+/// by name before any Swift string is made, so listing a directory of
+/// thousands of files takes a few calls and only allocates for the entries
+/// you get back.
+///
+/// ```swift
+/// let logs = try Directory("/SD:/logs", matching: "*.log")
+///
+/// while let entry = try logs.next() {
+///     print(entry.name)
+/// }
+/// ```
+///
+/// A pattern may contain `*` for any run of characters, `?` for any single
+/// character and `[a-z]` or `[!a-z]` for a set of characters.
+public final class Directory {
+  /// A file or directory found in a directory.
+  public struct Entry {
+    /// The name of the entry.
+    public let name: String
+    /// The directory of the entry followed by its name.
+    public let path: String
+    /// Whether the entry is a directory.
+    public let isDirectory: Bool
+    /// The size of a file in bytes, 0 for a directory.
+    public let size: Int
+  }
+
+  private let dirPointer: UnsafeMutableRawPointer
+  private let entries: UnsafeMutablePointer<swift_fs_dirent_t>
+  private let batchSize: Int
+  private let pattern: [CChar]?
+  private let flags: Int32
+  private var count = 0
+  private var index = 0
+  private var reachedEnd = false
+
+  /// The path of the directory.
+  public let path: String
+
+  /**
+     Opens a directory for listing.
+
+     - Parameter path: **REQUIRED** The path of the directory.
+     - Parameter pattern: **OPTIONAL** Only entries whose name matches are
+        listed, all entries if nil.
+     - Parameter batchSize: **OPTIONAL** The entries read from the file
+        system at a time. Each one takes 264 bytes of RAM. 16 by default.
+     */
+  public convenience init(_ path: String, matching pattern: String? = nil, batchSize: Int = 16)
+    throws(Errno)
+  {
+    try self.init(path, matching: pattern, batchSize: batchSize, keepDirectories: false)
+  }
+
+  init(_ path: String, matching pattern: String?, batchSize: Int, keepDirectories: Bool)
+    throws(Errno)
+  {
+    guard batchSize > 0 else {
+      throw Errno.invalidArgument
+    }
+
+    var _dirPointer: UnsafeMutableRawPointer? = nil
+    let result = nothingOrErrno(
+      swifthal_fs_opendir(&_dirPointer, FilePath(path).bytes)
+    )
+    if case .failure(let err) = result {
+      throw err
+    }
+
+    dirPointer = _dirPointer!
+    self.path = path
+    self.batchSize = batchSize
+    self.pattern = pattern.map { [CChar]($0.utf8CString) }
+    flags = keepDirectories ? SWIFT_GLOB_KEEP_DIRS : 0
+    entries = UnsafeMutablePointer<swift_fs_dirent_t>.allocate(capacity: batchSize)
+  }
+
+  deinit {
+    swifthal_fs_closedir(dirPointer)
+    entries.deallocate()
+  }
+
+  /**
+     Returns the next entry.
+     - Returns: The entry, nil when the whole directory has been listed.
+     */
+  public func next() throws(Errno) -> Entry? {
+    while index == count {
+      guard !reachedEnd else { return nil }
+      try fill()
+    }
+
+    let entry = entries + index
+    index += 1
+
+    let name = withUnsafeBytes(of: entry.pointee.name) { bytes in
+      String(cString: bytes.baseAddress!.assumingMemoryBound(to: CChar.self))
+    }
+    return Entry(
+      name: name,
+      path: Directory.join(path, name),
+      isDirectory: entry.pointee.type == SWIFT_FS_DIR_ENTRY_DIR,
+      size: entry.pointee.type == SWIFT_FS_DIR_ENTRY_DIR ? 0 : Int(entry.pointee.size))
+  }
+
+  /**
+     Creates a directory.
+     - Parameter path: **REQUIRED** The path of the new directory.
+     */
+  public static func create(_ path: String) throws(Errno) {
+    let result = nothingOrErrno(
+      swifthal_fs_mkdir(FilePath(path).bytes)
+    )
+    if case .failure(let err) = result {
+      throw err
+    }
+  }
+
+  /**
+     Looks up a file or directory.
+     - Parameter path: **REQUIRED** The path of the file or directory.
+     - Returns: Its entry.
+     */
+  public static func entry(at path: String) throws(Errno) -> Entry {
+    var dirEntry = swift_fs_dirent_t()
+    let result = nothingOrErrno(
+      swifthal_fs_stat(FilePath(path).bytes, &dirEntry)
+    )
+    if case .failure(let err) = result {
+      throw err
+    }
+
+    let name = withUnsafeBytes(of: dirEntry.name) { bytes in
+      String(cString: bytes.baseAddress!.assumingMemoryBound(to: CChar.self))
+    }
+    return Entry(
+      name: name,
+      path: path,
+      isDirectory: dirEntry.type == SWIFT_FS_DIR_ENTRY_DIR,
+      size: dirEntry.type == SWIFT_FS_DIR_ENTRY_DIR ? 0 : Int(dirEntry.size))
+  }
+
+  /**
+     Counts the files under a directory and adds up their sizes.
+     - Parameter path: **REQUIRED** The path of the directory.
+     - Parameter pattern: **OPTIONAL** Only files whose name matches are
+        counted.
+     - Parameter recursive: **OPTIONAL** Whether to include the
+        subdirectories, true by default.
+     - Returns: The count of files and their total size in bytes.
+     */
+  public static func totalSize(
+    of path: String, matching pattern: String? = nil, recursive: Bool = true
+  ) throws(Errno) -> (files: Int, bytes: Int) {
+    let walker = try DirectoryWalker(path, matching: pattern, maxDepth: recursive ? 8 : 0)
+    var files = 0
+    var bytes = 0
+
+    while let entry = try walker.next() {
+      files += 1
+      bytes += entry.size
+    }
+    return (files, bytes)
+  }
+
+  private func fill() throws(Errno) {
+    let result = valueOrErrno(
+      swifthal_fs_readdir_batch(dirPointer, entries, Int32(batchSize))
+    )
+
+    switch result {
+    case .success(let read):
+      index = 0
+      count = read
+      if read == 0 {
+        reachedEnd = true
+      } else if let pattern = pattern {
+        count = Int(swift_glob_filter(entries, Int32(read), pattern, flags))
+      }
+    case .failure(let err):
+      throw err
+    }
+  }
+
+  static func join(_ directory: String, _ name: String) -> String {
+    directory.utf8.last == UInt8(ascii: "/") ? directory + name : directory + "/" + name
+  }
+}
+
+/// The DirectoryWalker class lists the files under a directory and all its
+/// subdirectories, one at a time.
+///
+/// Only one batch of entries per directory level is kept in RAM, however
+/// many files there are.
+///
+/// ```swift
+/// let walker = try DirectoryWalker("/SD:/logs", matching: "*.csv")
+///
+/// while let file = try walker.next() {
+///     print(file.path)
+/// }
+/// ```
+public final class DirectoryWalker {
+  private var stack: [Directory] = []
+  private let pattern: String?
+  private let batchSize: Int
+
+  /// The deepest level of subdirectories entered, 0 for the root only.
+  public let maxDepth: Int
+
+  /**
+     Starts a walk.
+
+     - Parameter path: **REQUIRED** The path of the root directory.
+     - Parameter pattern: **OPTIONAL** Only files whose name matches are
+        returned. Directories are entered whatever their name.
+     - Parameter maxDepth: **OPTIONAL** The deepest level of subdirectories
+        to enter, 8 by default.
+     - Parameter batchSize: **OPTIONAL** The entries read at a time in each
+        directory, 8 by default.
+     */
+  public init(_ path: String, matching pattern: String? = nil, maxDepth: Int = 8, batchSize: Int = 8)
+    throws(Errno)
+  {
+    guard maxDepth >= 0 else {
+      throw Errno.invalidArgument
+    }
+
+    self.pattern = pattern
+    self.batchSize = batchSize
+    self.maxDepth = maxDepth
+    stack.append(
+      try Directory(path, matching: pattern, batchSize: batchSize, keepDirectories: true))
+  }
+
+  /// The current level of subdirectories, 0 in the root.
+  public var depth: Int { stack.count - 1 }
+
+  /**
+     Returns the next file.
+     - Returns: The file, nil when the whole tree has been walked.
+     */
+  public func next() throws(Errno) -> Directory.Entry? {
+    while let directory = stack.last {
+      guard let entry = try directory.next() else {
+        stack.removeLast()
+        continue
+      }
+
+      if !entry.isDirectory {
+        return entry
+      }
+      if stack.count <= maxDepth {
+        stack.append(
+          try Directory(entry.path, matching: pattern, batchSize: batchSize, keepDirectories: true))
+      }
+    }
+    return nil
+  }
+}
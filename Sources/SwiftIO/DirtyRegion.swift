@@ -0,0 +1,176 @@
+//=== DirtyRegion.swift ---------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+extension LCD {
+  /// A rectangle on the screen in pixels.
+  public struct Rect {
+    public var x: Int
+    public var y: Int
+    public var width: Int
+    public var height: Int
+
+    public init(x: Int, y: Int, width: Int, height: Int) {
+      self.x = x
+      self.y = y
+      self.width = width
+      self.height = height
+    }
+
+    /// The number of pixels inside the rectangle.
+    public var area: Int { width * height }
+
+    public var isEmpty: Bool { width <= 0 || height <= 0 }
+
+    var maxX: Int { x + width }
+    var maxY: Int { y + height }
+
+    /// The smallest rectangle that contains both rectangles.
+    public func union(_ other: Rect) -> Rect {
+      let minX = min(x, other.x)
+      let minY = min(y, other.y)
+      return Rect(x: minX, y: minY,
+                  width: max(maxX, other.maxX) - minX,
+                  height: max(maxY, other.maxY) - minY)
+    }
+
+    /// The overlapping part of both rectangles, empty if they don't overlap.
+    public func intersection(_ other: Rect) -> Rect {
+      let minX = max(x, other.x)
+      let minY = max(y, other.y)
+      return Rect(x: minX, y: minY,
+                  width: max(0, min(maxX, other.maxX) - minX),
+                  height: max(0, min(maxY, other.maxY) - minY))
+    }
+
+    /// Whether the rectangles overlap or share an edge.
+    func touches(_ other: Rect) -> Bool {
+      x <= other.maxX && other.x <= maxX && y <= other.maxY && other.y <= maxY
+    }
+  }
+
+  /// A set of changed rectangles that are merged as they are added.
+  ///
+  /// Overlapping or adjacent rectangles are merged when the bounding box
+  /// doesn't cover much more area than the two rectangles. When the number
+  /// of rectangles reaches the capacity, the new one is merged into the
+  /// rectangle that grows the least, so the region never allocates after
+  /// initialization.
+  public struct DirtyRegion {
+    /// The rectangles in the region, they may overlap slightly.
+    public private(set) var rects: [Rect] = []
+    /// The maximum number of rectangles.
+    public let capacity: Int
+    /// The bounds that every added rectangle is clipped to.
+    public let bounds: Rect
+
+    /// Initializes an empty region.
+    /// - Parameters:
+    ///   - bounds: **REQUIRED** The screen area.
+    ///   - capacity: **OPTIONAL** The maximum number of rectangles,
+    ///   16 by default.
+    public init(bounds: Rect, capacity: Int = 16) {
+      self.bounds = bounds
+      self.capacity = max(1, capacity)
+      rects.reserveCapacity(self.capacity)
+    }
+
+    public var isEmpty: Bool { rects.isEmpty }
+
+    /// The total number of pixels of all rectangles.
+    public var area: Int {
+      var total = 0
+      for rect in rects {
+        total += rect.area
+      }
+      return total
+    }
+
+    /// The smallest rectangle that contains the whole region.
+    public var boundingBox: Rect {
+      guard var box = rects.first else {
+        return Rect(x: 0, y: 0, width: 0, height: 0)
+      }
+      for rect in rects.dropFirst() {
+        box = box.union(rect)
+      }
+      return box
+    }
+
+    /// Adds a changed rectangle to the region.
+    /// - Parameter rect: The changed rectangle, clipped to the bounds.
+    public mutating func add(_ rect: Rect) {
+      var rect = rect.intersection(bounds)
+      guard !rect.isEmpty else { return }
+
+      // A merged rectangle may now touch others, keep merging until stable.
+      var index = 0
+      while index < rects.count {
+        let existing = rects[index]
+        if existing.intersection(rect).area == rect.area {
+          // Already covered.
+          return
+        }
+        if rect.touches(existing) && shouldMerge(rect, existing) {
+          rect = rect.union(existing)
+          rects.remove(at: index)
+          index = 0
+          continue
+        }
+        index += 1
+      }
+
+      if rects.count < capacity {
+        rects.append(rect)
+        return
+      }
+
+      var best = 0
+      var bestGrowth = Int.max
+      for (i, existing) in rects.enumerated() {
+        let growth = existing.union(rect).area - existing.area
+        if growth < bestGrowth {
+          best = i
+          bestGrowth = growth
+        }
+      }
+      let merged = rects[best].union(rect)
+      rects.remove(at: best)
+      add(merged)
+    }
+
+    /// Adds all rectangles of another region.
+    public mutating func formUnion(_ other: DirtyRegion) {
+      for rect in other.rects {
+        add(rect)
+      }
+    }
+
+    /// Adds the whole bounds to the region.
+    public mutating func addAll() {
+      rects.removeAll(keepingCapacity: true)
+      rects.append(bounds)
+    }
+
+    /// Removes all rectangles.
+    public mutating func removeAll() {
+      rects.removeAll(keepingCapacity: true)
+    }
+
+    /// Merging is worthwhile when the bounding box wastes less than a
+    /// quarter of its area.
+    private func shouldMerge(_ a: Rect, _ b: Rect) -> Bool {
+      let covered = a.area + b.area - a.intersection(b).area
+      let box = a.union(b).area
+      return (box - covered) * 4 <= box
+    }
+  }
+}
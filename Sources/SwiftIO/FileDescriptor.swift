@@ -47,13 +47,17 @@ The FileDescriptor struct is used to perform low-level file operations.
 
 public struct FileDescriptor {
 
-  private let dirEntry: swift_fs_dirent_t
+  private let state: State
   private let filePointer: UnsafeMutableRawPointer
 
   private let filePath: FilePath
 
   /// Size of the file.
-  public var size: Int { Int(dirEntry.size) }
+  ///
+  /// It's read when the file is opened and kept up to date by the writes,
+  /// seeks and truncates made through this descriptor and its copies,
+  /// without asking the file system again.
+  public var size: Int { state.size }
 
   /**
      Open or creates, if does not exist, file.
@@ -76,30 +80,54 @@ public struct FileDescriptor {
     var _filePointer: UnsafeMutableRawPointer? = nil
     let flags: UInt8 = mode.rawValue | options.rawValue
 
-    var result = nothingOrErrno(
-      swifthal_fs_stat(_filePath.bytes, &_dirEntry)
+    // The path is resolved once, the entry comes with the open.
+    let result = nothingOrErrno(
+      swifthal_fs_open_ex(&_filePointer, _filePath.bytes, flags, &_dirEntry)
     )
+
     switch result {
     case .success:
       if _dirEntry.type == SWIFT_FS_DIR_ENTRY_DIR {
+        swifthal_fs_close(_filePointer)
         throw Errno.notSupported
       }
     case .failure(let err):
-      if err == Errno.noSuchFileOrDirectory && (options.contains(.append) || options.contains(.create)) {
-        break
+      if err == Errno.isDirectory {
+        throw Errno.notSupported
       }
       throw err
     }
 
-    result = nothingOrErrno(
-      swifthal_fs_open(&_filePointer, _filePath.bytes, flags)
-    )
+    let state = State(size: Int(_dirEntry.size), append: options.contains(.append))
+    return FileDescriptor(state: state, filePointer: _filePointer!, filePath: _filePath)
+  }
 
+  /**
+     Deletes a file or an empty directory.
+     - Parameter path: **REQUIRED** The location of the file to delete.
+     */
+  public static func remove(_ path: String) throws(Errno) {
+    let result = nothingOrErrno(
+      swifthal_fs_remove(FilePath(path).bytes)
+    )
     if case .failure(let err) = result {
       throw err
     }
+  }
 
-    return FileDescriptor(dirEntry: _dirEntry, filePointer: _filePointer!, filePath: _filePath)
+  /**
+     Renames or moves a file or directory.
+     - Parameter path: **REQUIRED** The current location.
+     - Parameter newPath: **REQUIRED** The new location, which must not exist.
+     */
+  public static func rename(_ path: String, to newPath: String) throws(Errno) {
+    var to = FilePath(newPath).bytes
+    let result = nothingOrErrno(
+      swifthal_fs_rename(FilePath(path).bytes, &to)
+    )
+    if case .failure(let err) = result {
+      throw err
+    }
   }
 
   /**
@@ -158,7 +186,7 @@ public struct FileDescriptor {
 
     switch readResult {
     case .success(let value):
-      return value
+      return state.didRead(value)
     case .failure(let err):
       throw err
     }
@@ -166,6 +194,9 @@ public struct FileDescriptor {
 
   /**
      Reads bytes at the specified offset into a buffer.
+
+     The file offset is not changed, so threads sharing the file may read
+     at different offsets without a lock.
      - Parameter offset: **REQUIRED** The file offset where reading begins.
      - Parameter buffer: **REQUIRED** Te region of memory to read into.
      - Parameter count: **OPTIONAL** The bytes you want to read.
@@ -183,15 +214,8 @@ public struct FileDescriptor {
     } else {
       length = buffer.count
     }
-    let seekResult = nothingOrErrno(
-      swifthal_fs_seek(filePointer, offset, SeekOrigin.start.rawValue)
-    )
-    if case .failure(let err) = seekResult {
-      throw err
-    }
-
     let readResult = valueOrErrno(
-      swifthal_fs_read(filePointer, buffer.baseAddress!, length)
+      swifthal_fs_pread(filePointer, buffer.baseAddress!, length, offset)
     )
 
     switch readResult {
@@ -227,7 +251,7 @@ public struct FileDescriptor {
     }
     switch readResult {
     case .success(let value):
-      return value
+      return state.didRead(value)
     case .failure(let err):
       throw err
     }
@@ -235,6 +259,9 @@ public struct FileDescriptor {
 
   /**
      Reads bytes at the specified offset into a buffer.
+
+     The file offset is not changed, so threads sharing the file may read
+     at different offsets without a lock.
      - Parameter offset: **REQUIRED** The file offset where reading begins.
      - Parameter buffer: **REQUIRED** Te region of memory to read into.
      - Parameter count: **OPTIONAL** The bytes you want to read.
@@ -253,17 +280,10 @@ public struct FileDescriptor {
     } else {
       length = buffer.count
     }
-    let seekResult = nothingOrErrno(
-      swifthal_fs_seek(filePointer, offset, SeekOrigin.start.rawValue)
-    )
-    if case .failure(let err) = seekResult {
-      throw err
-    }
-
     var readResult: Result<Int, Errno> = .success(0)
     buffer.withUnsafeMutableBytes { bufferPointer in
       readResult = valueOrErrno(
-        swifthal_fs_read(filePointer, bufferPointer.baseAddress, length)
+        swifthal_fs_pread(filePointer, bufferPointer.baseAddress, length, offset)
       )
     }
     switch readResult {
@@ -287,13 +307,65 @@ public struct FileDescriptor {
       swifthal_fs_seek(filePointer, offset, whence.rawValue)
     )
     switch seekResult {
-    case .success(let value):
-      return value
+    case .success:
+      return state.didSeek(offset, from: whence)
     case .failure(let err):
       throw err
     }
   }
 
+  /**
+     Changes the size of the file.
+
+     If the file grows, the new bytes are zero. The file offset is not
+     changed.
+     - Parameter length: **REQUIRED** The new size of the file in bytes.
+     - Throws: `Errno.noSpace` if the file couldn't grow to the whole
+        length, it then keeps the size it reached.
+     */
+  public func truncate(to length: Int) throws(Errno) {
+    let result = nothingOrErrno(
+      swifthal_fs_truncate(filePointer, length)
+    )
+    if case .failure(let err) = result {
+      throw err
+    }
+    guard length > state.size else {
+      state.size = length
+      return
+    }
+
+    // Growing may stop short on a full volume and still succeed, so the
+    // size reached is read back from the end of the file.
+    var sizeResult = nothingOrErrno(
+      swifthal_fs_seek(filePointer, 0, SWIFT_FS_SEEK_END)
+    )
+    var size = 0
+    if case .success = sizeResult {
+      let tellResult = valueOrErrno(swifthal_fs_tell(filePointer))
+      switch tellResult {
+      case .success(let value):
+        size = value
+      case .failure(let err):
+        sizeResult = .failure(err)
+      }
+    }
+    let restoreResult = nothingOrErrno(
+      swifthal_fs_seek(filePointer, state.position, SWIFT_FS_SEEK_SET)
+    )
+    if case .failure(let err) = sizeResult {
+      throw err
+    }
+    if case .failure(let err) = restoreResult {
+      throw err
+    }
+
+    state.size = size
+    if size < length {
+      throw Errno.noSpace
+    }
+  }
+
   /**
      Writes the contents of a string at the current file offset.
       - Parameter string: **REQUIRED** The string being written.
@@ -313,7 +385,7 @@ public struct FileDescriptor {
     }
     switch writeResult {
     case .success(let value):
-      return value
+      return state.didWrite(value)
     case .failure(let err):
       throw err
     }
@@ -343,7 +415,7 @@ public struct FileDescriptor {
 
     switch writeResult {
     case .success(let value):
-      return value
+      return state.didWrite(value)
     case .failure(let err):
       throw err
     }
@@ -351,6 +423,8 @@ public struct FileDescriptor {
 
   /**
      Writes the contents of a buffer at the specified offset.
+
+     The file offset is not changed.
       - Parameter offset: **REQUIRED** The file offset where writing begins.
       - Parameter buffer: **REQUIRED** Te region of memory that contains the
         data being written.
@@ -371,19 +445,12 @@ public struct FileDescriptor {
       length = buffer.count
     }
 
-    let seekResult = nothingOrErrno(
-      swifthal_fs_seek(filePointer, offset, SeekOrigin.start.rawValue)
-    )
-    if case .failure(let err) = seekResult {
-      throw err
-    }
-
     let writeResult = valueOrErrno(
-      swifthal_fs_write(filePointer, buffer.baseAddress!, length)
+      swifthal_fs_pwrite(filePointer, buffer.baseAddress!, length, offset)
     )
     switch writeResult {
     case .success(let value):
-      return value
+      return state.didWrite(value, at: offset)
     case .failure(let err):
       throw err
     }
@@ -416,7 +483,7 @@ public struct FileDescriptor {
 
     switch writeResult {
     case .success(let value):
-      return value
+      return state.didWrite(value)
     case .failure(let err):
       throw err
     }
@@ -424,6 +491,8 @@ public struct FileDescriptor {
 
   /**
      Writes the contents of a buffer at the specified offset.
+
+     The file offset is not changed.
       - Parameter offset: **REQUIRED** The file offset where writing begins.
       - Parameter buffer: **REQUIRED** Te region of memory that contains the
         data being written.
@@ -444,23 +513,67 @@ public struct FileDescriptor {
       length = buffer.count
     }
 
-    let seekResult = nothingOrErrno(
-      swifthal_fs_seek(filePointer, offset, SeekOrigin.start.rawValue)
-    )
-    if case .failure(let err) = seekResult {
-      throw err
-    }
-
     var writeResult: Result<Int, Errno> = .success(0)
     buffer.withUnsafeBytes { bufferPointer in
       writeResult = valueOrErrno(
-        swifthal_fs_write(filePointer, bufferPointer.baseAddress, length)
+        swifthal_fs_pwrite(filePointer, bufferPointer.baseAddress, length, offset)
       )
     }
 
     switch writeResult {
     case .success(let value):
-      return value
+      return state.didWrite(value, at: offset)
+    case .failure(let err):
+      throw err
+    }
+  }
+
+  /**
+     Reads bytes at the current file offset into several buffers in one
+     call, filling each buffer before moving to the next.
+     - Parameter buffers: **REQUIRED** The regions of memory to read into.
+
+     - Returns: The total bytes successfully read.
+     */
+  @discardableResult
+  public func read(into buffers: [UnsafeMutableRawBufferPointer]) throws(Errno) -> Int {
+    let vectors = buffers.map {
+      swift_fs_iovec_t(base: $0.baseAddress, len: $0.count)
+    }
+
+    let readResult = valueOrErrno(
+      swifthal_fs_readv(filePointer, vectors, Int32(vectors.count))
+    )
+
+    switch readResult {
+    case .success(let value):
+      return state.didRead(value)
+    case .failure(let err):
+      throw err
+    }
+  }
+
+  /**
+     Writes the contents of several buffers at the current file offset in
+     one call, for example a record header, its payload and its checksum.
+      - Parameter buffers: **REQUIRED** The regions of memory that contain
+        the data being written.
+
+     - Returns: The total number of bytes that were written.
+     */
+  @discardableResult
+  public func write(_ buffers: [UnsafeRawBufferPointer]) throws(Errno) -> Int {
+    let vectors = buffers.map {
+      swift_fs_iovec_t(base: UnsafeMutableRawPointer(mutating: $0.baseAddress), len: $0.count)
+    }
+
+    let writeResult = valueOrErrno(
+      swifthal_fs_writev(filePointer, vectors, Int32(vectors.count))
+    )
+
+    switch writeResult {
+    case .success(let value):
+      return state.didWrite(value)
     case .failure(let err):
       throw err
     }
@@ -485,6 +598,52 @@ public struct FileDescriptor {
   }
 }
 
+extension FileDescriptor {
+  /// The size and offset shared by all copies of a descriptor, so they
+  /// stay correct without asking the file system.
+  private final class State {
+    var size: Int
+    var position = 0
+    let append: Bool
+
+    init(size: Int, append: Bool) {
+      self.size = size
+      self.append = append
+    }
+
+    func didRead(_ count: Int) -> Int {
+      position += count
+      return count
+    }
+
+    func didWrite(_ count: Int) -> Int {
+      if append {
+        position = size
+      }
+      position += count
+      size = max(size, position)
+      return count
+    }
+
+    func didWrite(_ count: Int, at offset: Int) -> Int {
+      size = max(size, offset + count)
+      return count
+    }
+
+    func didSeek(_ offset: Int, from whence: SeekOrigin) -> Int {
+      switch whence.rawValue {
+      case SWIFT_FS_SEEK_CUR:
+        position += offset
+      case SWIFT_FS_SEEK_END:
+        position = size + offset
+      default:
+        position = offset
+      }
+      return position
+    }
+  }
+}
+
 /// A null-terminated sequence of bytes that represents a location in the file system.
 struct FilePath {
   internal var bytes: [CChar]
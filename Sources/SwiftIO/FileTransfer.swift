@@ -0,0 +1,255 @@
+//=== FileTransfer.swift --------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The FileTransfer class sends a range of a file to a UART, SPI or I2S
+/// bus without copying it through Swift arrays.
+///
+/// The file is read straight into a small pool of aligned buffers, and
+/// the buffers are written to the bus from where they are. While one
+/// buffer is being written, the next ones are already being read by an
+/// ``AsyncFileService`` on a worker thread, so the card and the bus work at
+/// the same time instead of taking turns.
+///
+/// ```swift
+/// let transfer = FileTransfer(bufferSize: 4096, bufferCount: 3)
+/// let file = try FileDescriptor.open("/SD:/firmware.bin", .readOnly)
+///
+/// try transfer.send(file, to: uart)
+/// print(transfer.lastThroughput)
+/// ```
+public final class FileTransfer {
+  private let service: AsyncFileService
+  private let pool: UnsafeMutableRawBufferPointer
+  private var requests: [AsyncFileService.Request?]
+
+  /// The size of each buffer in bytes, a multiple of 512.
+  public let bufferSize: Int
+  /// The count of buffers, reads run up to `bufferCount - 1` ahead.
+  public let bufferCount: Int
+
+  /// The count of bytes sent.
+  public private(set) var bytesSent = 0
+  /// The total time in milliseconds spent in transfers.
+  public private(set) var transferTime: Int64 = 0
+  /// The total time in milliseconds the bus waited for the card. Close to
+  /// ``transferTime`` if the card is the bottleneck, close to 0 if the bus
+  /// is.
+  public private(set) var readWaitTime: Int64 = 0
+  /// The bytes per second of the last transfer.
+  public private(set) var lastThroughput = 0
+
+  /**
+     Creates a transfer with its buffer pool.
+
+     - Parameter bufferSize: **OPTIONAL** The size of each buffer, rounded
+        up to a multiple of 512. 4096 by default.
+     - Parameter bufferCount: **OPTIONAL** The count of buffers, at least
+        2. 2 by default.
+     - Parameter service: **OPTIONAL** The service that reads the file. If
+        nil, all such transfers share one service, started by the first.
+     */
+  public init(bufferSize: Int = 4096, bufferCount: Int = 2, service: AsyncFileService? = nil) {
+    guard bufferSize > 0 && bufferCount >= 2 else {
+      print("error: FileTransfer bufferSize must > 0 and bufferCount must >= 2")
+      fatalError()
+    }
+
+    let size = (bufferSize + FileTransfer.sectorSize - 1) & ~(FileTransfer.sectorSize - 1)
+
+    self.bufferSize = size
+    self.bufferCount = bufferCount
+    self.service = service ?? FileTransfer.sharedService
+    requests = [AsyncFileService.Request?](repeating: nil, count: bufferCount)
+    pool = UnsafeMutableRawBufferPointer.allocate(byteCount: size * bufferCount, alignment: 32)
+  }
+
+  deinit {
+    // Reads still queued write into the pool.
+    for request in requests {
+      request?.wait()
+    }
+    pool.deallocate()
+  }
+
+  /// The mean bytes per second of all transfers.
+  public var averageThroughput: Int {
+    transferTime > 0 ? Int(Int64(bytesSent) * 1000 / transferTime) : 0
+  }
+
+  /**
+     Sends a range of a file through a UART.
+     - Parameter file: **REQUIRED** A file opened for reading.
+     - Parameter uart: **REQUIRED** The UART to write to.
+     - Parameter offset: **OPTIONAL** The file offset of the first byte, 0 by
+        default.
+     - Parameter count: **OPTIONAL** The bytes to send, up to the end of the
+        file if nil.
+     - Returns: The bytes sent, less than count only at the end of the file.
+     */
+  @discardableResult
+  public func send(_ file: FileDescriptor, to uart: UART, offset: Int = 0, count: Int? = nil)
+    throws(Errno) -> Int
+  {
+    try transfer(file, offset: offset, count: count) { data in
+      uart.write(data)
+    }
+  }
+
+  /**
+     Sends a range of a file through an SPI bus.
+     - Parameter file: **REQUIRED** A file opened for reading.
+     - Parameter spi: **REQUIRED** The SPI bus to write to.
+     - Parameter offset: **OPTIONAL** The file offset of the first byte, 0 by
+        default.
+     - Parameter count: **OPTIONAL** The bytes to send, up to the end of the
+        file if nil.
+     - Returns: The bytes sent, less than count only at the end of the file.
+     */
+  @discardableResult
+  public func send(_ file: FileDescriptor, to spi: SPI, offset: Int = 0, count: Int? = nil)
+    throws(Errno) -> Int
+  {
+    try transfer(file, offset: offset, count: count) { data in
+      spi.write(data)
+    }
+  }
+
+  /**
+     Sends a range of a file through I2S, for example the audio data of a
+     WAV file already in the format the bus is configured for.
+     - Parameter file: **REQUIRED** A file opened for reading.
+     - Parameter i2s: **REQUIRED** The I2S bus to write to.
+     - Parameter offset: **OPTIONAL** The file offset of the first byte, 0 by
+        default.
+     - Parameter count: **OPTIONAL** The bytes to send, up to the end of the
+        file if nil.
+     - Returns: The bytes sent, less than count only at the end of the file.
+     */
+  @discardableResult
+  public func send(_ file: FileDescriptor, to i2s: I2S, offset: Int = 0, count: Int? = nil)
+    throws(Errno) -> Int
+  {
+    try transfer(file, offset: offset, count: count) { data in
+      i2s.writeAll(data)
+    }
+  }
+
+  /// Clears the statistics.
+  public func resetStatistics() {
+    bytesSent = 0
+    transferTime = 0
+    readWaitTime = 0
+    lastThroughput = 0
+  }
+
+  private func transfer(
+    _ file: FileDescriptor,
+    offset: Int,
+    count: Int?,
+    _ write: (UnsafeRawBufferPointer) -> Result<(), Errno>
+  ) throws(Errno) -> Int {
+    guard offset >= 0 else {
+      throw Errno.invalidArgument
+    }
+
+    let end = count.map { offset + $0 } ?? file.size
+    let start = getSystemUptimeInMilliseconds()
+    var readOffset = offset
+    var sent = 0
+    var slot = 0
+
+    defer {
+      let time = getSystemUptimeInMilliseconds() - start
+      transferTime += time
+      bytesSent += sent
+      lastThroughput = time > 0 ? Int(Int64(sent) * 1000 / time) : 0
+    }
+
+    // Queue a read into every buffer, the oldest is written first.
+    for index in 0..<bufferCount where readOffset < end {
+      try read(file, into: index, at: &readOffset, end: end)
+    }
+
+    while let request = requests[slot] {
+      let waitStart = getSystemUptimeInMilliseconds()
+      let result = request.wait()
+      readWaitTime += getSystemUptimeInMilliseconds() - waitStart
+      requests[slot] = nil
+
+      let length: Int
+      switch result {
+      case .success(let value):
+        length = value
+      case .failure(let err):
+        cancel()
+        throw err
+      }
+      if length == 0 {
+        break
+      }
+
+      if case .failure(let err) = write(buffer(slot, count: length)) {
+        cancel()
+        throw err
+      }
+      sent += length
+
+      if readOffset < end {
+        try read(file, into: slot, at: &readOffset, end: end)
+      }
+      slot = (slot + 1) % bufferCount
+    }
+
+    cancel()
+    return sent
+  }
+
+  /// Queues a read into a buffer. If it can't be queued, the reads already
+  /// queued are waited for before the error is thrown, so the next
+  /// transfer never reuses a buffer still being read into.
+  private func read(_ file: FileDescriptor, into slot: Int, at offset: inout Int, end: Int)
+    throws(Errno)
+  {
+    let length = min(bufferSize, end - offset)
+    do throws(Errno) {
+      requests[slot] = try service.read(
+        file,
+        into: UnsafeMutableRawBufferPointer(
+          start: pool.baseAddress! + slot * bufferSize, count: length),
+        offset: offset)
+    } catch {
+      cancel()
+      throw error
+    }
+    offset += length
+  }
+
+  /// Waits for the reads still queued so the buffers are free again.
+  private func cancel() {
+    for index in 0..<bufferCount {
+      requests[index]?.wait()
+      requests[index] = nil
+    }
+  }
+
+  private func buffer(_ slot: Int, count: Int) -> UnsafeRawBufferPointer {
+    UnsafeRawBufferPointer(start: pool.baseAddress! + slot * bufferSize, count: count)
+  }
+
+  /// The service of the transfers created without one, its worker is
+  /// started on first use.
+  private static let sharedService = AsyncFileService()
+
+  private static let sectorSize = 512
+}
@@ -28,6 +28,12 @@ public final class I2S {
 
   private var config = swift_i2s_cfg_t()
 
+  /// Scratch block used by the converting write methods, allocated on first use.
+  private var convertBuffer: UnsafeMutableRawBufferPointer?
+  /// Guards ``convertBuffer``, held for a whole converting write so blocks
+  /// of two threads never mix.
+  private let convertLock = Mutex()
+
   private var mode: Mode {
     willSet {
       switch newValue {
@@ -50,7 +56,8 @@ public final class I2S {
     }
   }
 
-  private var sampleBits: Int {
+  /// The current sample bits of the audio data.
+  public private(set) var sampleBits: Int {
     get {
       Int(config.sample_bits)
     }
@@ -59,7 +66,8 @@ public final class I2S {
     }
   }
 
-  private var sampleRate: Int {
+  /// The current sample rate of the audio data.
+  public private(set) var sampleRate: Int {
     get {
       Int(config.sample_rate)
     }
@@ -167,6 +175,8 @@ public final class I2S {
 
   deinit {
     swifthal_i2s_close(obj)
+    convertBuffer?.deallocate()
+    convertLock.destroy()
   }
 
   /// Set audio sample rate and bit.
@@ -271,6 +281,146 @@ public final class I2S {
 
     return writeResult
   }
+
+  /// Write 16-bit audio samples to audio device, converting them on the fly.
+  ///
+  /// The samples are scaled by `gain`, duplicated into both channels if the
+  /// source is mono and widened or narrowed to the current sample bits. The
+  /// conversion runs in small fixed-size blocks, so no intermediate array
+  /// of the whole audio is created. Calls from several threads are
+  /// serialized, each one sends all its samples before the next starts.
+  ///
+  /// ```swift
+  /// // Play 16-bit mono audio at half volume on a 24-bit I2S bus.
+  /// let i2s = I2S(Id.I2S0, rate: 16_000, bits: 24)
+  /// i2s.write(samples, channels: 1, gain: 0.5)
+  /// ```
+  /// - Parameters:
+  ///   - data: The audio samples. Stereo samples are interleaved.
+  ///   - count: The count of samples to be sent. If nil, it equals the count
+  ///   of elements in `data`.
+  ///   - channels: The number of channels in `data`, 1 or 2.
+  ///   - gain: **OPTIONAL** The volume applied to the samples, between
+  ///   0.0 and 1.0. 1.0 by default which leaves the samples unchanged.
+  /// - Returns: The count of samples in `data` that were sent.
+  @discardableResult
+  public func write(
+    _ data: [Int16],
+    count: Int? = nil,
+    channels: Int,
+    gain: Float = 1.0
+  ) -> Result<Int, Errno> {
+    var writeLength = 0
+    let validateResult = validateLength(data, count: count, length: &writeLength)
+
+    guard case .success = validateResult else {
+      return .failure(Errno.invalidArgument)
+    }
+
+    return data.withUnsafeBufferPointer { pointer in
+      write(
+        UnsafeBufferPointer(rebasing: pointer[0..<writeLength / MemoryLayout<Int16>.stride]),
+        channels: channels,
+        gain: gain
+      )
+    }
+  }
+
+  /// Write 16-bit audio samples stored in a buffer pointer to audio device,
+  /// converting them on the fly.
+  ///
+  /// See ``write(_:count:channels:gain:)`` for details about the conversion.
+  /// - Parameters:
+  ///   - data: The audio samples. Stereo samples are interleaved.
+  ///   - channels: The number of channels in `data`, 1 or 2.
+  ///   - gain: **OPTIONAL** The volume applied to the samples, between
+  ///   0.0 and 1.0. 1.0 by default which leaves the samples unchanged.
+  /// - Returns: The count of samples in `data` that were sent.
+  @discardableResult
+  public func write(
+    _ data: UnsafeBufferPointer<Int16>,
+    channels: Int,
+    gain: Float = 1.0
+  ) -> Result<Int, Errno> {
+    guard channels == 1 || channels == 2, data.count % channels == 0 else {
+      return .failure(Errno.invalidArgument)
+    }
+    guard let source = data.baseAddress else {
+      return .success(0)
+    }
+
+    convertLock.lock()
+    defer { convertLock.unlock() }
+
+    let buffer = getConvertBuffer()
+    let frameBytes = 2 * (sampleBits <= 16 ? sampleBits / 8 : 4)
+    let blockFrames = buffer.count / frameBytes
+    let totalFrames = data.count / channels
+    let gainQ15 = Int32((min(max(gain, 0.0), 1.0) * Float(SWIFT_AUDIO_GAIN_Q15_UNITY)).rounded())
+
+    var frames = 0
+    var writeResult: Result<Int, Errno> = .success(0)
+
+    while frames < totalFrames {
+      let blockCount = min(blockFrames, totalFrames - frames)
+      let length = swift_audio_s16_to_i2s(
+        buffer.baseAddress, Int32(sampleBits),
+        source + frames * channels, Int32(channels),
+        blockCount, gainQ15)
+
+      if length < 0 {
+        writeResult = .failure(Errno(length))
+        break
+      }
+
+      // The driver may take part of the block, the rest is written again.
+      let blockResult = writeAll(UnsafeRawBufferPointer(start: buffer.baseAddress, count: Int(length)))
+      if case .failure(let err) = blockResult {
+        writeResult = .failure(err)
+        break
+      }
+      frames += blockCount
+    }
+
+    if case .failure(let err) = writeResult {
+      //print("error: \(self).\(#function) line \(#line) -> " + String(describing: err))
+      let errDescription = err.description
+      print("error: \(self).\(#function) line \(#line) -> " + errDescription)
+      return .failure(err)
+    }
+
+    return .success(frames * channels)
+  }
+
+  /// Writes all the bytes of a buffer, the driver may take fewer than
+  /// given at a time.
+  func writeAll(_ data: UnsafeRawBufferPointer) -> Result<(), Errno> {
+    guard let base = data.baseAddress else { return .success(()) }
+    var written = 0
+
+    while written < data.count {
+      let ret = swifthal_i2s_write(obj, base + written, data.count - written)
+      if ret < 0 {
+        return .failure(Errno(ret))
+      }
+      // A write that takes nothing would spin forever.
+      if ret == 0 {
+        return .failure(Errno.ioError)
+      }
+      written += Int(ret)
+    }
+    return .success(())
+  }
+
+  private func getConvertBuffer() -> UnsafeMutableRawBufferPointer {
+    if let buffer = convertBuffer {
+      return buffer
+    }
+    // 256 stereo frames of 32-bit samples.
+    let buffer = UnsafeMutableRawBufferPointer.allocate(byteCount: 2048, alignment: 4)
+    convertBuffer = buffer
+    return buffer
+  }
 }
 
 extension I2S {
@@ -0,0 +1,180 @@
+//=== ImageDecoder.swift --------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The ImageDecoder class streams a QOI image from a file and decodes it
+/// straight into a framebuffer.
+///
+/// QOI is a lossless format that decodes several times faster than PNG
+/// and is usually 3 to 4 times smaller than raw RGB565, so much less data
+/// is read from the SD card. The file is read in small chunks, no buffer
+/// of the whole image is needed. Most image tools can produce QOI files,
+/// for example `magick input.png output.qoi` with ImageMagick.
+///
+/// ```swift
+/// let file = try FileDescriptor.open("/SD:/background.qoi", .readOnly)
+/// let image = try ImageDecoder(file)
+///
+/// try image.draw(on: lcd, x: 0, y: 0)
+/// lcd.present()
+/// ```
+///
+/// The image may be partly off the screen, only the visible part is
+/// stored. Fully transparent pixels are skipped.
+public final class ImageDecoder {
+  private let file: FileDescriptor
+  private let chunk: UnsafeMutableRawBufferPointer
+  private var decoder = swift_qoi_decoder_t()
+
+  /// The width of the image in pixels.
+  public let width: Int
+  /// The height of the image in pixels.
+  public let height: Int
+  /// Whether the image has an alpha channel.
+  public let hasAlpha: Bool
+
+  /// The total time in nanoseconds spent decoding, file reads excluded.
+  public private(set) var decodeTime: Int64 = 0
+  /// The total time in nanoseconds spent reading the file.
+  public private(set) var readTime: Int64 = 0
+  /// The count of compressed bytes read from the file.
+  public private(set) var readBytes = 0
+
+  /**
+     Opens a QOI image for decoding.
+
+     - Parameter file: **REQUIRED** A QOI file opened for reading.
+     - Parameter chunkSize: **OPTIONAL** The bytes read from the file at a
+        time, 4096 by default. A multiple of the sector size reads fastest.
+     */
+  public init(_ file: FileDescriptor, chunkSize: Int = 4096) throws(Errno) {
+    guard chunkSize >= 64 else {
+      throw Errno.invalidArgument
+    }
+
+    var header = [UInt8](repeating: 0, count: Int(SWIFT_QOI_HEADER_SIZE))
+    guard try file.read(fromAbsoluteOffest: 0, into: &header) == header.count else {
+      throw Errno.invalidArgument
+    }
+
+    var width: UInt32 = 0
+    var height: UInt32 = 0
+    var channels: Int32 = 0
+    let result = nothingOrErrno(
+      swift_qoi_parse_header(header, &width, &height, &channels)
+    )
+    if case .failure(let err) = result {
+      throw err
+    }
+
+    self.file = file
+    self.width = Int(width)
+    self.height = Int(height)
+    self.hasAlpha = channels == 4
+    chunk = UnsafeMutableRawBufferPointer.allocate(byteCount: chunkSize, alignment: 32)
+  }
+
+  deinit {
+    chunk.deallocate()
+  }
+
+  /**
+     Decodes the image into the back buffer of an LCD and invalidates the
+     area it covers.
+
+     - Parameter lcd: **REQUIRED** The LCD to draw on.
+     - Parameter x: **OPTIONAL** The screen column of the image left.
+     - Parameter y: **OPTIONAL** The screen row of the image top.
+     */
+  public func draw(on lcd: LCD, x: Int = 0, y: Int = 0) throws(Errno) {
+    try decode(
+      into: lcd.backBuffer, format: lcd.pixelFormat, width: lcd.width, height: lcd.height,
+      pitch: lcd.pitch, x: x, y: y)
+    lcd.invalidate(x: x, y: y, width: width, height: height)
+  }
+
+  /**
+     Decodes the image into a framebuffer.
+
+     - Parameter buffer: **REQUIRED** The framebuffer.
+     - Parameter format: **REQUIRED** The pixel format of the framebuffer,
+        `.rgb565`, `.rgb888` or `.argb8888`.
+     - Parameter width: **REQUIRED** The width of the framebuffer in pixels.
+     - Parameter height: **REQUIRED** The height of the framebuffer in pixels.
+     - Parameter pitch: **OPTIONAL** The bytes between two rows of the
+        framebuffer.
+     - Parameter x: **OPTIONAL** The framebuffer column of the image left.
+     - Parameter y: **OPTIONAL** The framebuffer row of the image top.
+     */
+  public func decode(
+    into buffer: UnsafeMutableRawBufferPointer,
+    format: LCD.PixelFormat,
+    width: Int,
+    height: Int,
+    pitch: Int? = nil,
+    x: Int = 0,
+    y: Int = 0
+  ) throws(Errno) {
+    let rawFormat = LCD.getPixelFormatRawValue(format)
+    let pitch = pitch ?? width * Int(swift_raster_bpp(rawFormat))
+    guard let base = buffer.baseAddress, buffer.count >= pitch * height else {
+      throw Errno.invalidArgument
+    }
+
+    let initResult = nothingOrErrno(
+      swift_qoi_decoder_init(
+        &decoder, UInt32(self.width), UInt32(self.height), base, Int32(pitch),
+        Int32(width), Int32(height), rawFormat, Int32(x), Int32(y))
+    )
+    if case .failure(let err) = initResult {
+      throw err
+    }
+
+    try file.seek(offset: Int(SWIFT_QOI_HEADER_SIZE))
+
+    let src = chunk.baseAddress!
+    var pending = 0
+
+    while swift_qoi_decode_done(&decoder) == 0 {
+      var start = getClockCycle()
+      let read = try file.read(
+        into: UnsafeMutableRawBufferPointer(start: src + pending, count: chunk.count - pending))
+      readTime += cyclesToNanoseconds(start: start, stop: getClockCycle())
+      readBytes += read
+
+      if read == 0 {
+        // Truncated file, keep what has been drawn.
+        throw Errno.ioError
+      }
+
+      let available = pending + read
+      start = getClockCycle()
+      let consumed = swift_qoi_decode(
+        &decoder, src.assumingMemoryBound(to: UInt8.self), available)
+      decodeTime += cyclesToNanoseconds(start: start, stop: getClockCycle())
+
+      // An op split across chunks is at most 4 bytes, move it to the front.
+      pending = available - consumed
+      if pending > 0 {
+        src.copyMemory(from: src + consumed, byteCount: pending)
+      }
+    }
+  }
+
+  /// Clears the decode statistics.
+  public func resetStatistics() {
+    decodeTime = 0
+    readTime = 0
+    readBytes = 0
+  }
+}
@@ -0,0 +1,500 @@
+//=== KeyValueStore.swift -------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The KeyValueStore class keeps small settings in a file that survives
+/// power loss at any moment.
+///
+/// Every change is appended to the file as a record with a CRC-32 and
+/// synced before the call returns. When the store is opened, the file is
+/// replayed into a hash table in RAM, so lookups never touch the card. A
+/// change cut short by a power loss fails its CRC and is ignored, leaving
+/// the previous value. Changes made together with
+/// ``set(_:)`` are applied all or none.
+///
+/// As values are replaced the file grows with stale records.
+/// ``compact()`` writes the live values to a new file and renames it over
+/// the old one. Most of the work runs without holding the store, so
+/// changes go on meanwhile; they are carried over to the new file at the
+/// end. Given a ``WorkerPool``, the store queues a compaction on it once
+/// the stale records outweigh the live ones. Otherwise check
+/// ``needsCompaction`` and call ``compact()`` from a low priority thread.
+/// The store is safe to use from several threads.
+///
+/// ```swift
+/// let config = try KeyValueStore("/SD:/config.kv", compactionPool: pool)
+///
+/// try config.set("ssid", forKey: "wifi.ssid")
+/// let ssid = config.string(forKey: "wifi.ssid")
+/// ```
+///
+/// A record on the file is laid out as follows, all little endian:
+///
+/// | Bytes | Content                                                      |
+/// | ----- | ------------------------------------------------------------ |
+/// | 1     | 1 to set, 2 to remove, 0x80 set if the batch continues       |
+/// | 1     | Key length                                                   |
+/// | 2     | Value length, 0 to remove                                    |
+/// | 4     | CRC-32 of the key and value, seeded with the first 4 bytes   |
+/// | n     | Key in UTF-8, then the value                                 |
+public final class KeyValueStore {
+  private let path: String
+  private let temporaryPath: String
+  private let lock = Mutex()
+  /// Held for the whole of a compaction, only one runs at a time.
+  private let compactionLock = Mutex()
+  private let compactionPool: WorkerPool?
+  /// Nil after a failed reopen, opened again by the next change.
+  private var file: FileDescriptor?
+  private var values: [String: [UInt8]]
+  private var fileSize = 0
+  private var liveSize = 0
+  /// The keys changed while a compaction writes its snapshot.
+  private var changedKeys: Set<String>? = nil
+  /// Whether a compaction is queued on the pool.
+  private var compactionQueued = false
+  /// Whether the store lives in the temporary file because renaming it
+  /// over the store file failed.
+  private var renamePending = false
+
+  /// The time in nanoseconds it took to open the file and replay it.
+  public let loadTime: Int64
+  /// The count of records replayed when the store was opened.
+  public let loadedRecords: Int
+  /// The count of compactions.
+  public private(set) var compactions = 0
+
+  /**
+     Opens a store, creating its file if needed.
+
+     - Parameter path: **REQUIRED** The location of the file. A file with
+        ".tmp" appended is used during compaction.
+     - Parameter compactionPool: **OPTIONAL** The pool to run compactions
+        on when they are due, nil to leave them to the caller.
+     */
+  public init(_ path: String, compactionPool: WorkerPool? = nil) throws(Errno) {
+    let start = getClockCycle()
+
+    self.path = path
+    self.compactionPool = compactionPool
+    temporaryPath = path + ".tmp"
+
+    // A compaction was cut short: finish it, or drop the partial file.
+    if (try? Directory.entry(at: temporaryPath)) != nil {
+      if (try? Directory.entry(at: path)) == nil {
+        try FileDescriptor.rename(temporaryPath, to: path)
+      } else {
+        try FileDescriptor.remove(temporaryPath)
+      }
+    }
+
+    let file = try FileDescriptor.open(path, options: .create)
+    var values: [String: [UInt8]] = [:]
+
+    let replay = try KeyValueStore.replay(file, into: &values)
+    if file.size > replay.end {
+      // Drop the torn tail so new records follow the last valid one.
+      try file.truncate(to: replay.end)
+    }
+    try file.seek(offset: replay.end)
+
+    self.file = file
+    self.values = values
+    fileSize = replay.end
+    liveSize = values.reduce(0) { $0 + KeyValueStore.recordSize($1.key, $1.value.count) }
+    loadedRecords = replay.records
+    loadTime = cyclesToNanoseconds(start: start, stop: getClockCycle())
+  }
+
+  /// The count of keys.
+  public var count: Int {
+    lock.lock()
+    defer { lock.unlock() }
+    return values.count
+  }
+
+  /// The size of the file in bytes.
+  public var size: Int {
+    lock.lock()
+    defer { lock.unlock() }
+    return fileSize
+  }
+
+  /// Whether the stale records outweigh the live ones.
+  public var needsCompaction: Bool {
+    lock.lock()
+    defer { lock.unlock() }
+    return isCompactionDue
+  }
+
+  /// All the keys, in no particular order.
+  public var keys: [String] {
+    lock.lock()
+    defer { lock.unlock() }
+    return Array(values.keys)
+  }
+
+  /**
+     Looks up the value of a key.
+     - Parameter key: **REQUIRED** The key.
+     - Returns: A copy of the value, nil if the key isn't set.
+     */
+  public func value(forKey key: String) -> [UInt8]? {
+    lock.lock()
+    defer { lock.unlock() }
+    return values[key]
+  }
+
+  /**
+     Looks up a string value.
+     - Parameter key: **REQUIRED** The key.
+     - Returns: The value decoded as UTF-8, nil if the key isn't set.
+     */
+  public func string(forKey key: String) -> String? {
+    guard let value = value(forKey: key) else { return nil }
+    return String(decoding: value, as: UTF8.self)
+  }
+
+  /**
+     Looks up an integer value.
+     - Parameter key: **REQUIRED** The key.
+     - Returns: The value, nil if the key isn't set or isn't 8 bytes long.
+     */
+  public func integer(forKey key: String) -> Int64? {
+    guard let value = value(forKey: key), value.count == 8 else { return nil }
+    return value.withUnsafeBytes { Int64(littleEndian: $0.loadUnaligned(as: Int64.self)) }
+  }
+
+  /**
+     Sets the value of a key and saves it.
+     - Parameter value: **REQUIRED** The value, at most ``maxValueSize``
+        bytes. An empty value removes the key.
+     - Parameter key: **REQUIRED** The key, 1 to 255 bytes in UTF-8.
+     */
+  public func set(_ value: [UInt8], forKey key: String) throws(Errno) {
+    try set([(key, value)])
+  }
+
+  /**
+     Sets a string value and saves it.
+     - Parameter value: **REQUIRED** The value.
+     - Parameter key: **REQUIRED** The key.
+     */
+  public func set(_ value: String, forKey key: String) throws(Errno) {
+    try set([(key, Array(value.utf8))])
+  }
+
+  /**
+     Sets an integer value and saves it.
+     - Parameter value: **REQUIRED** The value.
+     - Parameter key: **REQUIRED** The key.
+     */
+  public func set(_ value: Int64, forKey key: String) throws(Errno) {
+    let bytes = withUnsafeBytes(of: value.littleEndian) { [UInt8]($0) }
+    try set([(key, bytes)])
+  }
+
+  /**
+     Removes a key and saves the change.
+     - Parameter key: **REQUIRED** The key.
+     */
+  public func remove(_ key: String) throws(Errno) {
+    try set([(key, [])])
+  }
+
+  /**
+     Sets several keys at once. After a power loss, either all of them or
+     none have changed.
+     - Parameter changes: **REQUIRED** The keys and their values. An empty
+        value removes the key.
+     */
+  public func set(_ changes: [(key: String, value: [UInt8])]) throws(Errno) {
+    for change in changes {
+      guard change.key.utf8.count > 0 && change.key.utf8.count <= 255,
+        change.value.count <= KeyValueStore.maxValueSize
+      else {
+        throw Errno.invalidArgument
+      }
+    }
+    guard !changes.isEmpty else { return }
+
+    lock.lock()
+    defer { lock.unlock() }
+
+    let file = try openFile()
+    let start = fileSize
+    do throws(Errno) {
+      for (index, change) in changes.enumerated() {
+        fileSize += try KeyValueStore.append(
+          change.key, change.value, continues: index < changes.count - 1, to: file)
+      }
+      try file.sync()
+    } catch {
+      // Leave the file as it was, the index hasn't changed yet.
+      try? file.truncate(to: start)
+      try? file.seek(offset: start)
+      fileSize = start
+      throw error
+    }
+
+    for change in changes {
+      changedKeys?.insert(change.key)
+      if let old = values[change.key] {
+        liveSize -= KeyValueStore.recordSize(change.key, old.count)
+      }
+      if change.value.isEmpty {
+        values[change.key] = nil
+      } else {
+        values[change.key] = change.value
+        liveSize += KeyValueStore.recordSize(change.key, change.value.count)
+      }
+    }
+
+    if isCompactionDue && !compactionQueued, let pool = compactionPool {
+      // The change is saved, a compaction that fails is queued again later.
+      compactionQueued =
+        (try? pool.submit(.low, timeout: 0) { [self] in
+          try? compact()
+          lock.lock()
+          compactionQueued = false
+          lock.unlock()
+        }) != nil
+    }
+  }
+
+  /**
+     Rewrites the file with only the live values.
+
+     The live values are written to the temporary file without holding
+     the store; the changes made meanwhile are added at the end, then the
+     temporary file replaces the store file.
+     */
+  public func compact() throws(Errno) {
+    compactionLock.lock()
+    defer { compactionLock.unlock() }
+
+    lock.lock()
+    do throws(Errno) {
+      try finishRename()
+    } catch {
+      lock.unlock()
+      throw error
+    }
+    let snapshot = values
+    changedKeys = []
+    lock.unlock()
+
+    var compacted: FileDescriptor? = nil
+    var size = 0
+    do throws(Errno) {
+      let file = try FileDescriptor.open(temporaryPath, options: .create)
+      compacted = file
+      try file.truncate(to: 0)
+      for (key, value) in snapshot {
+        size += try KeyValueStore.append(key, value, continues: false, to: file)
+      }
+    } catch {
+      lock.lock()
+      changedKeys = nil
+      lock.unlock()
+      try? compacted?.close()
+      try? FileDescriptor.remove(temporaryPath)
+      throw error
+    }
+
+    lock.lock()
+    defer { lock.unlock() }
+
+    let changed = changedKeys ?? []
+    changedKeys = nil
+    do throws(Errno) {
+      // Carry over what changed since the snapshot, removals included.
+      for key in changed {
+        size += try KeyValueStore.append(key, values[key] ?? [], continues: false, to: compacted!)
+      }
+      try compacted!.sync()
+      try compacted!.close()
+    } catch {
+      try? compacted!.close()
+      try? FileDescriptor.remove(temporaryPath)
+      throw error
+    }
+
+    try replaceFile(compactedSize: size)
+    compactions += 1
+  }
+
+  /// Puts the complete temporary file in place of the store file. A power
+  /// loss at any step leaves either file complete, see init. On failure
+  /// the store stays usable from whichever file holds it.
+  private func replaceFile(compactedSize: Int) throws(Errno) {
+    let oldSize = fileSize
+    try? file?.close()
+    file = nil
+
+    do throws(Errno) {
+      try FileDescriptor.remove(path)
+    } catch {
+      try? FileDescriptor.remove(temporaryPath)
+      try reopen(path, at: oldSize)
+      throw error
+    }
+
+    fileSize = compactedSize
+    do throws(Errno) {
+      try FileDescriptor.rename(temporaryPath, to: path)
+    } catch {
+      // The temporary file is the store until a rename succeeds.
+      renamePending = true
+      try reopen(temporaryPath, at: compactedSize)
+      throw error
+    }
+    try reopen(path, at: compactedSize)
+  }
+
+  /// Retries the rename left by a failed compaction.
+  private func finishRename() throws(Errno) {
+    guard renamePending else { return }
+    try? file?.close()
+    file = nil
+
+    do throws(Errno) {
+      try FileDescriptor.rename(temporaryPath, to: path)
+    } catch {
+      try reopen(temporaryPath, at: fileSize)
+      throw error
+    }
+    renamePending = false
+    try reopen(path, at: fileSize)
+  }
+
+  /// The open store file, reopened if a failure left it closed.
+  private func openFile() throws(Errno) -> FileDescriptor {
+    if let file = file {
+      return file
+    }
+    try reopen(renamePending ? temporaryPath : path, at: fileSize)
+    return file!
+  }
+
+  private func reopen(_ path: String, at size: Int) throws(Errno) {
+    let reopened = try FileDescriptor.open(path)
+    try reopened.seek(offset: size)
+    file = reopened
+  }
+
+  private var isCompactionDue: Bool {
+    fileSize > KeyValueStore.compactionThreshold && fileSize > 2 * liveSize
+  }
+
+  /// Writes a record and returns its size.
+  private static func append(
+    _ key: String, _ value: [UInt8], continues: Bool, to file: FileDescriptor
+  ) throws(Errno) -> Int {
+    var key = key
+    var header = [UInt8](repeating: 0, count: KeyValueStore.headerSize)
+    header[0] = (value.isEmpty ? 2 : 1) | (continues ? KeyValueStore.continuesFlag : 0)
+    header[1] = UInt8(key.utf8.count)
+    header[2] = UInt8(value.count & 0xFF)
+    header[3] = UInt8(value.count >> 8)
+
+    var result: Result<Int, Errno> = .success(0)
+    header.withUnsafeMutableBytes { head in
+      key.withUTF8 { keyBytes in
+        value.withUnsafeBytes { valueBytes in
+          var crc = swift_crc32(0, head.baseAddress, 4)
+          crc = swift_crc32(crc, keyBytes.baseAddress, keyBytes.count)
+          crc = swift_crc32(crc, valueBytes.baseAddress, valueBytes.count)
+          head.storeBytes(of: crc.littleEndian, toByteOffset: 4, as: UInt32.self)
+
+          do throws(Errno) {
+            result = .success(
+              try file.write([
+                UnsafeRawBufferPointer(head), UnsafeRawBufferPointer(keyBytes), valueBytes,
+              ]))
+          } catch {
+            result = .failure(error)
+          }
+        }
+      }
+    }
+
+    let length = KeyValueStore.recordSize(key, value.count)
+    switch result {
+    case .success(let written):
+      if written < length {
+        throw Errno.noSpace
+      }
+      return length
+    case .failure(let err):
+      throw err
+    }
+  }
+
+  /// Applies the valid records of a file in order and returns the end of
+  /// the last complete batch.
+  private static func replay(_ file: FileDescriptor, into values: inout [String: [UInt8]])
+    throws(Errno) -> (end: Int, records: Int)
+  {
+    let reader = try BufferedFileReader(file, bufferSize: 2 * maxValueSize)
+    var pending: [(key: String, value: [UInt8])] = []
+    var end = 0
+    var records = 0
+
+    while let head = try reader.readRecord(count: headerSize) {
+      let type = head[0] & ~continuesFlag
+      let continues = head[0] & continuesFlag != 0
+      let keyLength = Int(head[1])
+      let valueLength = Int(head[2]) | Int(head[3]) << 8
+      let crc = UInt32(littleEndian: head.loadUnaligned(fromByteOffset: 4, as: UInt32.self))
+      guard keyLength > 0, valueLength <= maxValueSize,
+        (type == 1 && valueLength > 0) || (type == 2 && valueLength == 0)
+      else {
+        break
+      }
+      var expected = swift_crc32(0, head.baseAddress, 4)
+
+      guard let body = try reader.readRecord(count: keyLength + valueLength) else { break }
+      expected = swift_crc32(expected, body.baseAddress, body.count)
+      guard expected == crc else { break }
+
+      pending.append(
+        (
+          String(decoding: UnsafeRawBufferPointer(rebasing: body[0..<keyLength]), as: UTF8.self),
+          [UInt8](body[keyLength...])
+        ))
+      records += 1
+
+      if !continues {
+        for change in pending {
+          values[change.key] = change.value.isEmpty ? nil : change.value
+        }
+        pending.removeAll()
+        end = reader.offset
+      }
+    }
+    return (end, records)
+  }
+
+  private static func recordSize(_ key: String, _ valueCount: Int) -> Int {
+    headerSize + key.utf8.count + valueCount
+  }
+
+  /// The largest value in bytes.
+  public static let maxValueSize = 4096
+
+  private static let headerSize = 8
+  private static let continuesFlag: UInt8 = 0x80
+  /// Files smaller than this are never compacted.
+  private static let compactionThreshold = 16 * 1024
+}
@@ -0,0 +1,512 @@
+//=== LCD.swift -----------------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The LCD class drives a panel on the parallel RGB LCD interface with
+/// multiple framebuffers.
+///
+/// You draw into the back buffer, which is never being scanned out, and then
+/// call ``present()`` to show it. Presenting only swaps the framebuffer
+/// pointer of the LCD controller, no pixel is copied. The buffer that was on
+/// screen is reused for drawing only after the controller has switched away
+/// from it, so the panel never shows a half-drawn frame.
+///
+/// ```swift
+/// let lcd = LCD(panel, bufferCount: 2)
+///
+/// while true {
+///     // The panel uses RGB565, so each pixel is a UInt16.
+///     let pixels = lcd.backBuffer(as: UInt16.self)
+///     pixels.update(repeating: 0xF800)
+///     lcd.present()
+/// }
+/// ```
+///
+/// If only a part of the screen changes, draw that part and mark it with
+/// ``invalidate(_:)`` before presenting. Only the changed rectangles are
+/// written back to memory, and they are copied into the next back buffer so
+/// it holds the whole latest frame. Once you draw partially, invalidate
+/// every change including the first full frame, otherwise the other buffers
+/// can't catch up.
+public final class LCD {
+  @_spi(SwiftIOPrivate) public let obj: UnsafeMutableRawPointer
+
+  private var frameBuffers: [UnsafeMutableRawBufferPointer] = []
+  private var frontIndex = 0
+  private var backIndex = 1
+  /// The uptime when each buffer stopped being the front buffer.
+  private var releaseTime: [Int64]
+  private var lastPresentTime: Int64 = 0
+  /// The rectangles changed in the back buffer since the last present.
+  private var dirtyRegion: DirtyRegion
+  /// The rectangles each buffer is missing from later frames.
+  private var staleRegions: [DirtyRegion]
+  /// The rectangles copied into the back buffer from the front buffer,
+  /// they must be written back like the invalidated ones.
+  private var syncedRegion: DirtyRegion
+  private var regionUpdateSupported = true
+
+  /// The visible width of the panel in pixels.
+  public let width: Int
+  /// The visible height of the panel in pixels.
+  public let height: Int
+  /// The pixel format of the framebuffers.
+  public let pixelFormat: PixelFormat
+  /// The number of bytes of a pixel.
+  public let bytesPerPixel: Int
+  /// The number of bytes of a framebuffer.
+  public let frameBufferSize: Int
+  /// The refresh rate of the panel in Hz.
+  public let refreshRate: Int
+  /// The number of framebuffers, 2 or 3.
+  public let bufferCount: Int
+
+  /// The percentage of the screen area above which a partial update falls
+  /// back to a full frame update, 50 by default.
+  public var fullUpdateThreshold = 50
+
+  /// The frame statistics since the LCD was initialized or reset.
+  public private(set) var statistics = Statistics()
+
+  /// Initializes the LCD controller, allocates the framebuffers and starts
+  /// refreshing the panel.
+  /// - Parameters:
+  ///   - panel: **REQUIRED** The timing and format of the panel. Refer to
+  ///   the spec of the panel.
+  ///   - bufferCount: **OPTIONAL** The number of framebuffers, 2 by default.
+  ///   With 3 buffers, drawing rarely needs to wait for the panel.
+  public init(_ panel: Panel, bufferCount: Int = 2) {
+    guard bufferCount == 2 || bufferCount == 3 else {
+      print("error: LCD bufferCount must be 2 or 3")
+      fatalError()
+    }
+
+    var param = panel.param
+    if let ptr = swifthal_lcd_open(&param) {
+      obj = ptr
+    } else {
+      print("error: LCD initialization failed!")
+      fatalError()
+    }
+
+    var width: Int32 = 0
+    var height: Int32 = 0
+    var format = SWIFT_LCD_PIXEL_FORMAT_RGB_565
+    var bpp: Int32 = 0
+    swifthal_lcd_screen_param_get(obj, &width, &height, &format, &bpp)
+
+    self.width = Int(width)
+    self.height = Int(height)
+    self.pixelFormat = LCD.getPixelFormat(format)
+    self.bytesPerPixel = Int(bpp)
+    self.frameBufferSize = Int(width) * Int(height) * Int(bpp)
+    self.bufferCount = bufferCount
+
+    let rate = swifthal_lcd_refresh_rate_get(obj)
+    self.refreshRate = rate > 0 ? Int(rate) : panel.refreshRate
+
+    releaseTime = [Int64](repeating: 0, count: bufferCount)
+    dirtyRegion = DirtyRegion(bounds: Rect(x: 0, y: 0, width: Int(width), height: Int(height)))
+    staleRegions = [DirtyRegion](repeating: dirtyRegion, count: bufferCount)
+    syncedRegion = dirtyRegion
+    for _ in 0..<bufferCount {
+      // Aligned to the cache line so cache maintenance never touches a
+      // neighbouring allocation.
+      let buffer = UnsafeMutableRawBufferPointer.allocate(
+        byteCount: frameBufferSize, alignment: LCD.frameBufferAlignment)
+      buffer.initializeMemory(as: UInt8.self, repeating: 0)
+      frameBuffers.append(buffer)
+    }
+
+    let result = nothingOrErrno(
+      swifthal_lcd_start(obj, frameBuffers[0].baseAddress, UInt32(frameBufferSize))
+    )
+    if case .failure(let err) = result {
+      let errDescription = err.description
+      print("error: LCD start failed -> " + errDescription)
+      fatalError()
+    }
+    lastPresentTime = getSystemUptimeInMilliseconds()
+  }
+
+  deinit {
+    swifthal_lcd_stop(obj)
+    swifthal_lcd_close(obj)
+    for buffer in frameBuffers {
+      buffer.deallocate()
+    }
+  }
+
+  /// The period of a refresh of the panel in milliseconds, rounded up.
+  public var framePeriod: Int {
+    (1000 + refreshRate - 1) / refreshRate
+  }
+
+  /// The framebuffer to draw the next frame into.
+  ///
+  /// If the panel may still be showing this buffer, it waits until the LCD
+  /// controller has switched to the latest presented frame. The rectangles
+  /// invalidated in later frames are then copied from the front buffer.
+  public var backBuffer: UnsafeMutableRawBufferPointer {
+    waitForRelease(backIndex)
+    syncBackBuffer()
+    return frameBuffers[backIndex]
+  }
+
+  /// The framebuffer that is being shown on the panel. Don't write to it.
+  public var frontBuffer: UnsafeRawBufferPointer {
+    UnsafeRawBufferPointer(frameBuffers[frontIndex])
+  }
+
+  /// Gets the back buffer as typed pixels.
+  ///
+  /// Use `UInt16` for `.rgb565`, `UInt32` for `.argb8888` and `UInt8` for
+  /// `.rgb888` and `.raw8`. With `UInt8`, each pixel takes ``bytesPerPixel``
+  /// elements.
+  /// - Parameter type: The type of a pixel.
+  /// - Returns: A buffer of all pixels, row by row.
+  public func backBuffer<Pixel>(as type: Pixel.Type) -> UnsafeMutableBufferPointer<Pixel> {
+    let stride = MemoryLayout<Pixel>.stride
+    guard stride == bytesPerPixel || stride == 1 else {
+      print("error: LCD pixel type doesn't match the pixel format!")
+      fatalError()
+    }
+    let buffer = backBuffer
+    return buffer.bindMemory(to: Pixel.self)
+  }
+
+  /// Marks a rectangle of the back buffer as changed.
+  ///
+  /// Overlapping and adjacent rectangles are merged. The rectangle is
+  /// clipped to the screen.
+  /// - Parameter rect: The changed rectangle.
+  public func invalidate(_ rect: Rect) {
+    dirtyRegion.add(rect)
+  }
+
+  /// Marks a rectangle of the back buffer as changed.
+  /// - Parameters:
+  ///   - x: The left of the rectangle.
+  ///   - y: The top of the rectangle.
+  ///   - width: The width of the rectangle.
+  ///   - height: The height of the rectangle.
+  public func invalidate(x: Int, y: Int, width: Int, height: Int) {
+    dirtyRegion.add(Rect(x: x, y: y, width: width, height: height))
+  }
+
+  /// Shows the back buffer on the panel by swapping the framebuffer
+  /// pointer of the LCD controller.
+  ///
+  /// The pixels are not copied. If nothing is invalidated, the whole
+  /// frame is written back and the next back buffer is the oldest one, so
+  /// draw the whole frame into it after presenting. If some rectangles
+  /// are invalidated and they cover less than ``fullUpdateThreshold``
+  /// percent of the screen, only those rectangles are written back,
+  /// together with the ones copied from the front buffer to catch up.
+  /// - Returns: Whether the framebuffer is updated. If not, it returns the
+  /// specific error.
+  @discardableResult
+  public func present() -> Result<(), Errno> {
+    // Nothing may have been drawn since the last present, the back buffer
+    // must still catch up before it is shown.
+    if !staleRegions[backIndex].isEmpty {
+      waitForRelease(backIndex)
+      syncBackBuffer()
+    }
+    // Without invalidated rectangles the whole frame is written back,
+    // synced ones included.
+    if !dirtyRegion.isEmpty {
+      dirtyRegion.formUnion(syncedRegion)
+    }
+    syncedRegion.removeAll()
+
+    let buffer = frameBuffers[backIndex].baseAddress
+    var result: Result<(), Errno> = .success(())
+    var partial = false
+
+    if !dirtyRegion.isEmpty && regionUpdateSupported &&
+        dirtyRegion.area * 100 < width * height * fullUpdateThreshold {
+      partial = true
+      for rect in dirtyRegion.rects {
+        result = nothingOrErrno(
+          swifthal_lcd_fb_update_region(obj, buffer, Int32(rect.x), Int32(rect.y),
+                                        Int32(rect.width), Int32(rect.height))
+        )
+        if case .failure(let err) = result {
+          if err.rawValue == Errno.notSupported.rawValue {
+            regionUpdateSupported = false
+            partial = false
+          }
+          break
+        }
+      }
+    }
+
+    if !partial {
+      result = nothingOrErrno(
+        swifthal_lcd_fb_update(obj, buffer, UInt32(frameBufferSize))
+      )
+    }
+
+    if case .failure(let err) = result {
+      //print("error: \(self).\(#function) line \(#line) -> " + String(describing: err))
+      let errDescription = err.description
+      print("error: \(self).\(#function) line \(#line) -> " + errDescription)
+      return result
+    }
+
+    let now = getSystemUptimeInMilliseconds()
+    statistics.record(frameTime: Int(now - lastPresentTime), framePeriod: framePeriod)
+    lastPresentTime = now
+    if partial {
+      statistics.partialUpdates += 1
+      statistics.updatedBytes += dirtyRegion.area * bytesPerPixel
+    } else {
+      statistics.fullUpdates += 1
+      statistics.updatedBytes += frameBufferSize
+    }
+
+    // Without invalidated rectangles the whole frame is redrawn each time,
+    // so the other buffers don't need to catch up.
+    if !dirtyRegion.isEmpty {
+      for index in 0..<bufferCount where index != backIndex {
+        staleRegions[index].formUnion(dirtyRegion)
+      }
+      dirtyRegion.removeAll()
+    }
+
+    // The controller latches the new address at the next frame, so the old
+    // front buffer may be scanned out for up to one more refresh.
+    releaseTime[frontIndex] = now
+    frontIndex = backIndex
+    backIndex = (backIndex + 1) % bufferCount
+
+    return result
+  }
+
+  /// Clears the frame statistics.
+  public func resetStatistics() {
+    statistics = Statistics()
+    lastPresentTime = getSystemUptimeInMilliseconds()
+  }
+
+  /// Copies the rectangles changed in later frames from the front buffer
+  /// into the back buffer, so partial drawing starts from the latest frame.
+  /// The copy may stay in the data cache, so the rectangles are written
+  /// back at the next present.
+  private func syncBackBuffer() {
+    guard !staleRegions[backIndex].isEmpty else { return }
+
+    let src = UnsafeRawPointer(frameBuffers[frontIndex].baseAddress!)
+    let dst = frameBuffers[backIndex].baseAddress!
+    let format = LCD.getPixelFormatRawValue(pixelFormat)
+
+    for rect in staleRegions[backIndex].rects {
+      let offset = rect.y * pitch + rect.x * bytesPerPixel
+      swift_raster_copy(dst + offset, Int32(pitch), src + offset, Int32(pitch),
+                        format, Int32(rect.width), Int32(rect.height))
+      syncedRegion.add(rect)
+    }
+    staleRegions[backIndex].removeAll()
+  }
+
+  private func waitForRelease(_ index: Int) {
+    let ready = releaseTime[index] + Int64(framePeriod)
+    let now = getSystemUptimeInMilliseconds()
+
+    if releaseTime[index] > 0 && now < ready {
+      statistics.waitTime += Int(ready - now)
+      sleep(ms: Int(ready - now))
+    }
+  }
+
+  private static let frameBufferAlignment = 32
+}
+
+extension LCD {
+  /// The color format of a pixel.
+  public enum PixelFormat {
+    /// 24-bit RGB, 3 bytes per pixel.
+    case rgb888
+    /// 32-bit ARGB, 4 bytes per pixel.
+    case argb8888
+    /// 16-bit RGB, 5 bits red, 6 bits green and 5 bits blue.
+    case rgb565
+    /// 8-bit raw data.
+    case raw8
+  }
+
+  /// The active level or edge of a control signal.
+  public enum ActiveMode {
+    case low
+    case high
+    case risingEdge
+    case fallingEdge
+  }
+
+  /// The parameters of a panel. Refer to the spec of the panel for the values.
+  public struct Panel {
+    /// The total width including the blanking area.
+    public var totalWidth: Int
+    /// The total height including the blanking area.
+    public var totalHeight: Int
+    /// The visible width.
+    public var activeWidth: Int
+    /// The visible height.
+    public var activeHeight: Int
+    /// The pulse width of hsync.
+    public var hsyncPulseWidth: Int
+    /// The back porch of hsync.
+    public var hsyncBackPorch: Int
+    /// The pulse width of vsync.
+    public var vsyncPulseWidth: Int
+    /// The back porch of vsync.
+    public var vsyncBackPorch: Int
+    /// The pixel format of the framebuffers.
+    public var pixelFormat: PixelFormat
+    public var vsyncActive: ActiveMode
+    public var hsyncActive: ActiveMode
+    public var dataEnableActive: ActiveMode
+    public var dataActive: ActiveMode
+    /// The refresh rate in Hz.
+    public var refreshRate: Int
+
+    public init(
+      totalWidth: Int,
+      totalHeight: Int,
+      activeWidth: Int,
+      activeHeight: Int,
+      hsyncPulseWidth: Int,
+      hsyncBackPorch: Int,
+      vsyncPulseWidth: Int,
+      vsyncBackPorch: Int,
+      pixelFormat: PixelFormat = .rgb565,
+      vsyncActive: ActiveMode = .low,
+      hsyncActive: ActiveMode = .low,
+      dataEnableActive: ActiveMode = .high,
+      dataActive: ActiveMode = .fallingEdge,
+      refreshRate: Int = 60
+    ) {
+      self.totalWidth = totalWidth
+      self.totalHeight = totalHeight
+      self.activeWidth = activeWidth
+      self.activeHeight = activeHeight
+      self.hsyncPulseWidth = hsyncPulseWidth
+      self.hsyncBackPorch = hsyncBackPorch
+      self.vsyncPulseWidth = vsyncPulseWidth
+      self.vsyncBackPorch = vsyncBackPorch
+      self.pixelFormat = pixelFormat
+      self.vsyncActive = vsyncActive
+      self.hsyncActive = hsyncActive
+      self.dataEnableActive = dataEnableActive
+      self.dataActive = dataActive
+      self.refreshRate = refreshRate
+    }
+
+    var param: swift_lcd_panel_param_t {
+      var param = swift_lcd_panel_param_t()
+      param.total_width = Int32(totalWidth)
+      param.total_hight = Int32(totalHeight)
+      param.active_width = Int32(activeWidth)
+      param.active_hight = Int32(activeHeight)
+      param.hsw = Int32(hsyncPulseWidth)
+      param.hbp = Int32(hsyncBackPorch)
+      param.vsw = Int32(vsyncPulseWidth)
+      param.vbp = Int32(vsyncBackPorch)
+      param.color_format = LCD.getPixelFormatRawValue(pixelFormat)
+      param.vsync_active = LCD.getActiveModeRawValue(vsyncActive)
+      param.hsync_active = LCD.getActiveModeRawValue(hsyncActive)
+      param.de_active = LCD.getActiveModeRawValue(dataEnableActive)
+      param.data_active = LCD.getActiveModeRawValue(dataActive)
+      param.refresh_rate = Int32(refreshRate)
+      return param
+    }
+  }
+
+  /// The frame timing measured by ``present()``, in milliseconds.
+  public struct Statistics {
+    /// The count of presented frames.
+    public internal(set) var frameCount = 0
+    /// The time between the latest two presented frames.
+    public internal(set) var lastFrameTime = 0
+    /// The longest time between two presented frames.
+    public internal(set) var maxFrameTime = 0
+    /// The time between all presented frames.
+    public internal(set) var totalFrameTime = 0
+    /// The count of panel refreshes that showed a frame again because no
+    /// new frame was presented in time.
+    public internal(set) var droppedFrames = 0
+    /// The time spent waiting for the panel to release a back buffer.
+    public internal(set) var waitTime = 0
+    /// The count of frames that only wrote back invalidated rectangles.
+    public internal(set) var partialUpdates = 0
+    /// The count of frames that wrote back the whole framebuffer.
+    public internal(set) var fullUpdates = 0
+    /// The bytes written back to the framebuffer memory.
+    public internal(set) var updatedBytes = 0
+
+    /// The average time between two presented frames.
+    public var averageFrameTime: Int {
+      frameCount == 0 ? 0 : totalFrameTime / frameCount
+    }
+
+    mutating func record(frameTime: Int, framePeriod: Int) {
+      frameCount += 1
+      lastFrameTime = frameTime
+      maxFrameTime = max(maxFrameTime, frameTime)
+      totalFrameTime += frameTime
+      if frameTime > framePeriod {
+        droppedFrames += frameTime / framePeriod - (frameTime % framePeriod == 0 ? 1 : 0)
+      }
+    }
+  }
+
+  private static func getPixelFormat(_ format: swift_lcd_pixel_format_t) -> PixelFormat {
+    switch format {
+    case SWIFT_LCD_PIXEL_FORMAT_RGB_888:
+      return .rgb888
+    case SWIFT_LCD_PIXEL_FORMAT_ARGB_8888:
+      return .argb8888
+    case SWIFT_LCD_PIXEL_FORMAT_RGB_565:
+      return .rgb565
+    default:
+      return .raw8
+    }
+  }
+
+  static func getPixelFormatRawValue(_ format: PixelFormat) -> swift_lcd_pixel_format_t {
+    switch format {
+    case .rgb888:
+      return SWIFT_LCD_PIXEL_FORMAT_RGB_888
+    case .argb8888:
+      return SWIFT_LCD_PIXEL_FORMAT_ARGB_8888
+    case .rgb565:
+      return SWIFT_LCD_PIXEL_FORMAT_RGB_565
+    case .raw8:
+      return SWIFT_LCD_PIXEL_FORMAT_RGB_8RAW
+    }
+  }
+
+  private static func getActiveModeRawValue(_ mode: ActiveMode) -> swift_lcd_active_mode_t {
+    switch mode {
+    case .low:
+      return SWIFT_LCD_ACTIVE_LEVEL_LOW
+    case .high:
+      return SWIFT_LCD_ACTIVE_LEVEL_HIGH
+    case .risingEdge:
+      return SWIFT_LCD_ACTIVE_EDGE_RISING
+    case .fallingEdge:
+      return SWIFT_LCD_ACTIVE_EDGE_FALLING
+    }
+  }
+}
@@ -0,0 +1,181 @@
+//=== LCDDrawing.swift ----------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// Drawing into the back buffer with the raster kernels.
+///
+/// Every method clips to the screen and invalidates the rectangle it
+/// draws, so it works with both full and partial presenting. Colors are
+/// always ARGB8888 and converted to the pixel format of the panel. Large
+/// rectangles use the 2D accelerator of the board if there is one.
+extension LCD {
+  /// Fills a rectangle with a color.
+  /// - Parameters:
+  ///   - rect: The rectangle on the screen.
+  ///   - color: The color in ARGB8888.
+  public func fill(_ rect: Rect, color: UInt32) {
+    let clipped = clip(rect)
+    guard !clipped.isEmpty else { return }
+
+    swift_raster_fill(pixelAddress(clipped.x, clipped.y), Int32(pitch),
+                      rawPixelFormat, Int32(clipped.width), Int32(clipped.height), color)
+    invalidate(clipped)
+  }
+
+  /// Copies pixels onto the screen, converting them if the format differs
+  /// from the panel.
+  /// - Parameters:
+  ///   - pixels: The source pixels, row by row.
+  ///   - format: The pixel format of the source.
+  ///   - width: The width of the source in pixels.
+  ///   - height: The height of the source in pixels.
+  ///   - pitch: The bytes between two rows of the source, `width` pixels
+  ///   by default.
+  ///   - x: The left on the screen.
+  ///   - y: The top on the screen.
+  /// - Returns: Whether the pixels are copied. If not, it returns the
+  /// specific error.
+  @discardableResult
+  public func draw(
+    _ pixels: UnsafeRawBufferPointer,
+    format: PixelFormat,
+    width: Int,
+    height: Int,
+    pitch: Int? = nil,
+    x: Int,
+    y: Int
+  ) -> Result<(), Errno> {
+    let bpp = Int(swift_raster_bpp(LCD.getPixelFormatRawValue(format)))
+    let srcPitch = pitch ?? width * bpp
+    guard height == 0 || pixels.count >= (height - 1) * srcPitch + width * bpp else {
+      return .failure(Errno.invalidArgument)
+    }
+
+    let target = Rect(x: x, y: y, width: width, height: height)
+    let clipped = clip(target)
+    guard !clipped.isEmpty, let base = pixels.baseAddress else { return .success(()) }
+
+    let src = base + (clipped.y - y) * srcPitch + (clipped.x - x) * bpp
+    let result = nothingOrErrno(
+      swift_raster_convert(pixelAddress(clipped.x, clipped.y), Int32(self.pitch), rawPixelFormat,
+                           src, Int32(srcPitch), LCD.getPixelFormatRawValue(format),
+                           Int32(clipped.width), Int32(clipped.height))
+    )
+    if case .success = result {
+      invalidate(clipped)
+    }
+    return result
+  }
+
+  /// Blends ARGB8888 pixels with their own alpha over the screen.
+  ///
+  /// The panel must use `.rgb565` or `.argb8888`.
+  /// - Parameters:
+  ///   - pixels: The source pixels, row by row.
+  ///   - width: The width of the source in pixels.
+  ///   - height: The height of the source in pixels.
+  ///   - x: The left on the screen.
+  ///   - y: The top on the screen.
+  /// - Returns: Whether the pixels are blended. If not, it returns the
+  /// specific error.
+  @discardableResult
+  public func blend(
+    _ pixels: UnsafeBufferPointer<UInt32>,
+    width: Int,
+    height: Int,
+    x: Int,
+    y: Int
+  ) -> Result<(), Errno> {
+    guard pixels.count >= width * height else {
+      return .failure(Errno.invalidArgument)
+    }
+
+    let clipped = clip(Rect(x: x, y: y, width: width, height: height))
+    guard !clipped.isEmpty, let base = pixels.baseAddress else { return .success(()) }
+
+    let src = base + (clipped.y - y) * width + (clipped.x - x)
+    let dst = pixelAddress(clipped.x, clipped.y)
+    let srcPitch = Int32(width * 4)
+
+    switch pixelFormat {
+    case .rgb565:
+      swift_raster_blend_argb8888_rgb565(dst.assumingMemoryBound(to: UInt16.self), Int32(pitch),
+                                         src, srcPitch,
+                                         Int32(clipped.width), Int32(clipped.height))
+    case .argb8888:
+      swift_raster_blend_argb8888(dst.assumingMemoryBound(to: UInt32.self), Int32(pitch),
+                                  src, srcPitch,
+                                  Int32(clipped.width), Int32(clipped.height))
+    default:
+      return .failure(Errno.notSupported)
+    }
+    invalidate(clipped)
+    return .success(())
+  }
+
+  /// Draws a color through an 8-bit alpha mask, such as an antialiased
+  /// glyph.
+  ///
+  /// The panel must use `.rgb565` or `.argb8888`.
+  /// - Parameters:
+  ///   - mask: The alpha values, row by row.
+  ///   - width: The width of the mask.
+  ///   - height: The height of the mask.
+  ///   - x: The left on the screen.
+  ///   - y: The top on the screen.
+  ///   - color: The color in ARGB8888.
+  /// - Returns: Whether the mask is drawn. If not, it returns the specific
+  /// error.
+  @discardableResult
+  public func draw(
+    mask: UnsafeBufferPointer<UInt8>,
+    width: Int,
+    height: Int,
+    x: Int,
+    y: Int,
+    color: UInt32
+  ) -> Result<(), Errno> {
+    guard mask.count >= width * height else {
+      return .failure(Errno.invalidArgument)
+    }
+
+    let clipped = clip(Rect(x: x, y: y, width: width, height: height))
+    guard !clipped.isEmpty, let base = mask.baseAddress else { return .success(()) }
+
+    let src = base + (clipped.y - y) * width + (clipped.x - x)
+    let result = nothingOrErrno(
+      swift_raster_blend_mask(pixelAddress(clipped.x, clipped.y), Int32(pitch), rawPixelFormat,
+                              src, Int32(width),
+                              Int32(clipped.width), Int32(clipped.height), color)
+    )
+    if case .success = result {
+      invalidate(clipped)
+    }
+    return result
+  }
+
+  /// The bytes between two rows of a framebuffer.
+  public var pitch: Int { width * bytesPerPixel }
+
+  private var rawPixelFormat: swift_lcd_pixel_format_t {
+    LCD.getPixelFormatRawValue(pixelFormat)
+  }
+
+  private func clip(_ rect: Rect) -> Rect {
+    rect.intersection(Rect(x: 0, y: 0, width: width, height: height))
+  }
+
+  private func pixelAddress(_ x: Int, _ y: Int) -> UnsafeMutableRawPointer {
+    backBuffer.baseAddress! + y * pitch + x * bytesPerPixel
+  }
+}
@@ -0,0 +1,222 @@
+//=== MemoryPool.swift ----------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The MemoryPool class hands out fixed-size blocks of memory in constant
+/// time, also in interrupt callbacks.
+///
+/// All the memory of the pool is taken from the heap once, when it is
+/// created. Allocating and deallocating after that only swap a pointer
+/// with an atomic instruction: they never lock, never call the kernel and
+/// never fragment the heap, so a loop that gets its buffers from a pool
+/// runs in the same time every iteration.
+///
+/// A pool has one or more size classes. A request is served by the
+/// smallest class whose blocks are large enough, or by a larger one if
+/// that class is empty. Blocks are aligned to 32 bytes, a cache line, so
+/// they can be used as DMA buffers.
+///
+/// ```swift
+/// let pool = MemoryPool(sizeClasses: [(64, 16), (512, 4)])
+///
+/// while true {
+///     guard let frame = pool.allocate(byteCount: 512) else { continue }
+///     spi.read(into: frame)
+///     process(frame)
+///     pool.deallocate(frame)
+/// }
+/// ```
+///
+/// The statistics of each class tell how many blocks it needed at most,
+/// and how often it ran out, so the classes can be sized to the real load.
+public final class MemoryPool {
+  /// Statistics of a size class.
+  public struct Statistics {
+    /// The size of each block in bytes.
+    public let blockSize: Int
+    /// The count of blocks.
+    public let blockCount: Int
+    /// The count of blocks allocated now.
+    public let used: Int
+    /// The most blocks allocated at once.
+    public let highWater: Int
+    /// The count of requests the class couldn't serve because it was
+    /// empty, even if a larger class served them.
+    public let failures: Int
+  }
+
+  let pools: UnsafeMutablePointer<swift_pool_t>
+  private let storage: UnsafeMutableRawPointer
+
+  /// The count of size classes.
+  public let classCount: Int
+
+  /**
+     Creates a pool with a single size class.
+
+     - Parameter blockSize: **REQUIRED** The size of each block in bytes,
+        rounded up to a multiple of 32.
+     - Parameter blockCount: **REQUIRED** The count of blocks, up to 65535.
+     */
+  public convenience init(blockSize: Int, blockCount: Int) {
+    self.init(sizeClasses: [(blockSize, blockCount)])
+  }
+
+  /**
+     Creates a pool with several size classes.
+
+     - Parameter sizeClasses: **REQUIRED** The size of the blocks of each
+        class in bytes, rounded up to a multiple of 32, and their count, up
+        to 65535.
+     */
+  public init(sizeClasses: [(blockSize: Int, blockCount: Int)]) {
+    guard !sizeClasses.isEmpty else {
+      print("error: MemoryPool needs at least one size class")
+      fatalError()
+    }
+    for sizeClass in sizeClasses {
+      guard sizeClass.blockSize > 0 && sizeClass.blockCount > 0
+        && sizeClass.blockCount <= Int(SWIFT_POOL_MAX_BLOCKS)
+      else {
+        print("error: MemoryPool blockSize must > 0 and blockCount must be 1 to 65535")
+        fatalError()
+      }
+    }
+
+    let classes = sizeClasses.map {
+      (blockSize: MemoryPool.roundUp($0.blockSize), blockCount: $0.blockCount)
+    }.sorted { $0.blockSize < $1.blockSize }
+
+    classCount = classes.count
+    storage = UnsafeMutableRawPointer.allocate(
+      byteCount: classes.reduce(0) { $0 + $1.blockSize * $1.blockCount },
+      alignment: Int(SWIFT_POOL_ALIGN))
+    pools = UnsafeMutablePointer<swift_pool_t>.allocate(capacity: classes.count)
+
+    var offset = 0
+    for (index, sizeClass) in classes.enumerated() {
+      swift_pool_init(
+        pools + index, storage + offset, UInt32(sizeClass.blockSize),
+        UInt32(sizeClass.blockCount))
+      offset += sizeClass.blockSize * sizeClass.blockCount
+    }
+  }
+
+  deinit {
+    pools.deallocate()
+    storage.deallocate()
+  }
+
+  /// The size in bytes of the largest block.
+  public var maxBlockSize: Int {
+    Int(pools[classCount - 1].block_size)
+  }
+
+  /**
+     Allocates a block.
+     - Parameter byteCount: **REQUIRED** The bytes needed.
+     - Returns: A buffer of `byteCount` bytes at the start of a block, nil
+        if no class large enough has a free block.
+     */
+  public func allocate(byteCount: Int) -> UnsafeMutableRawBufferPointer? {
+    guard byteCount >= 0,
+      let block = swift_pools_alloc(pools, Int32(classCount), byteCount)
+    else {
+      return nil
+    }
+    return UnsafeMutableRawBufferPointer(start: block, count: byteCount)
+  }
+
+  /**
+     Allocates a block for values of a type.
+     - Parameter type: **REQUIRED** The type of the values, aligned to at
+        most 32 bytes.
+     - Parameter capacity: **REQUIRED** The count of values.
+     - Returns: An uninitialized buffer of `capacity` values, nil if no
+        class large enough has a free block.
+     */
+  public func allocate<T>(_ type: T.Type, capacity: Int) -> UnsafeMutableBufferPointer<T>? {
+    guard let buffer = allocate(byteCount: capacity * MemoryLayout<T>.stride) else {
+      return nil
+    }
+    return buffer.bindMemory(to: T.self)
+  }
+
+  /**
+     Returns a block to the pool.
+     - Parameter pointer: **REQUIRED** The start of a block from this pool.
+     */
+  public func deallocate(_ pointer: UnsafeMutableRawPointer) {
+    if swift_pools_free(pools, Int32(classCount), pointer) != 0 {
+      print("error: MemoryPool can't deallocate a pointer it didn't allocate")
+      fatalError()
+    }
+  }
+
+  /**
+     Returns a block to the pool.
+     - Parameter buffer: **REQUIRED** A buffer from ``allocate(byteCount:)``.
+     */
+  public func deallocate(_ buffer: UnsafeMutableRawBufferPointer) {
+    guard let base = buffer.baseAddress else { return }
+    deallocate(base)
+  }
+
+  /**
+     Returns a block to the pool.
+     - Parameter buffer: **REQUIRED** A buffer from
+        ``allocate(_:capacity:)``. Its values should be deinitialized.
+     */
+  public func deallocate<T>(_ buffer: UnsafeMutableBufferPointer<T>) {
+    guard let base = buffer.baseAddress else { return }
+    deallocate(UnsafeMutableRawPointer(base))
+  }
+
+  /**
+     Checks whether a pointer is within a block of this pool.
+     - Parameter pointer: **REQUIRED** The pointer.
+     */
+  public func owns(_ pointer: UnsafeRawPointer) -> Bool {
+    for index in 0..<classCount where swift_pool_owns(pools + index, pointer) {
+      return true
+    }
+    return false
+  }
+
+  /**
+     The statistics of a size class.
+     - Parameter index: **REQUIRED** The class, 0 for the smallest blocks.
+     */
+  public func statistics(forClass index: Int) -> Statistics {
+    let pool = pools[index]
+    return Statistics(
+      blockSize: Int(pool.block_size),
+      blockCount: Int(pool.block_count),
+      used: Int(pool.used),
+      highWater: Int(pool.high_water),
+      failures: Int(pool.failures))
+  }
+
+  /// Clears the failures and sets the high-water marks to the blocks in
+  /// use now. Call it while no one allocates from the pool.
+  public func resetStatistics() {
+    for index in 0..<classCount {
+      pools[index].high_water = pools[index].used
+      pools[index].failures = 0
+    }
+  }
+
+  private static func roundUp(_ size: Int) -> Int {
+    (size + Int(SWIFT_POOL_ALIGN) - 1) & ~(Int(SWIFT_POOL_ALIGN) - 1)
+  }
+}
@@ -0,0 +1,287 @@
+//=== PooledMessageQueue.swift --------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The PooledMessageQueue class passes large messages between threads
+/// without copying them.
+///
+/// A ``MessageQueue`` copies every message into the kernel queue and out
+/// again. This queue instead owns a pool of fixed-size blocks: the sender
+/// allocates a block, fills it in place and sends it, and only the
+/// address of the block goes through the kernel queue. The receiver reads
+/// the block where it is, and the block goes back to the pool as soon as
+/// the received message goes out of scope.
+///
+/// A ``Message`` can't be copied, so a block always has exactly one owner:
+/// sending a message gives it up, and a message that is dropped without
+/// being sent returns its block to the pool. A message keeps its queue
+/// alive, so the pool is never destroyed while a block is out.
+///
+/// ```swift
+/// let frames = PooledMessageQueue(blockSize: 512, blockCount: 4)
+///
+/// // Producer thread.
+/// var frame = try frames.allocate()
+/// frame.count = sensor.read(into: frame.buffer)
+/// try frames.send(frame)
+///
+/// // Consumer thread.
+/// let received = try frames.receive()
+/// process(received.bytes)
+/// ```
+///
+/// The queue uses two kernel message queues, one for the sent messages
+/// and one for the free blocks. Allocating and sending with a timeout of
+/// 0 never block, so they also work in interrupt callbacks.
+public final class PooledMessageQueue {
+  /// A block of the pool, owned by a single sender or receiver.
+  public struct Message: ~Copyable {
+    private let queue: PooledMessageQueue
+    /// Whether the block has been given up by sending.
+    private var isSent = false
+
+    /// The whole block, its size is the ``PooledMessageQueue/blockSize``.
+    public let buffer: UnsafeMutableRawBufferPointer
+    /// The count of bytes of the block in use, set it before sending.
+    public var count: Int
+
+    fileprivate init(_ block: UnsafeMutableRawPointer, count: Int, queue: PooledMessageQueue) {
+      buffer = UnsafeMutableRawBufferPointer(start: block, count: queue.blockSize)
+      self.count = count
+      self.queue = queue
+    }
+
+    /// The bytes in use.
+    public var bytes: UnsafeRawBufferPointer {
+      UnsafeRawBufferPointer(rebasing: buffer[0..<count])
+    }
+
+    /// Gives up the block without returning it to the pool.
+    fileprivate consuming func take() -> Envelope {
+      isSent = true
+      return Envelope(block: buffer.baseAddress, count: count)
+    }
+
+    deinit {
+      if !isSent {
+        PooledMessageQueue.free(buffer.baseAddress, to: queue.pool)
+      }
+    }
+  }
+
+  /// What travels through the kernel queues.
+  fileprivate struct Envelope {
+    var block: UnsafeMutableRawPointer?
+    var count: Int
+  }
+
+  private let blocks: UnsafeMutableRawPointer
+  private let queue: UnsafeRawPointer
+  private let pool: UnsafeRawPointer
+
+  /// The size of each block in bytes, a multiple of 32.
+  public let blockSize: Int
+  /// The count of blocks, the most messages in use at once.
+  public let blockCount: Int
+
+  /**
+     Creates the queue and its pool of blocks.
+
+     - Parameter blockSize: **REQUIRED** The largest message in bytes,
+        rounded up to a multiple of 32 so that each block is aligned to the
+        cache lines for DMA.
+     - Parameter blockCount: **REQUIRED** The count of blocks, shared by the
+        messages being filled, waiting in the queue and being read.
+     */
+  public init(blockSize: Int, blockCount: Int) {
+    guard blockSize > 0 && blockCount > 0 else {
+      print("error: PooledMessageQueue blockSize and blockCount must > 0")
+      fatalError()
+    }
+
+    let size = (blockSize + PooledMessageQueue.alignment - 1) & ~(PooledMessageQueue.alignment - 1)
+
+    self.blockSize = size
+    self.blockCount = blockCount
+    blocks = UnsafeMutableRawPointer.allocate(
+      byteCount: size * blockCount, alignment: PooledMessageQueue.alignment)
+    queue = swifthal_os_mq_create(MemoryLayout<Envelope>.stride, blockCount)
+    pool = swifthal_os_mq_create(MemoryLayout<Envelope>.stride, blockCount)
+
+    for index in 0..<blockCount {
+      PooledMessageQueue.free(blocks + index * size, to: pool)
+    }
+  }
+
+  deinit {
+    swifthal_os_mq_destroy(queue)
+    swifthal_os_mq_destroy(pool)
+    blocks.deallocate()
+  }
+
+  /**
+     Takes a free block from the pool.
+     - Parameter timeout: **OPTIONAL** The longest time in milliseconds to
+        wait for a block to be freed, forever by default.
+     - Returns: An empty message. Throws the error of the kernel queue,
+        such as `Errno.resourceTemporarilyUnavailable`, if no block was
+        freed in time.
+     */
+  public func allocate(timeout: Int = Int(SWIFT_FOREVER)) throws(Errno) -> Message {
+    let envelope = try PooledMessageQueue.receive(from: pool, timeout: timeout)
+    return Message(envelope.block!, count: 0, queue: self)
+  }
+
+  /**
+     Sends a message. The receiver gets the same block, nothing is copied.
+     - Parameter message: **REQUIRED** A message from ``allocate(timeout:)``
+        with its count set.
+     - Parameter timeout: **OPTIONAL** The longest time in milliseconds to
+        wait when the queue is full, forever by default. The queue holds
+        all the blocks, so it is only full while no block is free.
+     - Throws: The error of the kernel queue, such as
+        `Errno.resourceTemporarilyUnavailable` if the message couldn't be
+        queued in time. The block is then back in the pool.
+     */
+  public func send(_ message: consuming Message, timeout: Int = Int(SWIFT_FOREVER)) throws(Errno) {
+    guard message.count >= 0 && message.count <= blockSize else {
+      throw Errno.invalidArgument
+    }
+
+    var envelope = message.take()
+    let result = nothingOrErrno(
+      swifthal_os_mq_send(queue, &envelope, Int32(timeout))
+    )
+    if case .failure(let err) = result {
+      PooledMessageQueue.free(envelope.block, to: pool)
+      throw err
+    }
+  }
+
+  /**
+     Fills and sends several messages, taking each block as the previous
+     one is sent.
+     - Parameter count: **REQUIRED** The most messages to send.
+     - Parameter timeout: **OPTIONAL** The longest time in milliseconds to
+        wait for the first block, the others are only sent if free at once.
+        Forever by default.
+     - Parameter fill: **REQUIRED** Called with the index of the message and
+        its block, returns the count of bytes used.
+     - Returns: The count of messages sent.
+     */
+  @discardableResult
+  public func send(
+    count: Int,
+    timeout: Int = Int(SWIFT_FOREVER),
+    _ fill: (Int, UnsafeMutableRawBufferPointer) -> Int
+  ) throws(Errno) -> Int {
+    var sent = 0
+    while sent < count {
+      let message: Message
+      do throws(Errno) {
+        message = try allocate(timeout: sent == 0 ? timeout : 0)
+      } catch {
+        if sent == 0 {
+          throw error
+        }
+        break
+      }
+
+      var filled = consume message
+      filled.count = fill(sent, filled.buffer)
+      try send(filled, timeout: 0)
+      sent += 1
+    }
+    return sent
+  }
+
+  /**
+     Receives the oldest message.
+     - Parameter timeout: **OPTIONAL** The longest time in milliseconds to
+        wait for a message, forever by default.
+     - Returns: The message, its block goes back to the pool when it goes
+        out of scope. Throws the error of the kernel queue, such as
+        `Errno.resourceTemporarilyUnavailable`, if no message came in time.
+     */
+  public func receive(timeout: Int = Int(SWIFT_FOREVER)) throws(Errno) -> Message {
+    let envelope = try PooledMessageQueue.receive(from: queue, timeout: timeout)
+    return Message(envelope.block!, count: envelope.count, queue: self)
+  }
+
+  /**
+     Receives the waiting messages one after the other. Each block goes
+     back to the pool as soon as the body returns.
+     - Parameter maxCount: **REQUIRED** The most messages to receive.
+     - Parameter timeout: **OPTIONAL** The longest time in milliseconds to
+        wait for the first message, forever by default. The others are only
+        received if already waiting.
+     - Parameter body: **REQUIRED** Called with the bytes of each message.
+     - Returns: The count of messages received.
+     */
+  @discardableResult
+  public func receive(
+    maxCount: Int,
+    timeout: Int = Int(SWIFT_FOREVER),
+    _ body: (UnsafeRawBufferPointer) -> Void
+  ) throws(Errno) -> Int {
+    var received = 0
+    while received < maxCount {
+      let message: Message
+      do throws(Errno) {
+        message = try receive(timeout: received == 0 ? timeout : 0)
+      } catch {
+        if received == 0 {
+          throw error
+        }
+        break
+      }
+      body(message.bytes)
+      received += 1
+    }
+    return received
+  }
+
+  /**
+     Reads the oldest message and leaves it in the queue.
+
+     Only use it with a single receiver: the bytes stay valid until the
+     message is received and dropped.
+     - Returns: The bytes of the message, nil if the queue is empty.
+     */
+  public func peek() -> UnsafeRawBufferPointer? {
+    var envelope = Envelope(block: nil, count: 0)
+    guard swifthal_os_mq_peek(queue, &envelope) == 0, let block = envelope.block else {
+      return nil
+    }
+    return UnsafeRawBufferPointer(start: block, count: envelope.count)
+  }
+
+  private static func receive(from queue: UnsafeRawPointer, timeout: Int) throws(Errno) -> Envelope {
+    var envelope = Envelope(block: nil, count: 0)
+    let result = nothingOrErrno(
+      swifthal_os_mq_recv(queue, &envelope, Int32(timeout))
+    )
+    if case .failure(let err) = result {
+      throw err
+    }
+    return envelope
+  }
+
+  /// Returns a block to the pool, the pool queue always has room for it.
+  fileprivate static func free(_ block: UnsafeMutableRawPointer?, to pool: UnsafeRawPointer) {
+    var envelope = Envelope(block: block, count: 0)
+    swifthal_os_mq_send(pool, &envelope, 0)
+  }
+
+  private static let alignment = 32
+}
@@ -0,0 +1,350 @@
+//=== RingBuffer.swift ----------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The SPSCRingBuffer class passes values from one producer, such as an
+/// interrupt callback, to one consumer thread without locks or kernel
+/// calls.
+///
+/// Pushing and popping only copy the values and update an index, so they
+/// are safe in interrupt callbacks and cost far less than a
+/// ``MessageQueue``. Only one thread or callback may push, and only one
+/// thread may pop. Use ``MPSCRingBuffer`` for several producers.
+///
+/// When created with `wakeUp`, the consumer can sleep in ``wait(_:)``
+/// until the ring has values. The producer gives the semaphore only when
+/// the consumer may be waiting, not on every push.
+///
+/// ```swift
+/// let edges = SPSCRingBuffer<Int64>(capacity: 64, wakeUp: true)
+///
+/// button.setInterrupt(.rising) {
+///     edges.push(getClockCycle())
+/// }
+///
+/// while true {
+///     edges.wait()
+///     while let cycle = edges.pop() {
+///         handle(cycle)
+///     }
+/// }
+/// ```
+///
+/// The values are copied bit by bit, so the element type is
+/// `BitwiseCopyable`: integers, floats, and structs or enums of them.
+public final class SPSCRingBuffer<Element: BitwiseCopyable> {
+  private let ring: RingCore
+
+  /**
+     Creates an empty ring.
+
+     - Parameter capacity: **REQUIRED** The most values the ring holds, a
+        power of two.
+     - Parameter wakeUp: **OPTIONAL** Whether the consumer can sleep in
+        ``wait(_:)``, false by default.
+     */
+  public init(capacity: Int, wakeUp: Bool = false) {
+    ring = RingCore(
+      "SPSCRingBuffer", capacity: capacity, multipleProducers: false, wakeUp: wakeUp,
+      stride: MemoryLayout<Element>.stride, alignment: MemoryLayout<Element>.alignment)
+  }
+
+  /// The most values the ring holds.
+  public var capacity: Int { ring.capacity }
+
+  /// The count of values in the ring.
+  public var count: Int { ring.count }
+
+  /// Whether the ring has no values.
+  public var isEmpty: Bool { ring.count == 0 }
+
+  /**
+     Pushes a value, from the producer only.
+     - Parameter element: **REQUIRED** The value.
+     - Returns: Whether the value was pushed, false if the ring is full.
+     */
+  @discardableResult
+  public func push(_ element: Element) -> Bool {
+    withUnsafePointer(to: element) {
+      ring.push($0, count: 1) == 1
+    }
+  }
+
+  /**
+     Pushes several values at once, from the producer only.
+     - Parameter elements: **REQUIRED** The values.
+     - Returns: The count of values pushed from the start of `elements`,
+        less than its count if the ring is full.
+     */
+  @discardableResult
+  public func push(_ elements: UnsafeBufferPointer<Element>) -> Int {
+    guard let base = elements.baseAddress else { return 0 }
+    return ring.push(base, count: elements.count)
+  }
+
+  /**
+     Pops the oldest value, from the consumer only.
+     - Returns: The value, nil if the ring is empty.
+     */
+  public func pop() -> Element? {
+    ring.pop()?.load(as: Element.self)
+  }
+
+  /**
+     Pops several values at once, from the consumer only.
+     - Parameter buffer: **REQUIRED** The buffer for the values.
+     - Returns: The count of values popped to the start of `buffer`.
+     */
+  @discardableResult
+  public func pop(into buffer: UnsafeMutableBufferPointer<Element>) -> Int {
+    guard let base = buffer.baseAddress else { return 0 }
+    return ring.pop(into: base, count: buffer.count)
+  }
+
+  /**
+     Waits until the ring has values, from the consumer only. The ring
+     must have been created with `wakeUp`.
+     - Parameter timeout: **OPTIONAL** The longest time to wait in
+        milliseconds, forever by default.
+     - Returns: Whether the ring has values, or
+        `Errno.resourceTemporarilyUnavailable` if it stayed empty.
+     */
+  @discardableResult
+  public func wait(_ timeout: Int = Int(SWIFT_FOREVER)) -> Result<(), Errno> {
+    ring.wait(timeout)
+  }
+}
+
+/// The MPSCRingBuffer class passes values from several producers, such as
+/// interrupt callbacks of different peripherals and threads, to one
+/// consumer thread without locks or kernel calls.
+///
+/// Producers claim their slots with an atomic compare and swap, so a
+/// callback that interrupts a thread in the middle of a push never waits
+/// for it. The values of one push stay together. The consumer gets the
+/// values in the order their slots were claimed; a producer still copying
+/// its values holds back the ones pushed after it until it finishes.
+///
+/// ```swift
+/// enum Event { case rx(UInt8), edge(Int64), tick }
+/// let events = MPSCRingBuffer<Event>(capacity: 128, wakeUp: true)
+///
+/// button.setInterrupt(.rising) { events.push(.edge(getClockCycle())) }
+/// timer.setInterrupt { events.push(.tick) }
+///
+/// while true {
+///     events.wait()
+///     while let event = events.pop() {
+///         handle(event)
+///     }
+/// }
+/// ```
+///
+/// The values are copied bit by bit, so the element type is
+/// `BitwiseCopyable`: integers, floats, and structs or enums of them.
+public final class MPSCRingBuffer<Element: BitwiseCopyable> {
+  private let ring: RingCore
+
+  /**
+     Creates an empty ring.
+
+     - Parameter capacity: **REQUIRED** The most values the ring holds, a
+        power of two.
+     - Parameter wakeUp: **OPTIONAL** Whether the consumer can sleep in
+        ``wait(_:)``, false by default.
+     */
+  public init(capacity: Int, wakeUp: Bool = false) {
+    ring = RingCore(
+      "MPSCRingBuffer", capacity: capacity, multipleProducers: true, wakeUp: wakeUp,
+      stride: MemoryLayout<Element>.stride, alignment: MemoryLayout<Element>.alignment)
+  }
+
+  /// The most values the ring holds.
+  public var capacity: Int { ring.capacity }
+
+  /// The count of values claimed by producers and not popped yet.
+  public var count: Int { ring.count }
+
+  /// Whether the ring has no values.
+  public var isEmpty: Bool { ring.count == 0 }
+
+  /**
+     Pushes a value, from any thread or interrupt callback.
+     - Parameter element: **REQUIRED** The value.
+     - Returns: Whether the value was pushed, false if the ring is full.
+     */
+  @discardableResult
+  public func push(_ element: Element) -> Bool {
+    withUnsafePointer(to: element) {
+      ring.push($0, count: 1) == 1
+    }
+  }
+
+  /**
+     Pushes several values at once, from any thread or interrupt callback.
+     - Parameter elements: **REQUIRED** The values.
+     - Returns: The count of values pushed from the start of `elements`,
+        less than its count if the ring is full.
+     */
+  @discardableResult
+  public func push(_ elements: UnsafeBufferPointer<Element>) -> Int {
+    guard let base = elements.baseAddress else { return 0 }
+    return ring.push(base, count: elements.count)
+  }
+
+  /**
+     Pops the oldest value, from the consumer only.
+     - Returns: The value, nil if the ring is empty.
+     */
+  public func pop() -> Element? {
+    ring.pop()?.load(as: Element.self)
+  }
+
+  /**
+     Pops several values at once, from the consumer only.
+     - Parameter buffer: **REQUIRED** The buffer for the values.
+     - Returns: The count of values popped to the start of `buffer`.
+     */
+  @discardableResult
+  public func pop(into buffer: UnsafeMutableBufferPointer<Element>) -> Int {
+    guard let base = buffer.baseAddress else { return 0 }
+    return ring.pop(into: base, count: buffer.count)
+  }
+
+  /**
+     Waits until the ring has values, from the consumer only. The ring
+     must have been created with `wakeUp`.
+     - Parameter timeout: **OPTIONAL** The longest time to wait in
+        milliseconds, forever by default.
+     - Returns: Whether the ring has values, or
+        `Errno.resourceTemporarilyUnavailable` if it stayed empty.
+     */
+  @discardableResult
+  public func wait(_ timeout: Int = Int(SWIFT_FOREVER)) -> Result<(), Errno> {
+    ring.wait(timeout)
+  }
+}
+
+/// The part of ``SPSCRingBuffer`` and ``MPSCRingBuffer`` that doesn't depend
+/// on the type of the values: the C ring, its storage and the semaphore of
+/// the consumer.
+final class RingCore {
+  private let spsc: UnsafeMutablePointer<swift_spsc_ring_t>?
+  private let mpsc: UnsafeMutablePointer<swift_mpsc_ring_t>?
+  private let sequences: UnsafeMutablePointer<UInt32>?
+  private let storage: UnsafeMutableRawPointer
+  private let semaphore: Semaphore?
+  private let name: String
+  /// Holds the value popped by ``pop()``, only the consumer uses it.
+  private let scratch: UnsafeMutableRawPointer
+
+  let capacity: Int
+
+  init(
+    _ name: String, capacity: Int, multipleProducers: Bool, wakeUp: Bool,
+    stride: Int, alignment: Int
+  ) {
+    guard capacity > 0 && capacity & (capacity - 1) == 0 && capacity <= Int(Int32.max) else {
+      print("error: " + name + " capacity must be a power of two")
+      fatalError()
+    }
+
+    self.name = name
+    self.capacity = capacity
+    storage = UnsafeMutableRawPointer.allocate(byteCount: capacity * stride, alignment: alignment)
+    scratch = UnsafeMutableRawPointer.allocate(byteCount: stride, alignment: alignment)
+
+    if multipleProducers {
+      let sequences = UnsafeMutablePointer<UInt32>.allocate(capacity: capacity)
+      let ring = UnsafeMutablePointer<swift_mpsc_ring_t>.allocate(capacity: 1)
+      swift_mpsc_init(ring, storage, sequences, UInt32(stride), UInt32(capacity))
+      self.sequences = sequences
+      mpsc = ring
+      spsc = nil
+    } else {
+      let ring = UnsafeMutablePointer<swift_spsc_ring_t>.allocate(capacity: 1)
+      swift_spsc_init(ring, storage, UInt32(stride), UInt32(capacity))
+      sequences = nil
+      mpsc = nil
+      spsc = ring
+    }
+    semaphore = wakeUp ? Semaphore(initialCount: 0, maxCount: 1) : nil
+  }
+
+  deinit {
+    semaphore?.destroy()
+    spsc?.deallocate()
+    mpsc?.deallocate()
+    sequences?.deallocate()
+    scratch.deallocate()
+    storage.deallocate()
+  }
+
+  /// The count of values, for MPSC also the ones still being copied in.
+  var count: Int {
+    if let ring = mpsc {
+      return Int(swift_mpsc_count(ring))
+    }
+    return Int(swift_spsc_count(spsc!))
+  }
+
+  /// Whether the consumer can pop a value now.
+  private var isReady: Bool {
+    if let ring = mpsc {
+      return swift_mpsc_is_ready(ring)
+    }
+    return !swift_spsc_is_empty(spsc!)
+  }
+
+  func push(_ base: UnsafeRawPointer, count: Int) -> Int {
+    var wake = false
+    let pushed = withUnsafeMutablePointer(to: &wake) { wakePointer in
+      // Without a semaphore the ring skips the wake-up check.
+      let flag = semaphore == nil ? nil : wakePointer
+      if let ring = mpsc {
+        return swift_mpsc_push(ring, base, UInt32(count), flag)
+      }
+      return swift_spsc_push(spsc!, base, UInt32(count), flag)
+    }
+    if wake {
+      semaphore!.give()
+    }
+    return Int(pushed)
+  }
+
+  /// Pops one value into the scratch space, nil if the ring is empty.
+  func pop() -> UnsafeRawPointer? {
+    pop(into: scratch, count: 1) == 1 ? UnsafeRawPointer(scratch) : nil
+  }
+
+  func pop(into base: UnsafeMutableRawPointer, count: Int) -> Int {
+    if let ring = mpsc {
+      return Int(swift_mpsc_pop(ring, base, UInt32(count)))
+    }
+    return Int(swift_spsc_pop(spsc!, base, UInt32(count)))
+  }
+
+  func wait(_ timeout: Int) -> Result<(), Errno> {
+    guard let semaphore = semaphore else {
+      print("error: " + name + " wasn't created with wakeUp")
+      fatalError()
+    }
+    // A push the check misses gives the semaphore afterwards.
+    while !isReady {
+      if case .failure = semaphore.take(timeout), !isReady {
+        return .failure(Errno.resourceTemporarilyUnavailable)
+      }
+    }
+    return .success(())
+  }
+}
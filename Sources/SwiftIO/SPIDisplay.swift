@@ -0,0 +1,376 @@
+//=== SPIDisplay.swift ----------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The SPIDisplay class streams RGB565 frames to an SPI panel, such as
+/// ST7789 or ILI9341, without a full framebuffer.
+///
+/// A frame is rendered in horizontal strips into two small buffers. While
+/// one strip is sent with an asynchronous SPI transfer, your renderer fills
+/// the other one, so drawing and the bus run in parallel.
+///
+/// ```swift
+/// let cs = DigitalOut(Id.D0, value: true)
+/// let dc = DigitalOut(Id.D1)
+/// let spi = SPI(Id.SPI0, speed: 40_000_000, csPin: cs)
+/// let display = SPIDisplay(spi: spi, dc: dc, width: 240, height: 240)
+///
+/// // Send the init sequence of the panel with sendCommand first.
+///
+/// display.render { strip, y, height in
+///     // strip holds `height` rows of 240 pixels starting at row y.
+///     strip.update(repeating: 0x07E0)
+/// }
+/// print(display.statistics.framesPerSecond)
+/// ```
+///
+/// The controller is addressed with the MIPI DCS commands shared by
+/// ST7789, ILI9341 and most SPI panels: column address set (0x2A), row
+/// address set (0x2B) and memory write (0x2C).
+public final class SPIDisplay {
+  /// Renders `height` rows starting at row `y` into the strip. Each row
+  /// has `width` pixels of the rendered area.
+  public typealias Renderer = (
+    _ strip: UnsafeMutableBufferPointer<UInt16>, _ y: Int, _ height: Int
+  ) -> Void
+
+  /// The byte order of RGB565 pixels on the bus.
+  public enum ByteOrder {
+    /// High byte first, used by almost all SPI panels. The strips are
+    /// byte-swapped after rendering.
+    case bigEndian
+    /// Low byte first, the strips are sent as rendered.
+    case littleEndian
+  }
+
+  private let spi: SPI
+  private let dc: DigitalOut
+  private let done: Semaphore
+  private var strips: [UnsafeMutableBufferPointer<UInt16>] = []
+  private var transferPending = false
+  private var asyncSupported = true
+
+  /// The width of the panel in pixels.
+  public let width: Int
+  /// The height of the panel in pixels.
+  public let height: Int
+  /// The column of the panel memory where the visible area starts.
+  public let xOffset: Int
+  /// The row of the panel memory where the visible area starts.
+  public let yOffset: Int
+  /// The byte order of pixels on the bus.
+  public var byteOrder: ByteOrder
+
+  /// The number of rows in a strip. Taller strips mean fewer transfers but
+  /// more RAM, two strips of `width * stripHeight * 2` bytes are allocated.
+  public var stripHeight: Int {
+    didSet {
+      stripHeight = max(1, min(stripHeight, height))
+      if stripHeight != oldValue {
+        allocateStrips()
+      }
+    }
+  }
+
+  /// The frame statistics since the display was initialized or reset.
+  public private(set) var statistics = Statistics()
+
+  /// Initializes a display on an SPI bus.
+  /// - Parameters:
+  ///   - spi: **REQUIRED** The SPI bus. Create it with the cs pin so the
+  ///   pin is held low during a whole frame.
+  ///   - dc: **REQUIRED** The data/command pin, low for commands.
+  ///   - width: **REQUIRED** The width of the panel in pixels.
+  ///   - height: **REQUIRED** The height of the panel in pixels.
+  ///   - xOffset: **OPTIONAL** The first visible column of the panel memory,
+  ///   0 by default. Some 240x240 ST7789 panels need an offset.
+  ///   - yOffset: **OPTIONAL** The first visible row of the panel memory.
+  ///   - stripHeight: **OPTIONAL** The number of rows in a strip, 16 by
+  ///   default.
+  ///   - byteOrder: **OPTIONAL** The byte order of pixels on the bus,
+  ///   `.bigEndian` by default.
+  public init(
+    spi: SPI,
+    dc: DigitalOut,
+    width: Int,
+    height: Int,
+    xOffset: Int = 0,
+    yOffset: Int = 0,
+    stripHeight: Int = 16,
+    byteOrder: ByteOrder = .bigEndian
+  ) {
+    guard width > 0 && height > 0 else {
+      print("error: SPIDisplay width and height must be positive")
+      fatalError()
+    }
+
+    self.spi = spi
+    self.dc = dc
+    self.width = width
+    self.height = height
+    self.xOffset = xOffset
+    self.yOffset = yOffset
+    self.byteOrder = byteOrder
+    self.stripHeight = max(1, min(stripHeight, height))
+    done = Semaphore(initialCount: 0, maxCount: 1)
+
+    // The semaphore is given from the SPI interrupt when a strip is sent.
+    let result = nothingOrErrno(
+      swifthal_spi_async_callback_install(spi.obj, done.sem) { sem in
+        _ = swifthal_os_sem_give(sem)
+      }
+    )
+    if case .failure = result {
+      asyncSupported = false
+    }
+
+    allocateStrips()
+  }
+
+  deinit {
+    waitForTransfer()
+    swifthal_spi_async_callback_install(spi.obj, nil, nil)
+    done.destroy()
+    for strip in strips {
+      strip.deallocate()
+    }
+  }
+
+  /// Sends a command and its parameters, for example during the init
+  /// sequence of the panel.
+  /// - Parameters:
+  ///   - command: The command byte.
+  ///   - parameters: The parameter bytes sent after the command.
+  /// - Returns: Whether the command is sent. If not, it returns the
+  /// specific error.
+  @discardableResult
+  public func sendCommand(_ command: UInt8, _ parameters: [UInt8] = []) -> Result<(), Errno> {
+    waitForTransfer()
+    spi.csEnable()
+    defer { spi.csDisable() }
+    return writeCommand(command, parameters)
+  }
+
+  /// Renders and sends a whole frame strip by strip.
+  /// - Parameter renderer: Fills a strip with pixels.
+  /// - Returns: Whether the frame is sent. If not, it returns the specific
+  /// error.
+  @discardableResult
+  public func render(_ renderer: Renderer) -> Result<(), Errno> {
+    render(x: 0, y: 0, width: width, height: height, renderer)
+  }
+
+  /// Renders and sends a rectangle of the screen strip by strip.
+  ///
+  /// Only the rectangle is sent, which is much faster than a whole frame
+  /// when a small part changes. Rows of a strip have `width` pixels.
+  /// - Parameters:
+  ///   - x: The left of the rectangle.
+  ///   - y: The top of the rectangle.
+  ///   - width: The width of the rectangle.
+  ///   - height: The height of the rectangle.
+  ///   - renderer: Fills a strip with pixels, `y` is relative to the top
+  ///   of the rectangle.
+  /// - Returns: Whether the rectangle is sent. If not, it returns the
+  /// specific error.
+  @discardableResult
+  public func render(
+    x: Int, y: Int, width: Int, height: Int, _ renderer: Renderer
+  ) -> Result<(), Errno> {
+    guard x >= 0, y >= 0, width > 0, height > 0,
+      x + width <= self.width, y + height <= self.height
+    else {
+      return .failure(Errno.invalidArgument)
+    }
+
+    let frameStart = getClockCycle()
+    var renderTime: Int64 = 0
+    var bytes = 0
+
+    waitForTransfer()
+    spi.csEnable()
+    defer {
+      waitForTransfer()
+      spi.csDisable()
+    }
+
+    var result = setWindow(x: x, y: y, width: width, height: height)
+    if case .failure = result {
+      return result
+    }
+    dc.high()
+
+    // Rows that fit in a strip allocated for the full width.
+    let rowsPerStrip = max(1, stripHeight * self.width / width)
+    var row = 0
+    var index = 0
+
+    while row < height {
+      let rows = min(rowsPerStrip, height - row)
+      let count = rows * width
+      let strip = UnsafeMutableBufferPointer(rebasing: strips[index][0..<count])
+
+      let start = getClockCycle()
+      renderer(strip, row, rows)
+      if byteOrder == .bigEndian {
+        swift_raster_swap16(strip.baseAddress!, count)
+      }
+      renderTime += cyclesToNanoseconds(start: start, stop: getClockCycle())
+
+      // The other strip may still be on the bus, only one transfer at a time.
+      waitForTransfer()
+      result = startTransfer(UnsafeRawBufferPointer(strip))
+      if case .failure = result {
+        return result
+      }
+
+      bytes += count * 2
+      row += rows
+      index ^= 1
+    }
+
+    waitForTransfer()
+    statistics.record(
+      frameTime: cyclesToNanoseconds(start: frameStart, stop: getClockCycle()),
+      renderTime: renderTime, bytes: bytes, speed: spi.speed)
+    return .success(())
+  }
+
+  /// Clears the frame statistics.
+  public func resetStatistics() {
+    statistics = Statistics()
+  }
+
+  private func allocateStrips() {
+    waitForTransfer()
+    for strip in strips {
+      strip.deallocate()
+    }
+    strips = []
+    for _ in 0..<2 {
+      let strip = UnsafeMutableBufferPointer<UInt16>.allocate(capacity: width * stripHeight)
+      strip.initialize(repeating: 0)
+      strips.append(strip)
+    }
+  }
+
+  private func writeCommand(_ command: UInt8, _ parameters: [UInt8]) -> Result<(), Errno> {
+    var command = command
+    dc.low()
+    var result = nothingOrErrno(swifthal_spi_write(spi.obj, &command, 1))
+    if case .failure = result {
+      return result
+    }
+    if !parameters.isEmpty {
+      dc.high()
+      result = nothingOrErrno(swifthal_spi_write(spi.obj, parameters, parameters.count))
+    }
+    return result
+  }
+
+  private func setWindow(x: Int, y: Int, width: Int, height: Int) -> Result<(), Errno> {
+    let x0 = x + xOffset
+    let x1 = x0 + width - 1
+    let y0 = y + yOffset
+    let y1 = y0 + height - 1
+
+    var result = writeCommand(
+      SPIDisplay.columnAddressSet,
+      [UInt8(x0 >> 8), UInt8(x0 & 0xFF), UInt8(x1 >> 8), UInt8(x1 & 0xFF)])
+    if case .failure = result {
+      return result
+    }
+    result = writeCommand(
+      SPIDisplay.rowAddressSet,
+      [UInt8(y0 >> 8), UInt8(y0 & 0xFF), UInt8(y1 >> 8), UInt8(y1 & 0xFF)])
+    if case .failure = result {
+      return result
+    }
+    return writeCommand(SPIDisplay.memoryWrite, [])
+  }
+
+  private func startTransfer(_ data: UnsafeRawBufferPointer) -> Result<(), Errno> {
+    let buffer = data.baseAddress!.assumingMemoryBound(to: UInt8.self)
+
+    if asyncSupported {
+      let result = nothingOrErrno(swifthal_spi_async_write(spi.obj, buffer, data.count))
+      if case .success = result {
+        transferPending = true
+        return result
+      }
+      asyncSupported = false
+    }
+    return nothingOrErrno(swifthal_spi_write(spi.obj, buffer, data.count))
+  }
+
+  private func waitForTransfer() {
+    guard transferPending else { return }
+
+    let start = getClockCycle()
+    done.take()
+    statistics.waitTime += cyclesToNanoseconds(start: start, stop: getClockCycle())
+    transferPending = false
+  }
+
+  private static let columnAddressSet: UInt8 = 0x2A
+  private static let rowAddressSet: UInt8 = 0x2B
+  private static let memoryWrite: UInt8 = 0x2C
+}
+
+extension SPIDisplay {
+  /// The frame timing measured by ``render(_:)``, in nanoseconds.
+  public struct Statistics {
+    /// The count of rendered frames or rectangles.
+    public internal(set) var frameCount = 0
+    /// The time of the latest frame, from the window command to the end of
+    /// the last transfer.
+    public internal(set) var lastFrameTime: Int64 = 0
+    /// The time of all frames.
+    public internal(set) var totalFrameTime: Int64 = 0
+    /// The time spent in the renderer and byte swapping.
+    public internal(set) var renderTime: Int64 = 0
+    /// The time spent waiting for the bus. If it's large, the bus is the
+    /// bottleneck, otherwise the renderer is.
+    public internal(set) var waitTime: Int64 = 0
+    /// The pixel bytes sent.
+    public internal(set) var bytes = 0
+    /// The time the bus needs to send the bytes at the configured speed.
+    public internal(set) var busTime: Int64 = 0
+
+    /// The frames per second of the latest frame.
+    public var framesPerSecond: Float {
+      lastFrameTime == 0 ? 0 : 1_000_000_000 / Float(lastFrameTime)
+    }
+
+    /// The average frames per second.
+    public var averageFramesPerSecond: Float {
+      totalFrameTime == 0 ? 0 : Float(frameCount) * 1_000_000_000 / Float(totalFrameTime)
+    }
+
+    /// The fraction of the frame time the bus was busy, from 0 to 1.
+    public var busUtilization: Float {
+      totalFrameTime == 0 ? 0 : min(1, Float(busTime) / Float(totalFrameTime))
+    }
+
+    mutating func record(frameTime: Int64, renderTime: Int64, bytes: Int, speed: Int) {
+      frameCount += 1
+      lastFrameTime = frameTime
+      totalFrameTime += frameTime
+      self.renderTime += renderTime
+      self.bytes += bytes
+      if speed > 0 {
+        busTime += Int64(bytes) * 8 * 1_000_000_000 / Int64(speed)
+      }
+    }
+  }
+}
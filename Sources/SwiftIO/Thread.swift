@@ -70,9 +70,12 @@ public struct MessageQueue: @unchecked Sendable {
     )
   }
 
-  // public func peek(into data: UnsafeMutableRawPointer) {
-  //     swifthal_os_mq_peek(queue, data)
-  // }
+  @discardableResult
+  public func peek(into data: UnsafeMutableRawPointer) -> Result<(), Errno> {
+    return nothingOrErrno(
+      swifthal_os_mq_peek(queue, data)
+    )
+  }
 
   public func purge() {
     swifthal_os_mq_purge(queue)
@@ -109,3 +112,50 @@ public struct Semaphore: @unchecked Sendable {
     swifthal_os_sem_destroy(sem)
   }
 }
+
+public struct EventGroup: @unchecked Sendable {
+  let event: UnsafeRawPointer
+
+  public init() {
+    event = swifthal_os_event_create()
+  }
+
+  public var flags: UInt32 {
+    return swifthal_os_event_get(event)
+  }
+
+  // Allowed in interrupt callbacks.
+  public func set(_ flags: UInt32) {
+    swifthal_os_event_set(event, flags)
+  }
+
+  public func clear(_ flags: UInt32) {
+    swifthal_os_event_clear(event, flags)
+  }
+
+  // Returns the flags that were set when the wait ended, before clearing.
+  @discardableResult
+  public func wait(
+    anyOf flags: UInt32, clear: Bool = true, timeout: Int = Int(SWIFT_FOREVER)
+  ) -> Result<UInt32, Errno> {
+    return wait(flags, options: clear ? SWIFT_EVENT_CLEAR : 0, timeout: timeout)
+  }
+
+  @discardableResult
+  public func wait(
+    allOf flags: UInt32, clear: Bool = true, timeout: Int = Int(SWIFT_FOREVER)
+  ) -> Result<UInt32, Errno> {
+    return wait(
+      flags, options: SWIFT_EVENT_WAIT_ALL | (clear ? SWIFT_EVENT_CLEAR : 0), timeout: timeout)
+  }
+
+  public func destroy() {
+    swifthal_os_event_destroy(event)
+  }
+
+  private func wait(_ flags: UInt32, options: Int32, timeout: Int) -> Result<UInt32, Errno> {
+    var received: UInt32 = 0
+    let ret = swifthal_os_event_wait(event, flags, options, &received, Int32(timeout))
+    return valueOrErrno(received, ret)
+  }
+}
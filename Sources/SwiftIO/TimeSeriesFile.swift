@@ -0,0 +1,538 @@
+//=== TimeSeriesFile.swift ------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The TimeSeriesWriter class stores fixed-size records with a timestamp
+/// in a file that can be searched by time.
+///
+/// Records are grouped into blocks of a fixed size. Every block starts
+/// with the timestamps of its first and last record, so the block headers
+/// form a sparse index: a ``TimeSeriesReader`` finds any time in a
+/// day-long log by reading about 20 block headers instead of scanning the
+/// whole file.
+///
+/// A block is written once, when it is full or flushed, and never
+/// rewritten. A power cut during a write can only damage the block being
+/// written, never the records of earlier flushes.
+///
+/// The file is laid out as follows, all little endian:
+///
+/// | Offset                    | Bytes | Content                               |
+/// | ------------------------- | ----- | ------------------------------------- |
+/// | 0                         | 4     | "SWTS"                                |
+/// | 4                         | 4     | Record size, timestamp excluded       |
+/// | 8                         | 4     | Block size                            |
+/// | 12                        | 4     | CRC-32 of the 12 bytes above          |
+/// | 512 + i × block size      | 4     | "BLK0"                                |
+/// |                           | 4     | Count of records in the block         |
+/// |                           | 8     | Timestamp of the first record         |
+/// |                           | 8     | Timestamp of the last record          |
+/// |                           | 4     | CRC-32 of the records                 |
+/// |                           | 4     | Reserved, 0                           |
+/// | 512 + i × block size + 32 |       | Records: 8-byte timestamp and payload |
+///
+/// Timestamps must not decrease. Any unit works, milliseconds since boot
+/// or Unix time are typical.
+///
+/// ```swift
+/// let file = try FileDescriptor.open("/SD:/imu.ts", options: .create)
+/// let writer = try TimeSeriesWriter(file, recordSize: 12)
+///
+/// while true {
+///     let sample: [UInt8] = readSensor()
+///     try writer.append(timestamp: getSystemUptimeInMilliseconds(), sample)
+///     sleep(ms: 10)
+/// }
+/// ```
+public final class TimeSeriesWriter {
+  private let file: FileDescriptor
+  private let block: UnsafeMutableRawBufferPointer
+  private var blockIndex: Int
+  private var count = 0
+
+  /// The size of a record payload in bytes.
+  public let recordSize: Int
+  /// The size of a block in bytes.
+  public let blockSize: Int
+  /// The count of records a block holds.
+  public let recordsPerBlock: Int
+  /// The timestamp of the last record, nil if the file is empty.
+  public private(set) var lastTimestamp: Int64?
+
+  /**
+     Creates a writer that appends to a file.
+
+     An empty file gets a new header. An existing file must have been
+     written with the same record and block size. Records are appended in
+     a new block after the last one, and a last block left damaged by a
+     power cut is dropped.
+
+     - Parameter file: **REQUIRED** A file opened for reading and writing.
+     - Parameter recordSize: **REQUIRED** The size of a record payload.
+     - Parameter blockSize: **OPTIONAL** The size of a block, a multiple of
+        512. 4096 by default.
+     */
+  public init(_ file: FileDescriptor, recordSize: Int, blockSize: Int = 4096) throws(Errno) {
+    guard recordSize > 0, blockSize > 0, blockSize % TimeSeries.headerSize == 0,
+      blockSize >= TimeSeries.blockHeaderSize + TimeSeries.timestampSize + recordSize
+    else {
+      throw Errno.invalidArgument
+    }
+
+    self.file = file
+    self.recordSize = recordSize
+    self.blockSize = blockSize
+    recordsPerBlock =
+      (blockSize - TimeSeries.blockHeaderSize) / (TimeSeries.timestampSize + recordSize)
+    block = UnsafeMutableRawBufferPointer.allocate(byteCount: blockSize, alignment: 32)
+    block.initializeMemory(as: UInt8.self, repeating: 0)
+    blockIndex = 0
+
+    if file.size == 0 {
+      try writeFileHeader()
+      return
+    }
+
+    let layout = try TimeSeries.readFileHeader(file)
+    guard layout.recordSize == recordSize && layout.blockSize == blockSize else {
+      throw Errno.invalidArgument
+    }
+
+    // Start after the last block if it is intact, overwrite it if not.
+    let blocks = TimeSeries.blockCount(file.size, blockSize: blockSize)
+    guard blocks > 0 else { return }
+    blockIndex = blocks - 1
+    if let header = try TimeSeries.readBlock(file, blockIndex, into: block, recordSize: recordSize) {
+      lastTimestamp = header.last
+      blockIndex += 1
+      block.initializeMemory(as: UInt8.self, repeating: 0)
+    } else {
+      // The damaged block is rewritten from scratch.
+      block.initializeMemory(as: UInt8.self, repeating: 0)
+      guard blockIndex > 0 else { return }
+      let previous = try TimeSeries.readBlockHeader(file, blockIndex - 1, blockSize: blockSize)
+      lastTimestamp = previous?.last
+    }
+  }
+
+  deinit {
+    try? flush()
+    block.deallocate()
+  }
+
+  /**
+     Appends a record.
+     - Parameter timestamp: **REQUIRED** The time of the record, not earlier
+        than the previous one.
+     - Parameter record: **REQUIRED** The payload, ``recordSize`` bytes.
+     */
+  public func append(timestamp: Int64, _ record: UnsafeRawBufferPointer) throws(Errno) {
+    guard record.count == recordSize, timestamp >= (lastTimestamp ?? Int64.min) else {
+      throw Errno.invalidArgument
+    }
+
+    // A full block whose write failed before is still waiting.
+    if count == recordsPerBlock {
+      try writeBlock()
+    }
+
+    let stride = TimeSeries.timestampSize + recordSize
+    let slot = block.baseAddress! + TimeSeries.blockHeaderSize + count * stride
+    slot.storeBytes(of: timestamp.littleEndian, as: Int64.self)
+    (slot + TimeSeries.timestampSize).copyMemory(from: record.baseAddress!, byteCount: recordSize)
+
+    if count == 0 {
+      block.baseAddress!.storeBytes(
+        of: timestamp.littleEndian, toByteOffset: 8, as: Int64.self)
+    }
+    count += 1
+    lastTimestamp = timestamp
+
+    if count == recordsPerBlock {
+      try writeBlock()
+    }
+  }
+
+  /**
+     Appends a record from an array of bytes.
+     - Parameter timestamp: **REQUIRED** The time of the record.
+     - Parameter record: **REQUIRED** The payload, ``recordSize`` bytes.
+     */
+  public func append(timestamp: Int64, _ record: [UInt8]) throws(Errno) {
+    var result: Result<(), Errno> = .success(())
+    record.withUnsafeBytes { pointer in
+      do throws(Errno) {
+        try append(timestamp: timestamp, pointer)
+      } catch {
+        result = .failure(error)
+      }
+    }
+    if case .failure(let err) = result {
+      throw err
+    }
+  }
+
+  /**
+     Writes the partly filled block so its records can be read.
+
+     The block is closed and the next records start a new one, so every
+     flush takes up a whole block of the file. Flush only as often as the
+     data needs to be safe, or use smaller blocks.
+     - Parameter sync: **OPTIONAL** Whether to also flush the cache of the
+        file system to the card, false by default.
+     */
+  public func flush(sync: Bool = false) throws(Errno) {
+    if count > 0 {
+      try writeBlock()
+    }
+    if sync {
+      try file.sync()
+    }
+  }
+
+  private func writeFileHeader() throws(Errno) {
+    var header = [UInt8](repeating: 0, count: TimeSeries.headerSize)
+    header.withUnsafeMutableBytes { pointer in
+      let base = pointer.baseAddress!
+      base.storeBytes(of: TimeSeries.fileMagic.littleEndian, as: UInt32.self)
+      base.storeBytes(of: UInt32(recordSize).littleEndian, toByteOffset: 4, as: UInt32.self)
+      base.storeBytes(of: UInt32(blockSize).littleEndian, toByteOffset: 8, as: UInt32.self)
+      base.storeBytes(of: swift_crc32(0, base, 12).littleEndian, toByteOffset: 12, as: UInt32.self)
+    }
+    guard try file.write(toAbsoluteOffset: 0, header) == header.count else {
+      throw Errno.noSpace
+    }
+  }
+
+  private func writeBlock() throws(Errno) {
+    let base = block.baseAddress!
+    let length = count * (TimeSeries.timestampSize + recordSize)
+    base.storeBytes(of: TimeSeries.blockMagic.littleEndian, as: UInt32.self)
+    base.storeBytes(of: UInt32(count).littleEndian, toByteOffset: 4, as: UInt32.self)
+    base.storeBytes(of: lastTimestamp!.littleEndian, toByteOffset: 16, as: Int64.self)
+    base.storeBytes(
+      of: swift_crc32(0, base + TimeSeries.blockHeaderSize, length).littleEndian,
+      toByteOffset: 24, as: UInt32.self)
+
+    // Unused space of the block stays zero, the last block is written
+    // whole so the file always ends on a block boundary. After a failed
+    // write the block is kept, and the next append or flush writes it to
+    // the same place again.
+    let written = try file.write(
+      toAbsoluteOffset: TimeSeries.offset(of: blockIndex, blockSize: blockSize),
+      UnsafeRawBufferPointer(block))
+    if written < blockSize {
+      throw Errno.noSpace
+    }
+
+    blockIndex += 1
+    count = 0
+    block.initializeMemory(as: UInt8.self, repeating: 0)
+  }
+}
+
+/// The TimeSeriesReader class finds and reads the records of a file
+/// written by ``TimeSeriesWriter``.
+///
+/// ```swift
+/// let file = try FileDescriptor.open("/SD:/imu.ts", .readOnly)
+/// let reader = try TimeSeriesReader(file)
+/// let now = reader.lastTimestamp ?? 0
+///
+/// try reader.seek(to: now - 10 * 60 * 1000)
+/// while let record = try reader.next() {
+///     // record.timestamp, record.payload
+/// }
+/// ```
+public final class TimeSeriesReader {
+  private let file: FileDescriptor
+  private let block: UnsafeMutableRawBufferPointer
+  private var loadedIndex = -1
+  private var loadedCount = 0
+  private var blockIndex = 0
+  private var recordIndex = 0
+
+  /// The size of a record payload in bytes.
+  public let recordSize: Int
+  /// The size of a block in bytes.
+  public let blockSize: Int
+  /// The count of blocks in the file.
+  public let blockCount: Int
+
+  /// The count of block reads, headers and whole blocks.
+  public private(set) var blockReads = 0
+
+  /**
+     Opens a time series file for reading.
+     - Parameter file: **REQUIRED** A file opened for reading.
+     */
+  public init(_ file: FileDescriptor) throws(Errno) {
+    let layout = try TimeSeries.readFileHeader(file)
+
+    self.file = file
+    recordSize = layout.recordSize
+    blockSize = layout.blockSize
+    blockCount = TimeSeries.blockCount(file.size, blockSize: layout.blockSize)
+    block = UnsafeMutableRawBufferPointer.allocate(byteCount: layout.blockSize, alignment: 32)
+  }
+
+  deinit {
+    block.deallocate()
+  }
+
+  /// The timestamp of the first record, nil if the file is empty.
+  public var firstTimestamp: Int64? {
+    guard blockCount > 0 else { return nil }
+    return (try? readHeader(0))?.first
+  }
+
+  /// The timestamp of the last record, nil if the file is empty.
+  public var lastTimestamp: Int64? {
+    var index = blockCount - 1
+    while index >= 0 {
+      if let header = try? readHeader(index) {
+        return header.last
+      }
+      index -= 1
+    }
+    return nil
+  }
+
+  /**
+     Moves to the first record at or after a time.
+
+     The block is found by a binary search over the block headers, so only
+     about log2(``blockCount``) headers are read.
+     - Parameter timestamp: **REQUIRED** The time to look for.
+     */
+  public func seek(to timestamp: Int64) throws(Errno) {
+    // Find the last block starting at or before the time.
+    var low = 0
+    var high = blockCount - 1
+    var found = 0
+
+    while low <= high {
+      let middle = (low + high) / 2
+      if let header = try readHeader(middle), header.first <= timestamp {
+        found = middle
+        low = middle + 1
+      } else {
+        high = middle - 1
+      }
+    }
+
+    blockIndex = found
+    recordIndex = 0
+    guard try load(found) else { return }
+
+    // Binary search inside the block.
+    var first = 0
+    var last = loadedCount
+    while first < last {
+      let middle = (first + last) / 2
+      if self.timestamp(at: middle) < timestamp {
+        first = middle + 1
+      } else {
+        last = middle
+      }
+    }
+    recordIndex = first
+  }
+
+  /// Moves to the first record of the file.
+  public func rewind() {
+    blockIndex = 0
+    recordIndex = 0
+  }
+
+  /**
+     Returns the next record.
+
+     Damaged blocks are skipped.
+     - Returns: The timestamp and payload of the record, nil at the end of
+        the file. The payload is valid until the next call to the reader.
+     */
+  public func next() throws(Errno) -> (timestamp: Int64, payload: UnsafeRawBufferPointer)? {
+    while blockIndex < blockCount {
+      if try load(blockIndex), recordIndex < loadedCount {
+        let stride = TimeSeries.timestampSize + recordSize
+        let slot = block.baseAddress! + TimeSeries.blockHeaderSize + recordIndex * stride
+        recordIndex += 1
+        return (
+          timestamp(at: recordIndex - 1),
+          UnsafeRawBufferPointer(start: slot + TimeSeries.timestampSize, count: recordSize)
+        )
+      }
+      blockIndex += 1
+      recordIndex = 0
+    }
+    return nil
+  }
+
+  /**
+     Calls a closure for each record in a time range.
+     - Parameter start: **REQUIRED** The earliest time, included.
+     - Parameter end: **REQUIRED** The latest time, included.
+     - Parameter body: **REQUIRED** Called with the timestamp and payload of
+        each record. Return false to stop early.
+     */
+  public func forEach(
+    from start: Int64, through end: Int64,
+    _ body: (Int64, UnsafeRawBufferPointer) -> Bool
+  ) throws(Errno) {
+    try seek(to: start)
+    while let record = try next(), record.timestamp <= end {
+      if !body(record.timestamp, record.payload) {
+        return
+      }
+    }
+  }
+
+  /// Clears the statistics.
+  public func resetStatistics() {
+    blockReads = 0
+  }
+
+  private func readHeader(_ index: Int) throws(Errno) -> (count: Int, first: Int64, last: Int64)? {
+    blockReads += 1
+    return try TimeSeries.readBlockHeader(file, index, blockSize: blockSize)
+  }
+
+  /// Reads a block unless it is already loaded. Returns false if it is
+  /// damaged.
+  private func load(_ index: Int) throws(Errno) -> Bool {
+    if index == loadedIndex {
+      return true
+    }
+    loadedIndex = -1
+    blockReads += 1
+    guard let header = try TimeSeries.readBlock(file, index, into: block, recordSize: recordSize)
+    else {
+      return false
+    }
+    loadedIndex = index
+    loadedCount = header.count
+    return true
+  }
+
+  private func timestamp(at index: Int) -> Int64 {
+    let stride = TimeSeries.timestampSize + recordSize
+    return Int64(
+      littleEndian: block.loadUnaligned(
+        fromByteOffset: TimeSeries.blockHeaderSize + index * stride, as: Int64.self))
+  }
+}
+
+/// The file format shared by the writer and the reader.
+enum TimeSeries {
+  static let headerSize = 512
+  static let blockHeaderSize = 32
+  static let timestampSize = 8
+  /// "SWTS" and "BLK0" read as little endian integers.
+  static let fileMagic: UInt32 = 0x5354_5753
+  static let blockMagic: UInt32 = 0x304B_4C42
+
+  static func offset(of block: Int, blockSize: Int) -> Int {
+    headerSize + block * blockSize
+  }
+
+  static func blockCount(_ fileSize: Int, blockSize: Int) -> Int {
+    fileSize > headerSize ? (fileSize - headerSize + blockSize - 1) / blockSize : 0
+  }
+
+  static func readFileHeader(_ file: FileDescriptor) throws(Errno)
+    -> (recordSize: Int, blockSize: Int)
+  {
+    var header = [UInt8](repeating: 0, count: 16)
+    guard try file.read(fromAbsoluteOffest: 0, into: &header) == header.count else {
+      throw Errno.invalidArgument
+    }
+
+    let layout: (recordSize: Int, blockSize: Int)? = header.withUnsafeBytes { pointer in
+      let magic = UInt32(littleEndian: pointer.loadUnaligned(as: UInt32.self))
+      // A damaged header may hold sizes that don't fit an Int on 32-bit
+      // boards, they are then negative and rejected.
+      let recordSize = Int(
+        truncatingIfNeeded: UInt32(
+          littleEndian: pointer.loadUnaligned(fromByteOffset: 4, as: UInt32.self)))
+      let blockSize = Int(
+        truncatingIfNeeded: UInt32(
+          littleEndian: pointer.loadUnaligned(fromByteOffset: 8, as: UInt32.self)))
+      let crc = UInt32(littleEndian: pointer.loadUnaligned(fromByteOffset: 12, as: UInt32.self))
+      guard magic == fileMagic, crc == swift_crc32(0, pointer.baseAddress, 12),
+        recordSize > 0, blockSize > blockHeaderSize + timestampSize,
+        recordSize <= blockSize - blockHeaderSize - timestampSize
+      else {
+        return nil
+      }
+      return (recordSize, blockSize)
+    }
+
+    guard let layout = layout else {
+      throw Errno.invalidArgument
+    }
+    return layout
+  }
+
+  /// Reads the header of a block, nil if it isn't a valid block.
+  static func readBlockHeader(_ file: FileDescriptor, _ index: Int, blockSize: Int) throws(Errno)
+    -> (count: Int, first: Int64, last: Int64)?
+  {
+    var header = [UInt8](repeating: 0, count: blockHeaderSize)
+    guard
+      try file.read(fromAbsoluteOffest: offset(of: index, blockSize: blockSize), into: &header)
+        == header.count
+    else {
+      return nil
+    }
+    return header.withUnsafeBytes { parseBlockHeader($0) }
+  }
+
+  /// Reads a whole block and checks its records, nil if it is damaged.
+  static func readBlock(
+    _ file: FileDescriptor, _ index: Int, into block: UnsafeMutableRawBufferPointer, recordSize: Int
+  ) throws(Errno) -> (count: Int, first: Int64, last: Int64)? {
+    let read = try file.read(
+      fromAbsoluteOffest: offset(of: index, blockSize: block.count), into: block)
+    guard read >= blockHeaderSize,
+      let header = parseBlockHeader(UnsafeRawBufferPointer(block)),
+      header.count <= (block.count - blockHeaderSize) / (timestampSize + recordSize)
+    else {
+      return nil
+    }
+
+    let length = header.count * (timestampSize + recordSize)
+    let crc = UInt32(littleEndian: block.loadUnaligned(fromByteOffset: 24, as: UInt32.self))
+    guard blockHeaderSize + length <= read,
+      swift_crc32(0, block.baseAddress! + blockHeaderSize, length) == crc
+    else {
+      return nil
+    }
+    return header
+  }
+
+  private static func parseBlockHeader(_ header: UnsafeRawBufferPointer)
+    -> (count: Int, first: Int64, last: Int64)?
+  {
+    let magic = UInt32(littleEndian: header.loadUnaligned(as: UInt32.self))
+    let count = Int(
+      truncatingIfNeeded: UInt32(
+        littleEndian: header.loadUnaligned(fromByteOffset: 4, as: UInt32.self)))
+    let first = Int64(littleEndian: header.loadUnaligned(fromByteOffset: 8, as: Int64.self))
+    let last = Int64(littleEndian: header.loadUnaligned(fromByteOffset: 16, as: Int64.self))
+    guard magic == blockMagic, count > 0, first <= last else {
+      return nil
+    }
+    return (count, first, last)
+  }
+}
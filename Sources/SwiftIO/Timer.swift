@@ -132,6 +132,18 @@ public final class Timer {
     }
   }
 
+  /// Sets flags of an event group each time the time is up, so a thread
+  /// can wait for this timer together with other events.
+  /// - Parameters:
+  ///   - start: Whether to start the timer once it's set, true by default.
+  ///   - flags: The flags to set.
+  ///   - group: The event group the thread waits on.
+  public func setInterrupt(start: Bool = true, post flags: UInt32, to group: EventGroup) {
+    setInterrupt(start: start) {
+      group.set(flags)
+    }
+  }
+
   /// Starts the timer and reset its status to zero.
   /// - Parameters:
   ///   - mode: The mode of the timer. If it's nil, it adopts the mode set
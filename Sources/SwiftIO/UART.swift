@@ -214,6 +214,32 @@ public final class UART {
     return Int(swifthal_uart_remainder_get(obj))
   }
 
+  /**
+     Sets flags of an event group each time data is received, so a thread
+     can wait for incoming data together with other events.
+
+     The flags are set from the receive interrupt as soon as bytes arrive in
+     the buffer, then the thread reads them as usual.
+     - Parameter flags: The flags to set.
+     - Parameter group: The event group the thread waits on, nil to stop
+     setting the flags.
+     - Returns: Whether the configuration succeeds. If not, it returns the
+     specific error.
+     */
+  @discardableResult
+  public func setReceiveEvent(post flags: UInt32, to group: EventGroup?) -> Result<(), Errno> {
+    let result = nothingOrErrno(
+      swifthal_uart_rx_event_set(obj, group?.event, flags)
+    )
+
+    if case .failure(let err) = result {
+      let errDescription = err.description
+      print("error: \(self).\(#function) line \(#line) -> " + errDescription)
+    }
+
+    return result
+  }
+
   /// Writes a byte to the external device through the serial connection.
   /// - Parameter byte: A UInt8 to be sent to the device.
   /// - Returns: Whether the communication succeeds. If not, it returns the
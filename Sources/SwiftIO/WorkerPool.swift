@@ -0,0 +1,300 @@
+//=== WorkerPool.swift ----------------------------------------------------===//
+//
+// Copyright (c) MadMachine Limited
+// Licensed under MIT License
+//
+// Authors: Andy Liu
+// Created: 10/18/2026
+//
+// See https://madmachine.io for more information
+//
+//===----------------------------------------------------------------------===//
+
+import CSwiftIO
+
+/// The WorkerPool class runs short jobs on a few shared threads instead of
+/// a thread, and a stack, per job.
+///
+/// Jobs are queued by priority. Whenever a worker is free it takes the
+/// oldest job of the highest priority that has one, so a burst of low
+/// priority jobs never delays a high priority one by more than the job a
+/// worker is already running. Each priority has a queue of its own with
+/// its own depth, so low priority jobs can't fill the slots of high
+/// priority ones.
+///
+/// A job is a Swift closure or a C function with an argument. Submitting
+/// returns a ``WorkItem``, a future of the value the closure returns or
+/// the error it throws.
+///
+/// ```swift
+/// let pool = WorkerPool(workerCount: 3)
+///
+/// try pool.submit(.high) {
+///     handleCommand()
+/// }
+/// let upload = try pool.submit(.low) { () throws(Errno) -> Int in
+///     try uploadLogs()
+/// }
+/// let sent = try upload.wait().get()
+/// print(pool.statistics(for: .high).maxLatency)
+/// ```
+///
+/// Jobs should not block for long or wait on other jobs of the same pool,
+/// as a busy worker serves no other queue.
+public final class WorkerPool {
+  /// The priority of a job. Workers always take high priority jobs first.
+  public enum Priority: Int {
+    case high = 0
+    case normal
+    case low
+  }
+
+  /// A C function run as a job, with the argument given when submitting.
+  public typealias Function = @convention(c) (UnsafeMutableRawPointer?) -> Void
+
+  /// Statistics of the queue of one priority.
+  public typealias Statistics = QueueStatistics
+
+  /// A queued job and the future of its result.
+  public final class WorkItem<Value> {
+    private let done = Semaphore(initialCount: 0, maxCount: 1)
+
+    /// The priority the job was submitted with.
+    public let priority: Priority
+    /// The value returned or the error thrown by the job, nil until it has
+    /// run.
+    public private(set) var result: Result<Value, Errno>? = nil
+    /// The time in milliseconds from submitting to completion.
+    public private(set) var latency: Int64 = 0
+
+    fileprivate init(_ priority: Priority) {
+      self.priority = priority
+    }
+
+    deinit {
+      done.destroy()
+    }
+
+    /// Whether the job has run.
+    public var isDone: Bool { result != nil }
+
+    /**
+       Waits for the job to run.
+       - Parameter timeout: **OPTIONAL** The longest time to wait in
+          milliseconds, forever by default.
+       - Returns: The result of the job, or
+          `Errno.resourceTemporarilyUnavailable` if it didn't run in time.
+       */
+    @discardableResult
+    public func wait(_ timeout: Int = Int(SWIFT_FOREVER)) -> Result<Value, Errno> {
+      if let result = result {
+        return result
+      }
+      if case .failure = done.take(timeout) {
+        return .failure(Errno.resourceTemporarilyUnavailable)
+      }
+      done.give()
+      return result!
+    }
+
+    fileprivate func complete(_ result: Result<Value, Errno>, submitTime: Int64) {
+      latency = getSystemUptimeInMilliseconds() - submitTime
+      self.result = result
+      done.give()
+    }
+  }
+
+  /// A queued job with the type of its result erased.
+  private struct Job {
+    /// Runs the job and completes its item, given the submit time. Returns
+    /// whether the job succeeded.
+    let run: (Int64) -> Bool
+    let submitTime: Int64
+  }
+
+  private let queues: [BoundedQueue<Job>]
+  private let lock = Mutex()
+  /// Counts the jobs of all queues, a worker takes one before dequeuing.
+  private let pending: Semaphore
+
+  /// The count of worker threads.
+  public let workerCount: Int
+  /// The most jobs each priority queue holds.
+  public let depth: Int
+
+  /**
+     Creates the pool and starts its workers.
+
+     - Parameter workerCount: **OPTIONAL** The count of worker threads, 2
+        by default. Keep in mind the system supports up to 16 threads.
+     - Parameter depth: **OPTIONAL** The most jobs waiting in each priority
+        queue, 16 by default.
+     - Parameter priority: **OPTIONAL** The thread priority of the workers,
+        10 by default.
+     - Parameter stackSize: **OPTIONAL** The stack size of each worker in
+        bytes, large enough for the deepest job. 2048 by default.
+     */
+  public init(workerCount: Int = 2, depth: Int = 16, priority: Int = 10, stackSize: Int = 2048) {
+    guard workerCount > 0 && depth > 0 else {
+      print("error: WorkerPool workerCount and depth must > 0")
+      fatalError()
+    }
+
+    self.workerCount = workerCount
+    self.depth = depth
+    queues = [
+      BoundedQueue(depth: depth),
+      BoundedQueue(depth: depth),
+      BoundedQueue(depth: depth),
+    ]
+    pending = Semaphore(initialCount: 0, maxCount: depth * WorkerPool.priorityCount)
+
+    // The pool lives as long as its workers, which never end.
+    for _ in 0..<workerCount {
+      createThread(
+        name: "swiftio_worker",
+        priority: priority,
+        stackSize: stackSize,
+        p1: Unmanaged.passRetained(self).toOpaque()
+      ) { p1, _, _ in
+        Unmanaged<WorkerPool>.fromOpaque(p1!).takeUnretainedValue().run()
+      }
+    }
+  }
+
+  /**
+     Queues a closure.
+
+     - Parameter priority: **OPTIONAL** The queue to use, `.normal` by
+        default.
+     - Parameter timeout: **OPTIONAL** The longest time in milliseconds to
+        wait for a free slot when the queue is full, forever by default.
+     - Parameter work: **REQUIRED** The job, run once on a worker thread.
+        What it returns or throws is the result of the item.
+     - Returns: The queued job, to wait on or check later.
+     */
+  @discardableResult
+  public func submit<Value>(
+    _ priority: Priority = .normal,
+    timeout: Int = Int(SWIFT_FOREVER),
+    _ work: @escaping () throws(Errno) -> Value
+  ) throws(Errno) -> WorkItem<Value> {
+    let item = WorkItem<Value>(priority)
+    try enqueue(priority, timeout: timeout) { submitTime in
+      let result: Result<Value, Errno>
+      do throws(Errno) {
+        result = .success(try work())
+      } catch {
+        result = .failure(error)
+      }
+      item.complete(result, submitTime: submitTime)
+      if case .failure = result {
+        return false
+      }
+      return true
+    }
+    return item
+  }
+
+  /**
+     Queues a C function, for work items shared with C code.
+
+     - Parameter priority: **OPTIONAL** The queue to use, `.normal` by
+        default.
+     - Parameter timeout: **OPTIONAL** The longest time in milliseconds to
+        wait for a free slot when the queue is full, forever by default.
+     - Parameter function: **REQUIRED** The function run on a worker thread.
+     - Parameter argument: **OPTIONAL** Passed to the function, it must stay
+        valid until the job has run.
+     - Returns: The queued job, to wait on or check later.
+     */
+  @discardableResult
+  public func submit(
+    _ priority: Priority = .normal,
+    timeout: Int = Int(SWIFT_FOREVER),
+    function: Function,
+    argument: UnsafeMutableRawPointer? = nil
+  ) throws(Errno) -> WorkItem<()> {
+    try submit(priority, timeout: timeout) {
+      function(argument)
+    }
+  }
+
+  /**
+     The count of jobs waiting in a queue.
+     - Parameter priority: **REQUIRED** The queue.
+     */
+  public func pendingCount(for priority: Priority) -> Int {
+    lock.lock()
+    defer { lock.unlock() }
+    return queues[priority.rawValue].count
+  }
+
+  /**
+     The statistics of a queue since creation or the last reset.
+     - Parameter priority: **REQUIRED** The queue.
+     */
+  public func statistics(for priority: Priority) -> Statistics {
+    lock.lock()
+    defer { lock.unlock() }
+    return queues[priority.rawValue].statistics
+  }
+
+  /// Clears the statistics of all queues.
+  public func resetStatistics() {
+    lock.lock()
+    for index in 0..<WorkerPool.priorityCount {
+      queues[index].statistics = Statistics()
+    }
+    lock.unlock()
+  }
+
+  private func enqueue(_ priority: Priority, timeout: Int, _ run: @escaping (Int64) -> Bool)
+    throws(Errno)
+  {
+    let index = priority.rawValue
+
+    guard queues[index].reserve(timeout) else {
+      lock.lock()
+      queues[index].statistics.rejected += 1
+      lock.unlock()
+      throw Errno.resourceTemporarilyUnavailable
+    }
+
+    lock.lock()
+    queues[index].push(Job(run: run, submitTime: getSystemUptimeInMilliseconds()))
+    lock.unlock()
+
+    pending.give()
+  }
+
+  /// Takes the oldest job of the highest priority queue that has one.
+  private func dequeue() -> (job: Job, index: Int) {
+    lock.lock()
+    defer { lock.unlock() }
+
+    var index = 0
+    while queues[index].count == 0 {
+      index += 1
+    }
+    return (queues[index].pop()!, index)
+  }
+
+  private func run() -> Never {
+    while true {
+      pending.take()
+      let (job, index) = dequeue()
+
+      let start = getSystemUptimeInMilliseconds()
+      let succeeded = job.run(job.submitTime)
+      let stop = getSystemUptimeInMilliseconds()
+
+      lock.lock()
+      queues[index].didComplete(
+        latency: stop - job.submitTime, serviceTime: stop - start, failed: !succeeded)
+      lock.unlock()
+    }
+  }
+
+  private static let priorityCount = 3
+}
@@ -0,0 +1,353 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Check and benchmark of the audio decoders in swift_audio_codec.c, run on
+ * the host.
+ *
+ * The G.711 tables are compared entry by entry with the segment arithmetic
+ * of the ITU reference, and decoded in place as AudioDecoder does. IMA-ADPCM
+ * blocks of a sweep are made by a reference encoder in the WAV layout, mono
+ * and stereo, and the decoder must give back exactly the samples the
+ * encoder predicted, short last blocks included.
+ *
+ * The benchmark prints the decode time per second of audio and how many
+ * times faster than real time it runs.
+ *
+ *	gcc -O2 -I Sources/CSwiftIO/include Sources/CSwiftIO/swift_audio_codec.c \
+ *		Tests/Host/swift_audio_codec_bench.c -lm -o codec_bench && ./codec_bench
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "swift_audio_codec.h"
+
+#define BLOCK_SIZE	1024
+#define BENCH_SECONDS	60
+
+/* ITU-T G.711 expansion, as in the reference implementation */
+static int16_t ulaw_reference(uint8_t code)
+{
+	int t;
+
+	code = (uint8_t)~code;
+	t = ((code & 0x0F) << 3) + 0x84;
+	t <<= (code & 0x70) >> 4;
+	return (int16_t)((code & 0x80) ? 0x84 - t : t - 0x84);
+}
+
+static int16_t alaw_reference(uint8_t code)
+{
+	int t, seg;
+
+	code ^= 0x55;
+	t = (code & 0x0F) << 4;
+	seg = (code & 0x70) >> 4;
+	switch (seg) {
+	case 0:
+		t += 8;
+		break;
+	case 1:
+		t += 0x108;
+		break;
+	default:
+		t += 0x108;
+		t <<= seg - 1;
+		break;
+	}
+	return (int16_t)((code & 0x80) ? t : -t);
+}
+
+static int check_g711(void)
+{
+	uint8_t codes[256];
+	int16_t samples[256];
+
+	for (int i = 0; i < 256; i++) {
+		codes[i] = (uint8_t)i;
+	}
+	swift_audio_ulaw_decode(samples, codes, 256);
+	for (int i = 0; i < 256; i++) {
+		if (samples[i] != ulaw_reference((uint8_t)i)) {
+			printf("u-law %02x: %d instead of %d\n", i, samples[i],
+			       ulaw_reference((uint8_t)i));
+			return 1;
+		}
+	}
+	swift_audio_alaw_decode(samples, codes, 256);
+	for (int i = 0; i < 256; i++) {
+		if (samples[i] != alaw_reference((uint8_t)i)) {
+			printf("A-law %02x: %d instead of %d\n", i, samples[i],
+			       alaw_reference((uint8_t)i));
+			return 1;
+		}
+	}
+
+	/* In place, the codes in the second half of the samples */
+	memcpy((uint8_t *)samples + 128, codes, 128);
+	swift_audio_ulaw_decode(samples, (uint8_t *)samples + 128, 128);
+	for (int i = 0; i < 128; i++) {
+		if (samples[i] != ulaw_reference((uint8_t)i)) {
+			printf("u-law in place %02x: %d\n", i, samples[i]);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static const int16_t step_table[89] = {
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37,
+	41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173,
+	190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+	724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+	2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484,
+	7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818,
+	18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t index_table[16] = {
+	-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+struct encoder {
+	int32_t predictor;
+	int32_t index;
+};
+
+/* Encodes one sample and updates the prediction the decoder will make */
+static uint8_t ima_encode(struct encoder *enc, int16_t sample)
+{
+	int32_t step = step_table[enc->index];
+	int32_t diff = sample - enc->predictor;
+	int32_t delta = step >> 3;
+	uint8_t nibble = 0;
+
+	if (diff < 0) {
+		nibble = 8;
+		diff = -diff;
+	}
+	if (diff >= step) {
+		nibble |= 4;
+		diff -= step;
+		delta += step;
+	}
+	step >>= 1;
+	if (diff >= step) {
+		nibble |= 2;
+		diff -= step;
+		delta += step;
+	}
+	step >>= 1;
+	if (diff >= step) {
+		nibble |= 1;
+		delta += step;
+	}
+
+	enc->predictor += (nibble & 8) ? -delta : delta;
+	if (enc->predictor > INT16_MAX) {
+		enc->predictor = INT16_MAX;
+	} else if (enc->predictor < INT16_MIN) {
+		enc->predictor = INT16_MIN;
+	}
+	enc->index += index_table[nibble];
+	if (enc->index < 0) {
+		enc->index = 0;
+	} else if (enc->index > 88) {
+		enc->index = 88;
+	}
+	return nibble;
+}
+
+/*
+ * Encodes frames into one WAV block, the decoded samples the encoder
+ * predicted go to expect. Returns the size of the block.
+ */
+static int ima_encode_block(uint8_t *block, int16_t *expect, const int16_t *src,
+			    int frames, int channels, struct encoder *enc)
+{
+	int groups = (frames - 1) / 8;
+	uint8_t *data = block + 4 * channels;
+
+	for (int ch = 0; ch < channels; ch++) {
+		enc[ch].predictor = src[ch];
+		block[4 * ch] = (uint8_t)src[ch];
+		block[4 * ch + 1] = (uint8_t)((uint16_t)src[ch] >> 8);
+		block[4 * ch + 2] = (uint8_t)enc[ch].index;
+		block[4 * ch + 3] = 0;
+		expect[ch] = src[ch];
+	}
+	for (int g = 0; g < groups; g++) {
+		for (int ch = 0; ch < channels; ch++) {
+			for (int k = 0; k < 8; k++) {
+				int frame = 1 + g * 8 + k;
+				uint8_t nibble = ima_encode(&enc[ch], src[frame * channels + ch]);
+
+				if (k % 2 == 0) {
+					data[k / 2] = nibble;
+				} else {
+					data[k / 2] |= (uint8_t)(nibble << 4);
+				}
+				expect[frame * channels + ch] = (int16_t)enc[ch].predictor;
+			}
+			data += 4;
+		}
+	}
+	return (int)(data - block);
+}
+
+/* A sweep from 100 Hz to 4 kHz, the channels a quarter period apart */
+static void make_sweep(int16_t *samples, int frames, int channels, int rate)
+{
+	double phase = 0;
+
+	for (int i = 0; i < frames; i++) {
+		double frequency = 100 + 3900.0 * i / frames;
+
+		phase += 2 * M_PI * frequency / rate;
+		for (int ch = 0; ch < channels; ch++) {
+			samples[i * channels + ch] = (int16_t)(20000 * sin(phase + ch * M_PI / 2));
+		}
+	}
+}
+
+static int check_ima(int channels)
+{
+	const int block_frames = (int)swift_audio_ima_block_frames(BLOCK_SIZE, channels);
+	const int blocks = 20;
+	/* The last block is cut short like the end of a file */
+	const int frames = block_frames * (blocks - 1) + 1 + 8 * 5;
+	int16_t *src = malloc(sizeof(int16_t) * (size_t)(frames * channels));
+	int16_t *expect = malloc(sizeof(int16_t) * (size_t)(block_frames * channels));
+	int16_t *out = malloc(sizeof(int16_t) * (size_t)(block_frames * channels));
+	uint8_t block[BLOCK_SIZE];
+	struct encoder enc[2] = { { 0, 0 }, { 0, 0 } };
+	double signal = 0, noise = 0;
+	int err = 0;
+
+	make_sweep(src, frames, channels, 16000);
+	for (int b = 0; b < blocks && err == 0; b++) {
+		int first = b * block_frames;
+		int count = frames - first < block_frames ? frames - first : block_frames;
+		int size = ima_encode_block(block, expect, src + first * channels, count,
+					    channels, enc);
+		ssize_t decoded = swift_audio_ima_decode_block(out, block, size, channels);
+
+		if (decoded != count) {
+			printf("IMA %d ch block %d: %zd frames instead of %d\n",
+			       channels, b, decoded, count);
+			err = 1;
+			break;
+		}
+		for (int i = 0; i < count * channels; i++) {
+			double e = out[i] - src[first * channels + i];
+
+			if (out[i] != expect[i]) {
+				printf("IMA %d ch block %d sample %d: %d instead of %d\n",
+				       channels, b, i, out[i], expect[i]);
+				err = 1;
+				break;
+			}
+			signal += (double)src[first * channels + i] * src[first * channels + i];
+			noise += e * e;
+		}
+	}
+	if (err == 0) {
+		printf("IMA-ADPCM %d ch: bit exact, SNR %.1f dB\n", channels,
+		       10 * log10(signal / noise));
+	}
+	free(src);
+	free(expect);
+	free(out);
+	return err;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, double seconds)
+{
+	printf("%-22s %6.1f us per second of audio, %6.0fx real time\n", name,
+	       seconds / BENCH_SECONDS * 1e6, BENCH_SECONDS / seconds);
+}
+
+static void bench_g711(const char *name, int rate,
+		       void (*decode)(int16_t *, const uint8_t *, ssize_t))
+{
+	const int count = rate * BENCH_SECONDS;
+	uint8_t *codes = malloc((size_t)count);
+	int16_t *samples = malloc(sizeof(int16_t) * (size_t)count);
+	double start;
+
+	for (int i = 0; i < count; i++) {
+		codes[i] = (uint8_t)(i * 37 + (i >> 5));
+	}
+	start = now();
+	/* In blocks of 512 like AudioDecoder */
+	for (int i = 0; i < count; i += 512) {
+		decode(samples + i, codes + i, count - i < 512 ? count - i : 512);
+	}
+	report(name, now() - start);
+	free(codes);
+	free(samples);
+}
+
+static void bench_ima(const char *name, int rate, int channels)
+{
+	const int block_frames = (int)swift_audio_ima_block_frames(BLOCK_SIZE, channels);
+	const int blocks = (rate * BENCH_SECONDS + block_frames - 1) / block_frames;
+	int16_t *src = malloc(sizeof(int16_t) * (size_t)(block_frames * channels));
+	int16_t *expect = malloc(sizeof(int16_t) * (size_t)(block_frames * channels));
+	int16_t *out = malloc(sizeof(int16_t) * (size_t)(block_frames * channels));
+	uint8_t *data = malloc((size_t)blocks * BLOCK_SIZE);
+	struct encoder enc[2] = { { 0, 0 }, { 0, 0 } };
+	double start;
+
+	make_sweep(src, block_frames, channels, rate);
+	for (int b = 0; b < blocks; b++) {
+		ima_encode_block(data + b * BLOCK_SIZE, expect, src, block_frames,
+				 channels, enc);
+	}
+	start = now();
+	for (int b = 0; b < blocks; b++) {
+		swift_audio_ima_decode_block(out, data + b * BLOCK_SIZE, BLOCK_SIZE, channels);
+	}
+	report(name, now() - start);
+	free(src);
+	free(expect);
+	free(out);
+	free(data);
+}
+
+int main(void)
+{
+	int err = check_g711();
+
+	if (err == 0) {
+		printf("G.711 tables match the reference\n");
+		err = check_ima(1);
+	}
+	if (err == 0) {
+		err = check_ima(2);
+	}
+	if (err != 0) {
+		return err;
+	}
+
+	bench_g711("u-law 8 kHz mono", 8000, swift_audio_ulaw_decode);
+	bench_g711("A-law 16 kHz mono", 16000, swift_audio_alaw_decode);
+	bench_ima("IMA 16 kHz mono", 16000, 1);
+	bench_ima("IMA 44.1 kHz stereo", 44100, 2);
+	return 0;
+}
@@ -0,0 +1,268 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Check and benchmark of the resampler in swift_audio_resample.c, run on
+ * the host.
+ *
+ * For each quality and a few common rate pairs, a tone is resampled and
+ * compared with the ideal tone at the output rate. The first output must
+ * line up with the first input, so any delay shows up as a low SNR. The
+ * SNR is bounded by the nearest-phase lookup, about 6 dB more per doubling
+ * of the phases. A tone above the output Nyquist frequency must be
+ * attenuated when downsampling by 2 or more, closer ratios leave it in
+ * the transition band. The same stream fed in random block sizes must
+ * give the same samples as in one block, as the history is kept across
+ * calls.
+ *
+ * The benchmark prints the cost per output sample of each quality, in
+ * nanoseconds and in cycles of the time stamp counter on x86.
+ *
+ *	gcc -O2 -I Sources/CSwiftIO/include Sources/CSwiftIO/swift_audio_resample.c \
+ *		Tests/Host/swift_audio_resample_bench.c -lm -o resample_bench && \
+ *		./resample_bench
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "swift_audio_resample.h"
+
+#define INPUT_FRAMES	44100
+#define BENCH_FRAMES	(48000 * 10)
+
+struct tier {
+	const char *name;
+	swift_audio_resample_quality_t quality;
+	/* Least SNR in dB of an in-band tone */
+	double min_snr;
+	/* Least attenuation in dB of a tone above the output Nyquist */
+	double min_rejection;
+};
+
+static const struct tier tiers[] = {
+	{ "fast", SWIFT_AUDIO_RESAMPLE_FAST, 28, 0 },
+	{ "medium", SWIFT_AUDIO_RESAMPLE_MEDIUM, 36, 18 },
+	{ "high", SWIFT_AUDIO_RESAMPLE_HIGH, 45, 60 },
+};
+
+static const int rates[][2] = {
+	{ 11025, 16000 },
+	{ 22050, 48000 },
+	{ 44100, 16000 },
+	{ 48000, 44100 },
+};
+
+static void *create(const struct tier *tier, int in_rate, int out_rate, int channels)
+{
+	ssize_t size = swift_audio_resampler_size(tier->quality, channels);
+	void *mem = malloc((size_t)size);
+
+	return swift_audio_resampler_init(mem, size, in_rate, out_rate, tier->quality,
+					  channels);
+}
+
+static void make_tone(int16_t *samples, int frames, int channels, double frequency,
+		      int rate)
+{
+	for (int i = 0; i < frames; i++) {
+		for (int ch = 0; ch < channels; ch++) {
+			samples[i * channels + ch] =
+				(int16_t)lrint(16000 * sin(2 * M_PI * frequency * i / rate + ch));
+		}
+	}
+}
+
+/* Resamples a whole buffer in one call, returns the output frames */
+static ssize_t run(void *rs, const int16_t *in, ssize_t in_frames, int16_t *out,
+		   ssize_t out_capacity)
+{
+	ssize_t consumed = in_frames, produced = out_capacity;
+
+	swift_audio_resampler_process(rs, in, &consumed, out, &produced);
+	return produced;
+}
+
+/* SNR of the output against the ideal tone, skipping the warm-up */
+static double tone_snr(const int16_t *out, ssize_t frames, int channels,
+		       double frequency, int out_rate)
+{
+	double signal = 0, noise = 0;
+
+	for (ssize_t i = 64; i < frames - 64; i++) {
+		for (int ch = 0; ch < channels; ch++) {
+			double ideal = 16000 * sin(2 * M_PI * frequency * i / out_rate + ch);
+			double e = out[i * channels + ch] - ideal;
+
+			signal += ideal * ideal;
+			noise += e * e;
+		}
+	}
+	return 10 * log10(signal / noise);
+}
+
+static double rms(const int16_t *out, ssize_t frames)
+{
+	double sum = 0;
+
+	for (ssize_t i = 64; i < frames - 64; i++) {
+		sum += (double)out[i] * out[i];
+	}
+	return sqrt(sum / (double)(frames - 128));
+}
+
+static int check_quality(const struct tier *tier, int in_rate, int out_rate)
+{
+	static int16_t in[INPUT_FRAMES * 2];
+	static int16_t out[INPUT_FRAMES * 2 * 5];
+	const double tone = 1000;
+	ssize_t frames;
+	double snr, rejection = 0;
+	void *rs = create(tier, in_rate, out_rate, 2);
+
+	make_tone(in, INPUT_FRAMES, 2, tone, in_rate);
+	frames = run(rs, in, INPUT_FRAMES, out, INPUT_FRAMES * 5);
+	snr = tone_snr(out, frames, 2, tone, out_rate);
+
+	if (in_rate >= 2 * out_rate) {
+		/* Between the output Nyquist and the input one, folds back in band */
+		double high = out_rate * 0.5 + (in_rate - out_rate) * 0.25;
+
+		make_tone(in, INPUT_FRAMES, 1, high, in_rate);
+		free(rs);
+		rs = create(tier, in_rate, out_rate, 1);
+		frames = run(rs, in, INPUT_FRAMES, out, INPUT_FRAMES * 5);
+		rejection = 20 * log10(16000 / sqrt(2) / (rms(out, frames) + 1e-9));
+	}
+	free(rs);
+
+	printf("%-6s %5d -> %5d  SNR %5.1f dB", tier->name, in_rate, out_rate, snr);
+	if (in_rate >= 2 * out_rate) {
+		printf("  alias rejection %5.1f dB", rejection);
+	}
+	printf("\n");
+
+	if (snr < tier->min_snr || (in_rate >= 2 * out_rate && rejection < tier->min_rejection)) {
+		printf("%s: below %.0f dB SNR or %.0f dB rejection\n", tier->name,
+		       tier->min_snr, tier->min_rejection);
+		return 1;
+	}
+	return 0;
+}
+
+/* Random block sizes must give the samples of a single call */
+static int check_blocks(const struct tier *tier)
+{
+	static int16_t in[INPUT_FRAMES * 2];
+	static int16_t whole[INPUT_FRAMES * 2 * 2];
+	static int16_t pieces[INPUT_FRAMES * 2 * 2];
+	void *rs = create(tier, 22050, 32000, 2);
+	ssize_t frames, consumed = 0, produced = 0;
+	uint32_t seed = 7;
+
+	make_tone(in, INPUT_FRAMES, 2, 440, 22050);
+	frames = run(rs, in, INPUT_FRAMES, whole, INPUT_FRAMES * 2);
+
+	swift_audio_resampler_reset(rs);
+	while (consumed < INPUT_FRAMES) {
+		ssize_t in_frames, out_frames;
+
+		seed = seed * 1103515245 + 12345;
+		in_frames = 1 + (seed >> 16) % 300;
+		out_frames = 1 + (seed >> 8) % 300;
+		if (in_frames > INPUT_FRAMES - consumed) {
+			in_frames = INPUT_FRAMES - consumed;
+		}
+		swift_audio_resampler_process(rs, in + consumed * 2, &in_frames,
+					      pieces + produced * 2, &out_frames);
+		consumed += in_frames;
+		produced += out_frames;
+	}
+	free(rs);
+
+	if (produced != frames || memcmp(whole, pieces, sizeof(int16_t) * 2 * (size_t)frames)) {
+		printf("%s: %zd frames in blocks, %zd in one call, or different samples\n",
+		       tier->name, produced, frames);
+		return 1;
+	}
+	return 0;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench(const struct tier *tier, int in_rate, int out_rate, int channels)
+{
+	const ssize_t in_frames = (ssize_t)BENCH_FRAMES * in_rate / out_rate;
+	int16_t *in = malloc(sizeof(int16_t) * (size_t)(in_frames * channels));
+	int16_t *out = malloc(sizeof(int16_t) * (size_t)(BENCH_FRAMES * channels));
+	void *rs = create(tier, in_rate, out_rate, channels);
+	ssize_t frames = 0;
+	double start, seconds;
+
+	make_tone(in, (int)in_frames, channels, 1000, in_rate);
+#if defined(__x86_64__) || defined(__i386__)
+	uint64_t cycles = __rdtsc();
+#endif
+	start = now();
+	/* In blocks of 256 output frames, like I2S.write */
+	for (ssize_t used = 0; frames < BENCH_FRAMES && used < in_frames;) {
+		ssize_t n_in = in_frames - used, n_out = 256;
+
+		swift_audio_resampler_process(rs, in + used * channels, &n_in,
+					      out + frames * channels, &n_out);
+		used += n_in;
+		frames += n_out;
+	}
+	seconds = now() - start;
+
+	printf("%-6s %d ch %5d -> %5d  %6.1f ns", tier->name, channels, in_rate,
+	       out_rate, seconds / (double)frames * 1e9);
+#if defined(__x86_64__) || defined(__i386__)
+	printf("  %6.1f cycles", (double)(__rdtsc() - cycles) / (double)frames);
+#endif
+	printf(" per output frame\n");
+
+	free(rs);
+	free(in);
+	free(out);
+}
+
+int main(void)
+{
+	const int tier_count = (int)(sizeof(tiers) / sizeof(tiers[0]));
+	const int rate_count = (int)(sizeof(rates) / sizeof(rates[0]));
+	int err = 0;
+
+	for (int t = 0; t < tier_count; t++) {
+		for (int r = 0; r < rate_count; r++) {
+			err |= check_quality(&tiers[t], rates[r][0], rates[r][1]);
+		}
+		err |= check_blocks(&tiers[t]);
+	}
+	if (err != 0) {
+		return err;
+	}
+	printf("blocks ok\n");
+
+	for (int t = 0; t < tier_count; t++) {
+		bench(&tiers[t], 11025, 16000, 1);
+		bench(&tiers[t], 44100, 48000, 2);
+	}
+	return 0;
+}
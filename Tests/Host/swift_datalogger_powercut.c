@@ -0,0 +1,289 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Power-cut simulation of the DataLogger file format, run on the host.
+ *
+ * A preallocated file is filled with records in the frame documented in
+ * DataLogger.swift, then the write is cut at every byte offset. The rest
+ * of the file is left zero, as preallocated, or filled with junk, as a
+ * card may leave a half-written sector, or holds the later records as if
+ * the card had written the sectors out of order and lost the rest of the
+ * one cut. For each cut the recovery scan must find exactly the records
+ * written whole before the cut, and the next sequence number. The
+ * recovery of DataLogger.init is then applied and more records appended.
+ * A torn tail must be gone, and a new scan must read all the records with
+ * the sequence numbers following on.
+ *
+ * scan() mirrors DataLogger.scan, keep the two in step.
+ *
+ *	gcc -O2 -I Sources/CSwiftIO/include Sources/CSwiftIO/swift_crc.c \
+ *		Tests/Host/swift_datalogger_powercut.c -o powercut && ./powercut
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "swift_crc.h"
+
+#define FILE_SIZE	2048
+/* Length, sequence number and CRC */
+#define OVERHEAD	12
+#define RECORDS		40
+/* Close to the wrap of the sequence number */
+#define FIRST_SEQUENCE	0xFFFFFFF0u
+
+enum tail {
+	/* Zero behind the cut, as preallocated */
+	TAIL_ZERO,
+	/* Junk in the next 512 bytes */
+	TAIL_JUNK,
+	/* The rest of the sector lost, the later sectors written */
+	TAIL_STALE,
+};
+
+static const char *const tail_names[] = { "", " with junk", " with stale sectors" };
+
+struct scan_result {
+	int end;
+	int records;
+	uint32_t sequence;
+	bool is_torn;
+};
+
+static uint32_t seed = 1;
+
+static uint32_t next_random(void)
+{
+	/* xorshift32 */
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+static uint32_t load32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+	       (uint32_t)p[3] << 24;
+}
+
+static void store32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+/* Frames a record at offset, returns the offset behind it */
+static int write_record(uint8_t *file, int offset, uint32_t sequence,
+			const uint8_t *payload, int length)
+{
+	store32(file + offset, (uint32_t)length);
+	store32(file + offset + 4, sequence);
+	memcpy(file + offset + 8, payload, (size_t)length);
+	store32(file + offset + 8 + length,
+		swift_crc32(0, file + offset, 8 + length));
+	return offset + OVERHEAD + length;
+}
+
+/*
+ * Reads the records from the start like DataLogger.scan: stop at a zero
+ * length, at a length past the end of the file, at a sequence number that
+ * doesn't follow on, or at a bad CRC. Anything but zero behind the last
+ * record is a torn or corrupt one.
+ */
+static struct scan_result scan(const uint8_t *file, int size)
+{
+	struct scan_result result = { 0, 0, 0, false };
+	bool has_expected = false, reached_zero = false;
+	uint32_t expected = 0;
+	int offset = 0;
+
+	while (size - offset >= 8) {
+		int length = (int)load32(file + offset);
+		uint32_t sequence = load32(file + offset + 4);
+
+		if (length == 0) {
+			reached_zero = true;
+			break;
+		}
+		offset += 8;
+		if (length < 0 || length > size - offset - 4 ||
+		    (has_expected && sequence != expected)) {
+			break;
+		}
+		if (swift_crc32(0, file + offset - 8, 8 + length) !=
+		    load32(file + offset + length)) {
+			break;
+		}
+		offset += length + 4;
+
+		result.end = offset;
+		result.records++;
+		expected = sequence + 1;
+		has_expected = true;
+	}
+
+	result.sequence = has_expected ? expected : 0;
+	result.is_torn = !reached_zero && result.end < size;
+	return result;
+}
+
+struct layout {
+	/* End of each record */
+	int ends[RECORDS];
+	int count;
+	uint8_t image[FILE_SIZE];
+};
+
+/* Payloads of random length and content, some of them all zero */
+static void make_layout(struct layout *layout)
+{
+	uint8_t payload[64];
+	int offset = 0;
+
+	memset(layout->image, 0, sizeof(layout->image));
+	layout->count = 0;
+	while (layout->count < RECORDS) {
+		int length = 1 + (int)(next_random() % sizeof(payload));
+
+		if (offset + OVERHEAD + length > FILE_SIZE - OVERHEAD) {
+			break;
+		}
+		for (int i = 0; i < length; i++) {
+			payload[i] = layout->count % 5 == 0 ? 0 : (uint8_t)next_random();
+		}
+		offset = write_record(layout->image, offset,
+				      FIRST_SEQUENCE + (uint32_t)layout->count, payload, length);
+		layout->ends[layout->count++] = offset;
+	}
+}
+
+/* Applies the recovery of DataLogger.init and appends more records */
+static int recover_and_append(uint8_t *file, struct scan_result found, int cut)
+{
+	const uint8_t payload[5] = { 1, 2, 3, 4, 5 };
+	struct scan_result again;
+	int offset = found.end;
+	int appended = 0;
+
+	/* truncate(to: end), then back to the full size with zeros */
+	if (found.is_torn) {
+		memset(file + found.end, 0, (size_t)(FILE_SIZE - found.end));
+	}
+	while (offset + OVERHEAD + (int)sizeof(payload) <= FILE_SIZE && appended < 8) {
+		offset = write_record(file, offset, found.sequence + (uint32_t)appended,
+				      payload, (int)sizeof(payload));
+		appended++;
+	}
+
+	/* Nothing of the torn tail may be left behind the new records */
+	if (found.is_torn) {
+		for (int i = offset; i < FILE_SIZE; i++) {
+			if (file[i] != 0) {
+				printf("cut %d: byte %d of the torn tail is left\n", cut, i);
+				return 1;
+			}
+		}
+	}
+
+	again = scan(file, FILE_SIZE);
+	if (again.records != found.records + appended || again.end != offset ||
+	    again.sequence != found.sequence + (uint32_t)appended) {
+		printf("cut %d: after recovery %d records to %d, expected %d to %d\n",
+		       cut, again.records, again.end, found.records + appended, offset);
+		return 1;
+	}
+	return 0;
+}
+
+static int simulate(const struct layout *layout, enum tail tail)
+{
+	static uint8_t file[FILE_SIZE];
+	const int written = layout->ends[layout->count - 1];
+	int torn = 0;
+
+	for (int cut = 0; cut <= written; cut++) {
+		struct scan_result found;
+		int whole = 0;
+
+		memcpy(file, layout->image, (size_t)cut);
+		for (int i = cut; i < FILE_SIZE; i++) {
+			switch (tail) {
+			case TAIL_ZERO:
+				file[i] = 0;
+				break;
+			case TAIL_JUNK:
+				file[i] = i < cut + 512 ? (uint8_t)next_random() : 0;
+				break;
+			case TAIL_STALE:
+				file[i] = i < (cut / 512 + 1) * 512 ? 0 : layout->image[i];
+				break;
+			}
+		}
+		/*
+		 * A record is whole if its bytes are all there, the missing
+		 * ones may happen to be what was left behind, like a CRC
+		 * ending in zero.
+		 */
+		while (whole < layout->count &&
+		       memcmp(file, layout->image, (size_t)layout->ends[whole]) == 0) {
+			whole++;
+		}
+
+		found = scan(file, FILE_SIZE);
+		if (found.records != whole ||
+		    found.end != (whole > 0 ? layout->ends[whole - 1] : 0) ||
+		    found.sequence != (whole > 0 ? FIRST_SEQUENCE + (uint32_t)whole : 0)) {
+			printf("cut %d%s: %d records to %d, expected %d\n", cut,
+			       tail_names[tail], found.records, found.end, whole);
+			return 1;
+		}
+
+		/*
+		 * Left untouched, the bytes behind the end must be zero. Junk or
+		 * stale sectors behind a zero length pass for the end, the
+		 * appends below then check they do no harm.
+		 */
+		if (found.is_torn) {
+			torn++;
+		} else if (tail == TAIL_ZERO) {
+			for (int i = found.end; i < FILE_SIZE; i++) {
+				if (file[i] != 0) {
+					printf("cut %d: data behind the end isn't torn\n", cut);
+					return 1;
+				}
+			}
+		}
+
+		if (recover_and_append(file, found, cut) != 0) {
+			return 1;
+		}
+	}
+
+	printf("%d records, %d cuts%s, %d torn tails zeroed\n", layout->count,
+	       written + 1, tail_names[tail], torn);
+	return 0;
+}
+
+int main(void)
+{
+	static struct layout layout;
+	int err;
+
+	make_layout(&layout);
+	for (int tail = TAIL_ZERO; tail <= TAIL_STALE; tail++) {
+		err = simulate(&layout, (enum tail)tail);
+		if (err != 0) {
+			return err;
+		}
+	}
+	printf("ok\n");
+	return 0;
+}
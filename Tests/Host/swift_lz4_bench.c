@@ -0,0 +1,316 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Fuzz and benchmark of the LZ4 block codec in swift_lz4.c, run on the
+ * host.
+ *
+ * The fuzz compresses random blocks of mixed content into output buffers
+ * cut just around the compressed size, with a guard byte past the cap,
+ * and checks the round trip through swift_lz4_decompress. It then feeds
+ * damaged blocks to the decompressor, which must never write past its
+ * buffer.
+ *
+ * The benchmark prints the ratio and speed of both directions on CSV text
+ * and on binary sensor records, the two kinds of data CompressedFile is
+ * meant for.
+ *
+ *	gcc -O2 -I Sources/CSwiftIO/include Sources/CSwiftIO/swift_lz4.c \
+ *		Tests/Host/swift_lz4_bench.c -lm -o lz4_bench && ./lz4_bench
+ *
+ * Add -DREFERENCE_LZ4 -llz4 to also check the blocks against the
+ * reference LZ4 library in both directions.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "swift_lz4.h"
+
+#ifdef REFERENCE_LZ4
+#include <lz4.h>
+#endif
+
+#define FUZZ_RUNS	80000
+#define GUARD		0xA5
+#define BENCH_BLOCK	4096
+#define BENCH_BYTES	(4 * 1024 * 1024)
+
+static uint32_t seed = 1;
+
+static uint32_t next_random(void)
+{
+	/* xorshift32 */
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+/* Random runs of noise, repeats of earlier bytes and single-byte fills */
+static void fill_mixed(uint8_t *buf, int len)
+{
+	int i = 0;
+
+	while (i < len) {
+		int run = 1 + (int)(next_random() % 300);
+
+		if (run > len - i) {
+			run = len - i;
+		}
+		switch (next_random() % 3) {
+		case 0:
+			for (int j = 0; j < run; j++) {
+				buf[i + j] = (uint8_t)next_random();
+			}
+			break;
+		case 1:
+			if (i > 0) {
+				int from = (int)(next_random() % (uint32_t)i);
+
+				for (int j = 0; j < run; j++) {
+					buf[i + j] = buf[from + j];
+				}
+				break;
+			}
+			/* fall through */
+		default:
+			memset(buf + i, (int)(next_random() & 3), (size_t)run);
+			break;
+		}
+		i += run;
+	}
+}
+
+static int fuzz_round_trip(void)
+{
+	static uint8_t src[SWIFT_LZ4_MAX_BLOCK];
+	static uint8_t dst[SWIFT_LZ4_COMPRESS_BOUND(SWIFT_LZ4_MAX_BLOCK) + 1];
+	static uint8_t out[SWIFT_LZ4_MAX_BLOCK + 1];
+	swift_lz4_state_t state;
+
+	for (int run = 0; run < FUZZ_RUNS; run++) {
+		int len = 1 + (int)(next_random() % (run % 16 == 0 ? SWIFT_LZ4_MAX_BLOCK : 2048));
+		int full, cap, size, back;
+
+		fill_mixed(src, len);
+		full = swift_lz4_compress(&state, src, len, dst,
+					  SWIFT_LZ4_COMPRESS_BOUND(len));
+		if (full <= 0 || full > SWIFT_LZ4_COMPRESS_BOUND(len)) {
+			printf("run %d: %d bytes don't fit the bound\n", run, len);
+			return 1;
+		}
+
+		/* Caps from a little below to a little above the exact size */
+		cap = full - 8 + (int)(next_random() % 16);
+		if (cap < 1) {
+			cap = 1;
+		}
+		dst[cap] = GUARD;
+		size = swift_lz4_compress(&state, src, len, dst, cap);
+		if (dst[cap] != GUARD || size > cap || (size == 0) != (cap < full)) {
+			printf("run %d: cap %d of %d returned %d\n", run, cap, full, size);
+			return 1;
+		}
+		if (size == 0) {
+			continue;
+		}
+
+		out[len] = GUARD;
+		back = swift_lz4_decompress(dst, size, out, len);
+		if (back != len || memcmp(src, out, (size_t)len) != 0 || out[len] != GUARD) {
+			printf("run %d: round trip of %d bytes failed\n", run, len);
+			return 1;
+		}
+#ifdef REFERENCE_LZ4
+		if (LZ4_decompress_safe((const char *)dst, (char *)out, size, len) != len ||
+		    memcmp(src, out, (size_t)len) != 0) {
+			printf("run %d: the reference doesn't decode the block\n", run);
+			return 1;
+		}
+		size = LZ4_compress_default((const char *)src, (char *)dst, len,
+					    SWIFT_LZ4_COMPRESS_BOUND(len));
+		if (swift_lz4_decompress(dst, size, out, len) != len ||
+		    memcmp(src, out, (size_t)len) != 0) {
+			printf("run %d: a reference block doesn't decode\n", run);
+			return 1;
+		}
+#endif
+	}
+	return 0;
+}
+
+static int fuzz_damaged(void)
+{
+	static uint8_t src[2048];
+	static uint8_t dst[SWIFT_LZ4_COMPRESS_BOUND(2048)];
+	static uint8_t out[2048 + 1];
+	swift_lz4_state_t state;
+
+	for (int run = 0; run < FUZZ_RUNS; run++) {
+		int len = 1 + (int)(next_random() % 2048);
+		int size, cap, hits, back;
+
+		fill_mixed(src, len);
+		size = swift_lz4_compress(&state, src, len, dst, (int)sizeof(dst));
+
+		/* Flip a few bits, or cut the block short */
+		hits = 1 + (int)(next_random() % 4);
+		for (int i = 0; i < hits; i++) {
+			dst[next_random() % (uint32_t)size] ^= (uint8_t)(1u << (next_random() % 8));
+		}
+		if (next_random() % 4 == 0) {
+			size = (int)(next_random() % (uint32_t)size);
+		}
+
+		cap = 1 + (int)(next_random() % (uint32_t)len);
+		out[cap] = GUARD;
+		back = swift_lz4_decompress(dst, size, out, cap);
+		if (out[cap] != GUARD || back > cap || (back < 0 && back != -EINVAL)) {
+			printf("run %d: damaged block returned %d into %d bytes\n",
+			       run, back, cap);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Lines of a data logger: time, three temperatures and a status */
+static void fill_csv(uint8_t *buf, int len)
+{
+	int i = 0;
+	uint32_t time = 1000;
+
+	while (i < len) {
+		char line[96];
+		int n = snprintf(line, sizeof(line), "%" PRIu32 ",%.2f,%.2f,%.2f,%s\n",
+				 time,
+				 21.5 + sin(time / 5000.0) + (next_random() % 8) / 100.0,
+				 22.0 + cos(time / 7000.0) + (next_random() % 8) / 100.0,
+				 19.75 + (next_random() % 16) / 100.0,
+				 next_random() % 50 == 0 ? "WARN" : "OK");
+
+		if (n > len - i) {
+			n = len - i;
+		}
+		memcpy(buf + i, line, (size_t)n);
+		i += n;
+		time += 10;
+	}
+}
+
+/*
+ * Packed records of an IMU lying still: timestamp, three slowly drifting
+ * accelerometer axes and three gyroscope axes with a little noise
+ */
+static void fill_sensor(uint8_t *buf, int len)
+{
+	uint32_t time = 0;
+	int i = 0;
+
+	while (i < len) {
+		uint8_t record[16];
+		int n = (int)sizeof(record);
+
+		memcpy(record, &time, 4);
+		for (int axis = 0; axis < 6; axis++) {
+			int16_t value = axis < 3 ?
+				(int16_t)(axis == 2 ? 16384 : 0) + (int16_t)(time / 4000) :
+				(int16_t)((int)(next_random() % 5) - 2);
+
+			memcpy(record + 4 + axis * 2, &value, 2);
+		}
+		record[14] = 0;
+		record[15] = 0x5A;
+
+		if (n > len - i) {
+			n = len - i;
+		}
+		memcpy(buf + i, record, (size_t)n);
+		i += n;
+		time += 10;
+	}
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int bench(const char *name, void (*fill)(uint8_t *, int))
+{
+	static uint8_t data[BENCH_BYTES];
+	static uint8_t packed[BENCH_BYTES / BENCH_BLOCK *
+			      SWIFT_LZ4_COMPRESS_BOUND(BENCH_BLOCK)];
+	static int sizes[BENCH_BYTES / BENCH_BLOCK];
+	static uint8_t restored[BENCH_BYTES];
+	const int blocks = BENCH_BYTES / BENCH_BLOCK;
+	swift_lz4_state_t state;
+	size_t total = 0, offset = 0;
+	double start, compress, decompress;
+
+	fill(data, BENCH_BYTES);
+
+	start = now();
+	for (int i = 0; i < blocks; i++) {
+		sizes[i] = swift_lz4_compress(&state, data + i * BENCH_BLOCK, BENCH_BLOCK,
+					      packed + offset,
+					      SWIFT_LZ4_COMPRESS_BOUND(BENCH_BLOCK));
+		offset += (size_t)sizes[i];
+	}
+	compress = now() - start;
+	total = offset;
+
+	offset = 0;
+	start = now();
+	for (int i = 0; i < blocks; i++) {
+		if (swift_lz4_decompress(packed + offset, sizes[i],
+					 restored + i * BENCH_BLOCK, BENCH_BLOCK) != BENCH_BLOCK) {
+			printf("%s: block %d doesn't decode\n", name, i);
+			return 1;
+		}
+		offset += (size_t)sizes[i];
+	}
+	decompress = now() - start;
+	if (memcmp(data, restored, BENCH_BYTES) != 0) {
+		printf("%s: the decoded data differs\n", name);
+		return 1;
+	}
+
+	printf("%-8s ratio %5.3f  compress %7.1f MB/s  decompress %7.1f MB/s\n",
+	       name, (double)total / BENCH_BYTES,
+	       BENCH_BYTES / compress / 1e6, BENCH_BYTES / decompress / 1e6);
+	return 0;
+}
+
+int main(void)
+{
+	int err;
+
+	err = fuzz_round_trip();
+	if (err == 0) {
+		err = fuzz_damaged();
+	}
+	if (err != 0) {
+		return err;
+	}
+	printf("fuzz ok, %d round trips and %d damaged blocks\n", FUZZ_RUNS, FUZZ_RUNS);
+
+	printf("%d-byte blocks:\n", BENCH_BLOCK);
+	err = bench("csv", fill_csv);
+	if (err == 0) {
+		err = bench("sensor", fill_sensor);
+	}
+	return err;
+}
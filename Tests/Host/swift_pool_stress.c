@@ -0,0 +1,195 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Stress test of the lock-free block pools in swift_pool.c, run on the host
+ * with POSIX threads in place of interrupts and kernel threads.
+ *
+ * Ten threads allocate blocks of random sizes from three size classes that
+ * are too small for all of them, fill each block with their own pattern,
+ * hold a few and check the pattern before freeing. A block handed to two
+ * threads at once shows up as an overwritten pattern. At the end every
+ * pool must have all its blocks on the free list exactly once.
+ *
+ *	gcc -O2 -pthread -I Sources/CSwiftIO/include Sources/CSwiftIO/swift_pool.c \
+ *		Tests/Host/swift_pool_stress.c -o pool_stress && ./pool_stress
+ *
+ * Add -fsanitize=thread to also look for data races.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "swift_pool.h"
+
+#define THREADS		10
+#define ROUNDS		200000
+#define HELD		4
+#define CLASSES		3
+
+static const uint32_t block_sizes[CLASSES] = { 32, 64, 128 };
+static const uint32_t block_counts[CLASSES] = { 12, 8, 4 };
+
+static swift_pool_t pools[CLASSES];
+static _Alignas(SWIFT_POOL_ALIGN) uint8_t storage[CLASSES][12 * 128];
+static uint64_t refused[THREADS];
+
+struct held {
+	uint32_t *block;
+	uint32_t words;
+	uint32_t pattern;
+};
+
+static uint32_t next_random(uint32_t *seed)
+{
+	/* xorshift32 */
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 17;
+	*seed ^= *seed << 5;
+	return *seed;
+}
+
+/* The first word is the free list link, it is checked like the others */
+static int check_and_free(struct held *held)
+{
+	for (uint32_t i = 0; i < held->words; i++) {
+		if (held->block[i] != held->pattern) {
+			printf("block %p word %" PRIu32 " is %08" PRIx32
+			       " instead of %08" PRIx32 "\n", (void *)held->block,
+			       i, held->block[i], held->pattern);
+			return 1;
+		}
+	}
+	if (swift_pools_free(pools, CLASSES, held->block) != 0) {
+		printf("block %p isn't freed\n", (void *)held->block);
+		return 1;
+	}
+	held->block = NULL;
+	return 0;
+}
+
+static void *worker(void *arg)
+{
+	uint32_t id = (uint32_t)(uintptr_t)arg;
+	uint32_t seed = 0x9E3779B9u * (id + 1);
+	struct held held[HELD] = { 0 };
+
+	for (uint32_t round = 0; round < ROUNDS; round++) {
+		struct held *slot = &held[round % HELD];
+		uint32_t size;
+
+		if (slot->block != NULL && check_and_free(slot) != 0) {
+			return (void *)1;
+		}
+
+		size = 1 + next_random(&seed) % block_sizes[CLASSES - 1];
+		slot->block = swift_pools_alloc(pools, CLASSES, size);
+		if (slot->block == NULL) {
+			refused[id]++;
+			/* A single CPU must let the others free blocks */
+			sched_yield();
+			continue;
+		}
+		slot->words = (size + 3) / 4;
+		slot->pattern = (id << 24) | (round & 0xFFFFFF);
+		for (uint32_t i = 0; i < slot->words; i++) {
+			slot->block[i] = slot->pattern;
+		}
+	}
+
+	for (int i = 0; i < HELD; i++) {
+		if (held[i].block != NULL && check_and_free(&held[i]) != 0) {
+			return (void *)1;
+		}
+	}
+	return NULL;
+}
+
+/* Walks the free list, every block must be on it exactly once */
+static int check_pool(int class)
+{
+	swift_pool_t *pool = &pools[class];
+	uint8_t seen[12] = { 0 };
+	uint32_t index = pool->head & 0xFFFF;
+	uint32_t count = 0;
+
+	while (index != 0) {
+		if (index > pool->block_count || seen[index - 1]) {
+			printf("class %d: bad free list at block %" PRIu32 "\n",
+			       class, index);
+			return 1;
+		}
+		seen[index - 1] = 1;
+		count++;
+		index = *(uint32_t *)(pool->buf + (index - 1) * pool->block_size) & 0xFFFF;
+	}
+	if (count != pool->block_count || pool->used != 0 ||
+	    pool->high_water > pool->block_count) {
+		printf("class %d: %" PRIu32 " free, %" PRIu32 " used, high water %"
+		       PRIu32 "\n", class, count, pool->used, pool->high_water);
+		return 1;
+	}
+	return 0;
+}
+
+/* Blocks from elsewhere or from inside a block are refused */
+static int check_bad_free(void)
+{
+	uint32_t outside;
+
+	if (swift_pools_free(pools, CLASSES, &outside) != -EINVAL ||
+	    swift_pool_free(&pools[0], storage[0] + 4) != -EINVAL ||
+	    swift_pool_init(&pools[0], storage[0] + 2, 32, 1) != -EINVAL ||
+	    swift_pool_init(&pools[0], storage[0], 30, 1) != -EINVAL) {
+		printf("a bad block or layout is accepted\n");
+		return 1;
+	}
+	return 0;
+}
+
+int main(void)
+{
+	pthread_t threads[THREADS];
+	uint64_t total_refused = 0;
+	int err = 0;
+
+	for (int i = 0; i < CLASSES; i++) {
+		swift_pool_init(&pools[i], storage[i], block_sizes[i], block_counts[i]);
+	}
+
+	for (uintptr_t i = 0; i < THREADS; i++) {
+		pthread_create(&threads[i], NULL, worker, (void *)i);
+	}
+	for (int i = 0; i < THREADS; i++) {
+		void *result;
+
+		pthread_join(threads[i], &result);
+		if (result != NULL) {
+			err = 1;
+		}
+		total_refused += refused[i];
+	}
+	if (err != 0) {
+		return err;
+	}
+
+	for (int i = 0; i < CLASSES; i++) {
+		err |= check_pool(i);
+	}
+	err |= check_bad_free();
+	if (err != 0) {
+		return err;
+	}
+
+	printf("ok, %" PRIu64 " allocations refused, high water %" PRIu32 "/%"
+	       PRIu32 "/%" PRIu32 "\n", total_refused, pools[0].high_water,
+	       pools[1].high_water, pools[2].high_water);
+	return 0;
+}
@@ -0,0 +1,196 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Stress test of the lock-free rings in swift_ring.h, run on the host with
+ * POSIX threads in place of interrupts and kernel threads.
+ *
+ * Several producers push numbered values into an MPSC ring in batches of
+ * 1 to 3 while one producer pushes into an SPSC ring. The consumer checks
+ * that every value arrives exactly once and in the order of its producer,
+ * and sleeps on a semaphore whenever a ring reports it may be woken, so a
+ * lost wake-up hangs the test.
+ *
+ *	gcc -O2 -pthread -I Sources/CSwiftIO/include \
+ *		Tests/Host/swift_ring_stress.c -o ring_stress && ./ring_stress
+ *
+ * Add -fsanitize=thread to also look for data races, it warns that it
+ * doesn't model the fences of the wake-up checks.
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+
+#include "swift_ring.h"
+
+#define PRODUCERS	4
+#define VALUES		200000
+#define MPSC_CAPACITY	64
+#define SPSC_CAPACITY	32
+
+static swift_mpsc_ring_t mpsc;
+static uint64_t mpsc_buf[MPSC_CAPACITY];
+static uint32_t mpsc_seq[MPSC_CAPACITY];
+static sem_t mpsc_sem;
+
+static swift_spsc_ring_t spsc;
+static uint64_t spsc_buf[SPSC_CAPACITY];
+static sem_t spsc_sem;
+
+/* Each value holds its producer in the high word, its number in the low one */
+static void *mpsc_producer(void *arg)
+{
+	uint64_t id = (uintptr_t)arg;
+	uint64_t batch[3];
+	uint64_t i = 0;
+
+	while (i < VALUES) {
+		uint32_t count = (uint32_t)(1 + i % 3);
+		uint32_t pushed;
+		bool wake;
+
+		if (i + count > VALUES) {
+			count = (uint32_t)(VALUES - i);
+		}
+		for (uint32_t j = 0; j < count; j++) {
+			batch[j] = (id << 32) | (i + j);
+		}
+		pushed = swift_mpsc_push(&mpsc, batch, count, &wake);
+		if (wake) {
+			sem_post(&mpsc_sem);
+		}
+		/* A single CPU must let the consumer run to make room */
+		if (pushed == 0) {
+			sched_yield();
+		}
+		i += pushed;
+	}
+	return NULL;
+}
+
+static void *spsc_producer(void *arg)
+{
+	uint64_t batch[5];
+	uint64_t i = 0;
+
+	(void)arg;
+	while (i < VALUES) {
+		uint32_t count = 5;
+		uint32_t pushed;
+		bool wake;
+
+		if (i + count > VALUES) {
+			count = (uint32_t)(VALUES - i);
+		}
+		for (uint32_t j = 0; j < count; j++) {
+			batch[j] = i + j;
+		}
+		pushed = swift_spsc_push(&spsc, batch, count, &wake);
+		if (wake) {
+			sem_post(&spsc_sem);
+		}
+		if (pushed == 0) {
+			sched_yield();
+		}
+		i += pushed;
+	}
+	return NULL;
+}
+
+static int consume_mpsc(uint64_t *sleeps)
+{
+	uint64_t next[PRODUCERS] = { 0 };
+	uint64_t received = 0;
+	uint64_t buf[16];
+
+	while (received < (uint64_t)PRODUCERS * VALUES) {
+		uint32_t count = swift_mpsc_pop(&mpsc, buf, 16);
+
+		if (count == 0) {
+			if (!swift_mpsc_is_ready(&mpsc)) {
+				(*sleeps)++;
+				sem_wait(&mpsc_sem);
+			}
+			continue;
+		}
+		for (uint32_t j = 0; j < count; j++) {
+			uint64_t id = buf[j] >> 32;
+			uint64_t value = buf[j] & 0xFFFFFFFFu;
+
+			if (id >= PRODUCERS || value != next[id]) {
+				printf("MPSC: producer %" PRIu64 " value %" PRIu64
+				       " out of order\n", id, value);
+				return 1;
+			}
+			next[id]++;
+		}
+		received += count;
+	}
+	return 0;
+}
+
+static int consume_spsc(uint64_t *sleeps)
+{
+	uint64_t expected = 0;
+	uint64_t buf[7];
+
+	while (expected < VALUES) {
+		uint32_t count = swift_spsc_pop(&spsc, buf, 7);
+
+		if (count == 0) {
+			if (swift_spsc_is_empty(&spsc)) {
+				(*sleeps)++;
+				sem_wait(&spsc_sem);
+			}
+			continue;
+		}
+		for (uint32_t j = 0; j < count; j++) {
+			if (buf[j] != expected) {
+				printf("SPSC: value %" PRIu64 " instead of %" PRIu64
+				       "\n", buf[j], expected);
+				return 1;
+			}
+			expected++;
+		}
+	}
+	return 0;
+}
+
+int main(void)
+{
+	pthread_t threads[PRODUCERS + 1];
+	uint64_t mpsc_sleeps = 0, spsc_sleeps = 0;
+	int err;
+
+	swift_mpsc_init(&mpsc, mpsc_buf, mpsc_seq, sizeof(uint64_t),
+			MPSC_CAPACITY);
+	swift_spsc_init(&spsc, spsc_buf, sizeof(uint64_t), SPSC_CAPACITY);
+	sem_init(&mpsc_sem, 0, 0);
+	sem_init(&spsc_sem, 0, 0);
+
+	for (uintptr_t i = 0; i < PRODUCERS; i++) {
+		pthread_create(&threads[i], NULL, mpsc_producer, (void *)i);
+	}
+	pthread_create(&threads[PRODUCERS], NULL, spsc_producer, NULL);
+
+	err = consume_mpsc(&mpsc_sleeps);
+	if (err == 0) {
+		err = consume_spsc(&spsc_sleeps);
+	}
+	if (err != 0) {
+		return err;
+	}
+
+	for (int i = 0; i <= PRODUCERS; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	printf("ok, consumer slept %" PRIu64 " times on MPSC, %" PRIu64
+	       " on SPSC\n", mpsc_sleeps, spsc_sleeps);
+	return 0;
+}
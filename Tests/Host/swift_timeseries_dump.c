@@ -0,0 +1,252 @@
+/*
+ * @Copyright (c) 2020, MADMACHINE LIMITED
+ * @Author: Andy Liu
+ * @SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Dumps a file written by TimeSeriesWriter on a computer, for example a
+ * log copied from the SD card of a board in the field.
+ *
+ * Each record is printed as its timestamp and its payload in hex. A time
+ * range is found like TimeSeriesReader.seek(to:) does, by a binary search
+ * over the block headers, so a day-long log isn't read through. With -i
+ * only the block headers are listed. Damaged blocks are reported and
+ * skipped.
+ *
+ *	gcc -O2 -I Sources/CSwiftIO/include Sources/CSwiftIO/swift_crc.c \
+ *		Tests/Host/swift_timeseries_dump.c -o ts_dump
+ *	./ts_dump [-i] file [from [through]]
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "swift_crc.h"
+
+/* The layout documented in TimeSeriesFile.swift */
+#define HEADER_SIZE		512
+#define BLOCK_HEADER_SIZE	32
+#define TIMESTAMP_SIZE		8
+#define FILE_MAGIC		0x53545753u	/* "SWTS" */
+#define BLOCK_MAGIC		0x304B4C42u	/* "BLK0" */
+
+struct block_header {
+	uint32_t count;
+	int64_t first;
+	int64_t last;
+	uint32_t crc;
+};
+
+static FILE *file;
+static uint32_t record_size;
+static uint32_t block_size;
+static uint32_t records_per_block;
+static long block_count;
+
+static uint32_t load32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+	       (uint32_t)p[3] << 24;
+}
+
+static int64_t load64(const uint8_t *p)
+{
+	return (int64_t)((uint64_t)load32(p) | (uint64_t)load32(p + 4) << 32);
+}
+
+static size_t read_at(long offset, uint8_t *buf, size_t len)
+{
+	if (fseek(file, offset, SEEK_SET) != 0) {
+		return 0;
+	}
+	return fread(buf, 1, len, file);
+}
+
+static int read_file_header(void)
+{
+	uint8_t header[16];
+	long size;
+
+	if (read_at(0, header, sizeof(header)) != sizeof(header) ||
+	    load32(header) != FILE_MAGIC ||
+	    load32(header + 12) != swift_crc32(0, header, 12)) {
+		return -1;
+	}
+	record_size = load32(header + 4);
+	block_size = load32(header + 8);
+	if (record_size == 0 || block_size <= BLOCK_HEADER_SIZE + TIMESTAMP_SIZE ||
+	    record_size > block_size - BLOCK_HEADER_SIZE - TIMESTAMP_SIZE) {
+		return -1;
+	}
+	records_per_block = (block_size - BLOCK_HEADER_SIZE) / (TIMESTAMP_SIZE + record_size);
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	block_count = size > HEADER_SIZE ?
+		(size - HEADER_SIZE + (long)block_size - 1) / (long)block_size : 0;
+	return 0;
+}
+
+static long block_offset(long index)
+{
+	return HEADER_SIZE + index * (long)block_size;
+}
+
+/* Returns 0 if the header of the block is valid */
+static int parse_block_header(const uint8_t *buf, struct block_header *header)
+{
+	header->count = load32(buf + 4);
+	header->first = load64(buf + 8);
+	header->last = load64(buf + 16);
+	header->crc = load32(buf + 24);
+	if (load32(buf) != BLOCK_MAGIC || header->count == 0 ||
+	    header->count > records_per_block || header->first > header->last) {
+		return -1;
+	}
+	return 0;
+}
+
+static int read_block_header(long index, struct block_header *header)
+{
+	uint8_t buf[BLOCK_HEADER_SIZE];
+
+	if (read_at(block_offset(index), buf, sizeof(buf)) != sizeof(buf)) {
+		return -1;
+	}
+	return parse_block_header(buf, header);
+}
+
+/* Reads a whole block and checks its records, 0 if it is intact */
+static int read_block(long index, uint8_t *block, struct block_header *header)
+{
+	size_t read = read_at(block_offset(index), block, block_size);
+	size_t length;
+
+	if (read < BLOCK_HEADER_SIZE || parse_block_header(block, header) != 0) {
+		return -1;
+	}
+	length = (size_t)header->count * (TIMESTAMP_SIZE + record_size);
+	if (BLOCK_HEADER_SIZE + length > read ||
+	    swift_crc32(0, block + BLOCK_HEADER_SIZE, (ssize_t)length) != header->crc) {
+		return -1;
+	}
+	return 0;
+}
+
+/* The last block starting at or before the time, 0 if none does */
+static long find_block(int64_t from)
+{
+	long low = 0, high = block_count - 1, found = 0;
+
+	while (low <= high) {
+		long middle = (low + high) / 2;
+		struct block_header header;
+
+		if (read_block_header(middle, &header) == 0 && header.first <= from) {
+			found = middle;
+			low = middle + 1;
+		} else {
+			high = middle - 1;
+		}
+	}
+	return found;
+}
+
+static void list_blocks(void)
+{
+	for (long index = 0; index < block_count; index++) {
+		struct block_header header;
+
+		if (read_block_header(index, &header) != 0) {
+			printf("block %ld: damaged\n", index);
+			continue;
+		}
+		printf("block %ld: %" PRIu32 " records, %" PRId64 " to %" PRId64 "\n",
+		       index, header.count, header.first, header.last);
+	}
+}
+
+static int dump(int64_t from, int64_t through)
+{
+	uint8_t *block = malloc(block_size);
+	uint32_t stride = TIMESTAMP_SIZE + record_size;
+
+	if (block == NULL) {
+		return 1;
+	}
+	for (long index = find_block(from); index < block_count; index++) {
+		struct block_header header;
+
+		if (read_block(index, block, &header) != 0) {
+			fprintf(stderr, "block %ld: damaged, skipped\n", index);
+			continue;
+		}
+		if (header.first > through) {
+			break;
+		}
+		for (uint32_t i = 0; i < header.count; i++) {
+			const uint8_t *slot = block + BLOCK_HEADER_SIZE + i * stride;
+			int64_t timestamp = load64(slot);
+
+			if (timestamp < from || timestamp > through) {
+				continue;
+			}
+			printf("%" PRId64 " ", timestamp);
+			for (uint32_t j = 0; j < record_size; j++) {
+				printf("%02x", slot[TIMESTAMP_SIZE + j]);
+			}
+			printf("\n");
+		}
+	}
+	free(block);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int64_t from = INT64_MIN, through = INT64_MAX;
+	int index_only = 0;
+	int arg = 1;
+	int err;
+
+	if (arg < argc && strcmp(argv[arg], "-i") == 0) {
+		index_only = 1;
+		arg++;
+	}
+	if (arg >= argc || argc - arg > 3) {
+		fprintf(stderr, "usage: %s [-i] file [from [through]]\n", argv[0]);
+		return 2;
+	}
+
+	file = fopen(argv[arg], "rb");
+	if (file == NULL) {
+		perror(argv[arg]);
+		return 1;
+	}
+	if (arg + 1 < argc) {
+		from = strtoll(argv[arg + 1], NULL, 0);
+	}
+	if (arg + 2 < argc) {
+		through = strtoll(argv[arg + 2], NULL, 0);
+	}
+
+	if (read_file_header() != 0) {
+		fprintf(stderr, "%s: not a time series file\n", argv[arg]);
+		fclose(file);
+		return 1;
+	}
+	printf("# record size %" PRIu32 ", block size %" PRIu32 ", %ld blocks\n",
+	       record_size, block_size, block_count);
+
+	err = 0;
+	if (index_only) {
+		list_blocks();
+	} else {
+		err = dump(from, through);
+	}
+	fclose(file);
+	return err;
+}